@@ -61,9 +61,9 @@ fi
 
 if [[ $NEED_BUILD_DEPS -eq 1 ]]; then
     if ask "Install build dependencies (cmake, libsdl2-dev, libgl-dev, libei-dev, etc.)?"; then
-        sudo apt install -y cmake build-essential libsdl2-dev libgl-dev \
-            libayatana-appindicator3-dev libgtk-3-dev pkg-config \
-            libei-dev liboeffis-dev
+        sudo apt install -y cmake build-essential libsdl2-dev libgl-dev pkg-config \
+            libei-dev liboeffis-dev libglib2.0-dev libpipewire-0.3-dev \
+            libx11-dev libxext-dev
         ok "Build dependencies installed."
     else
         warn "Skipping build dependencies. Build may fail if they are missing."
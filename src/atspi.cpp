@@ -0,0 +1,338 @@
+#include "atspi.h"
+
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include <gio/gio.h>
+
+// Upper bound for one call into the focused application. A hung app must
+// not stall typing; the caller falls back to the other backends.
+static constexpr int ATSPI_CALL_TIMEOUT_MS = 500;
+
+// AtspiStateType bits: "accepts text input" and "has keyboard focus"
+static constexpr int ATSPI_STATE_EDITABLE = 7;
+static constexpr int ATSPI_STATE_FOCUSED  = 12;
+
+// AtspiRole of masked text entries
+static constexpr guint32 ATSPI_ROLE_PASSWORD_TEXT = 40;
+
+struct AtspiTextImpl {
+    GDBusConnection * conn    = nullptr;  // accessibility bus
+    GMainContext *    context = nullptr;
+    GMainLoop *       loop    = nullptr;
+    guint             focus_sub = 0;
+    std::thread       worker;
+
+    // Focused object, updated from the loop thread
+    std::mutex  mutex;
+    std::string focus_bus;   // application's unique name on the a11y bus
+    std::string focus_path;
+    int         focus_editable = -1;  // -1 unknown, looked up on first insert
+    int         focus_password = -1;  // -1 unknown, looked up on first query
+
+    // Application name for a bus name (caller thread only)
+    std::string app_bus;
+    std::string app_name;
+
+    // Startup handshake with the loop thread
+    std::condition_variable cv;
+    bool                    ready = false;
+};
+
+// object:state-changed:focused, body (siiv...): detail, gained, unused, any_data
+static void on_state_changed(GDBusConnection * /*conn*/, const gchar * sender, const gchar * path,
+                             const gchar * /*iface*/, const gchar * /*signal*/,
+                             GVariant * params, gpointer user_data) {
+    auto * impl = static_cast<AtspiTextImpl *>(user_data);
+    if (g_variant_n_children(params) < 2) return;
+
+    GVariant * detail = g_variant_get_child_value(params, 0);
+    GVariant * gained = g_variant_get_child_value(params, 1);
+    const bool focused = strcmp(g_variant_get_string(detail, nullptr), "focused") == 0;
+    const bool on      = g_variant_get_int32(gained) != 0;
+    g_variant_unref(detail);
+    g_variant_unref(gained);
+    if (!focused) return;
+
+    std::lock_guard<std::mutex> lock(impl->mutex);
+    if (on) {
+        impl->focus_bus      = sender;
+        impl->focus_path     = path;
+        impl->focus_editable = -1;
+        impl->focus_password = -1;
+    } else if (impl->focus_bus == sender && impl->focus_path == path) {
+        impl->focus_bus.clear();
+        impl->focus_path.clear();
+    }
+}
+
+static void atspi_thread(AtspiTextImpl * impl) {
+    // Signal callbacks are dispatched on the context that was the thread
+    // default when subscribing
+    g_main_context_push_thread_default(impl->context);
+    impl->focus_sub = g_dbus_connection_signal_subscribe(
+        impl->conn, nullptr, "org.a11y.atspi.Event.Object", "StateChanged", nullptr, "focused",
+        G_DBUS_SIGNAL_FLAGS_NONE, on_state_changed, impl, nullptr);
+    {
+        std::lock_guard<std::mutex> lock(impl->mutex);
+        impl->ready = true;
+    }
+    impl->cv.notify_one();
+
+    g_main_loop_run(impl->loop);
+
+    g_dbus_connection_signal_unsubscribe(impl->conn, impl->focus_sub);
+    g_main_context_pop_thread_default(impl->context);
+}
+
+static GVariant * call(AtspiTextImpl * impl, const std::string & bus, const std::string & path,
+                       const char * iface, const char * method, GVariant * args, const char * reply_type) {
+    GError * err = nullptr;
+    GVariant * reply = g_dbus_connection_call_sync(
+        impl->conn, bus.c_str(), path.c_str(), iface, method, args,
+        G_VARIANT_TYPE(reply_type), G_DBUS_CALL_FLAGS_NONE, ATSPI_CALL_TIMEOUT_MS, nullptr, &err);
+    if (!reply) {
+        fprintf(stderr, "atspi: %s failed: %s\n", method, err ? err->message : "unknown error");
+        g_clear_error(&err);
+    }
+    return reply;
+}
+
+AtspiText::AtspiText() = default;
+AtspiText::~AtspiText() { shutdown(); }
+
+bool AtspiText::init() {
+    GError * err = nullptr;
+    GDBusConnection * session = g_bus_get_sync(G_BUS_TYPE_SESSION, nullptr, &err);
+    if (!session) {
+        fprintf(stderr, "atspi: cannot connect to session bus: %s\n", err ? err->message : "unknown error");
+        g_clear_error(&err);
+        return false;
+    }
+    g_dbus_connection_set_exit_on_close(session, FALSE);
+
+    // The accessibility bus is separate; the session bus only tells where it is
+    GVariant * reply = g_dbus_connection_call_sync(
+        session, "org.a11y.Bus", "/org/a11y/bus", "org.a11y.Bus", "GetAddress", nullptr,
+        G_VARIANT_TYPE("(s)"), G_DBUS_CALL_FLAGS_NONE, ATSPI_CALL_TIMEOUT_MS, nullptr, &err);
+    g_object_unref(session);
+    if (!reply) {
+        fprintf(stderr, "atspi: no accessibility bus: %s\n", err ? err->message : "unknown error");
+        g_clear_error(&err);
+        return false;
+    }
+    const gchar * address = nullptr;
+    g_variant_get(reply, "(&s)", &address);
+
+    GDBusConnection * conn = g_dbus_connection_new_for_address_sync(
+        address,
+        (GDBusConnectionFlags) (G_DBUS_CONNECTION_FLAGS_AUTHENTICATION_CLIENT |
+                                G_DBUS_CONNECTION_FLAGS_MESSAGE_BUS_CONNECTION),
+        nullptr, nullptr, &err);
+    g_variant_unref(reply);
+    if (!conn) {
+        fprintf(stderr, "atspi: cannot connect to accessibility bus: %s\n", err ? err->message : "unknown error");
+        g_clear_error(&err);
+        return false;
+    }
+    g_dbus_connection_set_exit_on_close(conn, FALSE);
+
+    m_impl = std::make_unique<AtspiTextImpl>();
+    m_impl->conn    = conn;
+    m_impl->context = g_main_context_new();
+    m_impl->loop    = g_main_loop_new(m_impl->context, FALSE);
+
+    // Applications only emit the events some listener registered for
+    GVariant * reg = call(m_impl.get(), "org.a11y.atspi.Registry", "/org/a11y/atspi/registry",
+                          "org.a11y.atspi.Registry", "RegisterEvent",
+                          g_variant_new("(s)", "object:state-changed:focused"), "()");
+    if (reg) g_variant_unref(reg);
+
+    m_impl->worker = std::thread(atspi_thread, m_impl.get());
+    std::unique_lock<std::mutex> lock(m_impl->mutex);
+    m_impl->cv.wait(lock, [this]() { return m_impl->ready; });
+    return true;
+}
+
+// The cached focus may be stale if focus moved to a window that does not
+// speak AT-SPI (xterm, games): insist the object still has it. With
+// editable set it must also accept text right now; a read-only or
+// disabled field keeps the EditableText interface.
+static bool still_focused(AtspiTextImpl * impl, const std::string & bus, const std::string & path,
+                          bool editable = false) {
+    GVariant * reply = call(impl, bus, path, "org.a11y.atspi.Accessible", "GetState", nullptr, "(au)");
+    if (!reply) return false;
+    GVariant * states = g_variant_get_child_value(reply, 0);
+    guint32 bits = 0;
+    if (g_variant_n_children(states) > 0) {
+        GVariant * word = g_variant_get_child_value(states, 0);
+        bits = g_variant_get_uint32(word);
+        g_variant_unref(word);
+    }
+    g_variant_unref(states);
+    g_variant_unref(reply);
+    guint32 want = 1u << ATSPI_STATE_FOCUSED;
+    if (editable) want |= 1u << ATSPI_STATE_EDITABLE;
+    return (bits & want) == want;
+}
+
+static bool caret_offset(AtspiTextImpl * impl, const std::string & bus, const std::string & path, gint32 & caret) {
+    GVariant * reply = call(impl, bus, path, "org.freedesktop.DBus.Properties", "Get",
+                            g_variant_new("(ss)", "org.a11y.atspi.Text", "CaretOffset"), "(v)");
+    if (!reply) return false;
+    GVariant * value = nullptr;
+    g_variant_get(reply, "(v)", &value);
+    const bool ok = g_variant_is_of_type(value, G_VARIANT_TYPE("i"));
+    if (ok) caret = g_variant_get_int32(value);
+    g_variant_unref(value);
+    g_variant_unref(reply);
+    return ok;
+}
+
+bool AtspiText::insert(const std::string & text) {
+    if (!m_impl) return false;
+
+    std::string bus, path;
+    int editable;
+    {
+        std::lock_guard<std::mutex> lock(m_impl->mutex);
+        bus      = m_impl->focus_bus;
+        path     = m_impl->focus_path;
+        editable = m_impl->focus_editable;
+    }
+    if (bus.empty() || editable == 0) return false;
+
+    // Interfaces don't change for an object: look them up once per focus
+    if (editable < 0) {
+        GVariant * reply = call(m_impl.get(), bus, path, "org.a11y.atspi.Accessible", "GetInterfaces",
+                                nullptr, "(as)");
+        if (!reply) return false;
+        GVariantIter * it = nullptr;
+        const gchar * name = nullptr;
+        editable = 0;
+        g_variant_get(reply, "(as)", &it);
+        while (g_variant_iter_next(it, "&s", &name)) {
+            if (strcmp(name, "org.a11y.atspi.EditableText") == 0) editable = 1;
+        }
+        g_variant_iter_free(it);
+        g_variant_unref(reply);
+
+        std::lock_guard<std::mutex> lock(m_impl->mutex);
+        if (m_impl->focus_bus == bus && m_impl->focus_path == path) m_impl->focus_editable = editable;
+        if (!editable) return false;
+    }
+
+    if (!still_focused(m_impl.get(), bus, path, true)) return false;
+
+    gint32 caret = 0;
+    if (!caret_offset(m_impl.get(), bus, path, caret)) return false;
+
+    // InsertText(position, text, length in characters)
+    const gint32 length = (gint32) g_utf8_strlen(text.c_str(), -1);
+    GVariant * reply = call(m_impl.get(), bus, path, "org.a11y.atspi.EditableText", "InsertText",
+                            g_variant_new("(isi)", caret, text.c_str(), length), "(b)");
+    if (!reply) return false;
+    gboolean ok = FALSE;
+    g_variant_get(reply, "(b)", &ok);
+    g_variant_unref(reply);
+    return ok;
+}
+
+bool AtspiText::text_before_caret(size_t n_chars, int & caret, std::string & out) {
+    if (!m_impl) return false;
+
+    std::string bus, path;
+    {
+        std::lock_guard<std::mutex> lock(m_impl->mutex);
+        bus  = m_impl->focus_bus;
+        path = m_impl->focus_path;
+    }
+    if (bus.empty() || !still_focused(m_impl.get(), bus, path)) return false;
+
+    gint32 offset = 0;
+    if (!caret_offset(m_impl.get(), bus, path, offset) || offset < 0) return false;
+    caret = offset;
+    out.clear();
+    if (n_chars == 0) return true;
+
+    // GetText(start, end) in characters, end exclusive
+    const gint32 start = offset > (gint32) n_chars ? offset - (gint32) n_chars : 0;
+    GVariant * reply = call(m_impl.get(), bus, path, "org.a11y.atspi.Text", "GetText",
+                            g_variant_new("(ii)", start, offset), "(s)");
+    if (!reply) return false;
+    const gchar * text = nullptr;
+    g_variant_get(reply, "(&s)", &text);
+    out = text;
+    g_variant_unref(reply);
+    return true;
+}
+
+bool AtspiText::focused_is_password() {
+    if (!m_impl) return false;
+
+    std::string bus, path;
+    int password;
+    {
+        std::lock_guard<std::mutex> lock(m_impl->mutex);
+        bus      = m_impl->focus_bus;
+        path     = m_impl->focus_path;
+        password = m_impl->focus_password;
+    }
+    if (bus.empty()) return false;
+    if (password >= 0) return password;
+
+    // The role does not change for an object: look it up once per focus
+    GVariant * reply = call(m_impl.get(), bus, path, "org.a11y.atspi.Accessible", "GetRole", nullptr, "(u)");
+    if (!reply) return false;
+    guint32 role = 0;
+    g_variant_get(reply, "(u)", &role);
+    g_variant_unref(reply);
+    password = role == ATSPI_ROLE_PASSWORD_TEXT;
+
+    std::lock_guard<std::mutex> lock(m_impl->mutex);
+    if (m_impl->focus_bus == bus && m_impl->focus_path == path) m_impl->focus_password = password;
+    return password;
+}
+
+std::string AtspiText::focused_app() {
+    if (!m_impl) return "";
+
+    std::string bus;
+    {
+        std::lock_guard<std::mutex> lock(m_impl->mutex);
+        bus = m_impl->focus_bus;
+    }
+    if (bus.empty()) return "";
+    if (bus == m_impl->app_bus) return m_impl->app_name;
+
+    GVariant * reply = call(m_impl.get(), bus, "/org/a11y/atspi/accessible/root", "org.freedesktop.DBus.Properties",
+                            "Get", g_variant_new("(ss)", "org.a11y.atspi.Accessible", "Name"), "(v)");
+    if (!reply) return "";
+    GVariant * value = nullptr;
+    g_variant_get(reply, "(v)", &value);
+    std::string name = g_variant_is_of_type(value, G_VARIANT_TYPE("s")) ? g_variant_get_string(value, nullptr) : "";
+    g_variant_unref(value);
+    g_variant_unref(reply);
+
+    m_impl->app_bus  = bus;
+    m_impl->app_name = name;
+    return name;
+}
+
+void AtspiText::shutdown() {
+    if (!m_impl) return;
+    g_main_context_invoke(m_impl->context, [](gpointer loop) -> gboolean {
+        g_main_loop_quit(static_cast<GMainLoop *>(loop));
+        return G_SOURCE_REMOVE;
+    }, m_impl->loop);
+    if (m_impl->worker.joinable()) m_impl->worker.join();
+
+    g_main_loop_unref(m_impl->loop);
+    g_main_context_unref(m_impl->context);
+    g_object_unref(m_impl->conn);
+    m_impl.reset();
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+#ifdef HAS_DBUS
+
+struct AtspiTextImpl;
+
+// Direct text insertion through the AT-SPI accessibility bus.
+//
+// Keeps one connection to the accessibility bus and follows focus changes
+// on a background GLib loop, so the focused object is known without a
+// lookup when a transcript arrives. Text goes in with one EditableText
+// InsertText call at the caret: instant, and it never touches the
+// clipboard or depends on keystroke timing.
+//
+// Only works for toolkits that expose EditableText (GTK, Qt with
+// accessibility enabled, LibreOffice, Firefox/Chromium with a11y on).
+class AtspiText {
+public:
+    AtspiText();
+    ~AtspiText();
+
+    AtspiText(const AtspiText &) = delete;
+    AtspiText & operator=(const AtspiText &) = delete;
+
+    // Connect to the accessibility bus and start following focus.
+    // Returns false if there is no accessibility bus.
+    bool init();
+
+    // Insert text at the caret of the focused widget. Returns false,
+    // without side effects, if the focused widget is unknown or not
+    // editable through AT-SPI; the caller then falls back.
+    bool insert(const std::string & text);
+
+    // Name of the application that has focus (its accessible root's Name),
+    // empty if unknown. Cached per application.
+    std::string focused_app();
+
+    // Whether the focused widget is a password field (PASSWORD_TEXT role).
+    // False if unknown. Cached per focus.
+    bool focused_is_password();
+
+    // Caret offset of the focused widget and the up to n_chars characters
+    // before it, through the Text interface. Only reads: the selection,
+    // caret and clipboard are left alone. Returns false if the focused
+    // widget is unknown or exposes no text.
+    bool text_before_caret(size_t n_chars, int & caret, std::string & out);
+
+    bool is_initialized() const { return m_impl != nullptr; }
+
+    void shutdown();
+
+private:
+    std::unique_ptr<AtspiTextImpl> m_impl;
+};
+
+#else
+
+// Stub when built without D-Bus
+class AtspiText {
+public:
+    bool init() { return false; }
+    bool insert(const std::string &) { return false; }
+    std::string focused_app() { return ""; }
+    bool focused_is_password() { return false; }
+    bool text_before_caret(size_t, int &, std::string &) { return false; }
+    bool is_initialized() const { return false; }
+    void shutdown() {}
+};
+
+#endif
@@ -0,0 +1,448 @@
+#include "capture.h"
+#include "level_meter.h"
+#include "resampler.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+
+#include <SDL.h>
+
+#ifdef HAS_PIPEWIRE
+#include <pipewire/pipewire.h>
+#include <spa/param/audio/format-utils.h>
+#endif
+
+// Requested period: 256 samples = 16 ms at 16 kHz
+static constexpr int CAPTURE_PERIOD_SAMPLES = 256;
+
+enum class CaptureBackend { NONE, PIPEWIRE, SDL };
+
+struct AudioCaptureImpl {
+    CaptureRing    ring;
+    CaptureBackend backend     = CaptureBackend::NONE;
+    int            sample_rate = 0;
+    bool           native_rate = false;
+
+    // In-process conversion from the device rate (native_rate only). The
+    // format can be renegotiated while the stream runs, so a converter is
+    // never changed in place: set_device_rate builds a new one, swaps it in
+    // and frees the old one once no callback can still be using it.
+    struct RateConverter {
+        Resampler          resampler;
+        std::vector<float> out;
+    };
+    std::atomic<int>               device_rate{0};
+    std::atomic<RateConverter *>   converter{nullptr};  // nullptr: device already at sample_rate
+    std::unique_ptr<RateConverter> converter_owned;     // control side
+
+    // steady_clock time (ns) of the last callback, for position_at()
+    std::atomic<int64_t> last_cb_ns{0};
+
+    std::atomic<bool> failed{false};  // stream error reported by the backend
+
+    // Display levels, computed on the audio thread from what goes into the ring
+    std::atomic<LevelMeter *> meter{nullptr};
+    LevelDecimator            decimator;
+
+    // Set while the audio thread is in on_samples. Whoever replaces the
+    // meter or the converter waits it out before letting go of the old one
+    // (both sides sequentially consistent: either the callback sees the new
+    // pointer, or the waiter sees the flag).
+    std::atomic<bool> in_callback{false};
+
+    void wait_callback() const {
+        while (in_callback.load()) std::this_thread::yield();
+    }
+
+#ifdef HAS_PIPEWIRE
+    pw_thread_loop * pw_loop = nullptr;
+    pw_stream      * stream  = nullptr;
+#endif
+
+    SDL_AudioDeviceID sdl_dev = 0;
+
+    // Called when the device rate is negotiated, possibly again while the
+    // stream runs
+    bool set_device_rate(int rate) {
+        std::unique_ptr<RateConverter> next;
+        if (rate != sample_rate) {
+            next = std::make_unique<RateConverter>();
+            if (!next->resampler.init(rate, sample_rate)) {
+                fprintf(stderr, "capture: cannot resample %d Hz to %d Hz\n", rate, sample_rate);
+                return false;
+            }
+            next->out.resize(next->resampler.max_output(next->resampler.max_input()));
+            fprintf(stderr, "capture: device rate %d Hz, resampling in-process (%d taps, %.1f ms latency)\n",
+                    rate, next->resampler.taps_per_phase(), next->resampler.latency_ms());
+        }
+        device_rate = rate;
+        converter.store(next.get());
+        wait_callback();
+        converter_owned = std::move(next);
+        return true;
+    }
+
+    // Producer side, called from the backend's audio thread
+    void on_samples(const float * data, size_t n) {
+        in_callback.store(true);
+        LevelMeter *    m  = meter.load();
+        RateConverter * rc = converter.load();
+        if (rc) {
+            while (n > 0) {
+                size_t chunk = std::min(n, rc->resampler.max_input());
+                size_t out   = rc->resampler.process(data, chunk, rc->out.data());
+                ring.write(rc->out.data(), out);
+                if (m) decimator.push(rc->out.data(), out, *m);
+                data += chunk;
+                n    -= chunk;
+            }
+        } else {
+            ring.write(data, n);
+            if (m) decimator.push(data, n, *m);
+        }
+        in_callback.store(false, std::memory_order_release);
+        last_cb_ns.store(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count(), std::memory_order_release);
+    }
+};
+
+// ---- PipeWire backend ----
+
+#ifdef HAS_PIPEWIRE
+static void pw_on_process(void * data) {
+    auto * impl = static_cast<AudioCaptureImpl *>(data);
+    pw_buffer * b = pw_stream_dequeue_buffer(impl->stream);
+    if (!b) return;
+
+    spa_data & d = b->buffer->datas[0];
+    if (d.data && d.chunk) {
+        uint32_t offset = std::min(d.chunk->offset, d.maxsize);
+        uint32_t size   = std::min(d.chunk->size, d.maxsize - offset);
+        impl->on_samples(reinterpret_cast<const float *>(static_cast<const uint8_t *>(d.data) + offset),
+                         size / sizeof(float));
+    }
+    pw_stream_queue_buffer(impl->stream, b);
+}
+
+static void pw_on_state_changed(void * data, pw_stream_state /*old*/, pw_stream_state state, const char * error) {
+    if (state == PW_STREAM_STATE_ERROR) {
+        fprintf(stderr, "capture: PipeWire stream error: %s\n", error ? error : "unknown");
+        static_cast<AudioCaptureImpl *>(data)->failed = true;
+    }
+}
+
+// Native rate: the format is negotiated with the rate left open. It can
+// change later (the source is switched or reconfigured); set_device_rate
+// swaps converters safely against the RT process callback.
+static void pw_on_param_changed(void * data, uint32_t id, const spa_pod * param) {
+    auto * impl = static_cast<AudioCaptureImpl *>(data);
+    if (!param || id != SPA_PARAM_Format) return;
+
+    spa_audio_info_raw info = {};
+    if (spa_format_audio_raw_parse(param, &info) < 0) return;
+    if (info.channels != 1 || info.rate == 0) {
+        fprintf(stderr, "capture: unexpected PipeWire format (%u ch, %u Hz)\n", info.channels, info.rate);
+        return;
+    }
+    impl->set_device_rate((int) info.rate);
+}
+
+static pw_stream_events make_pw_stream_events() {
+    pw_stream_events ev = {};
+    ev.version       = PW_VERSION_STREAM_EVENTS;
+    ev.state_changed = pw_on_state_changed;
+    ev.param_changed = pw_on_param_changed;
+    ev.process       = pw_on_process;
+    return ev;
+}
+
+static const pw_stream_events s_pw_stream_events = make_pw_stream_events();
+
+static void pw_close(AudioCaptureImpl * impl) {
+    if (impl->pw_loop) pw_thread_loop_stop(impl->pw_loop);
+    if (impl->stream) {
+        pw_stream_destroy(impl->stream);
+        impl->stream = nullptr;
+    }
+    if (impl->pw_loop) {
+        pw_thread_loop_destroy(impl->pw_loop);
+        impl->pw_loop = nullptr;
+    }
+}
+
+static bool pw_open(AudioCaptureImpl * impl, int sample_rate) {
+    pw_init(nullptr, nullptr);
+
+    impl->pw_loop = pw_thread_loop_new("wt-capture", nullptr);
+    if (!impl->pw_loop) return false;
+
+    // Ask the graph for a small quantum; the adapter converts to our format
+    char latency[32];
+    snprintf(latency, sizeof(latency), "%d/%d", CAPTURE_PERIOD_SAMPLES, sample_rate);
+    pw_properties * props = pw_properties_new(
+        PW_KEY_MEDIA_TYPE,     "Audio",
+        PW_KEY_MEDIA_CATEGORY, "Capture",
+        PW_KEY_MEDIA_ROLE,     "Communication",
+        PW_KEY_APP_NAME,       "whisper-typer",
+        PW_KEY_NODE_NAME,      "whisper-typer",
+        PW_KEY_NODE_LATENCY,   latency,
+        nullptr);
+
+    impl->stream = pw_stream_new_simple(pw_thread_loop_get_loop(impl->pw_loop), "whisper-typer",
+                                        props, &s_pw_stream_events, impl);
+    if (!impl->stream) {
+        pw_close(impl);
+        return false;
+    }
+
+    // Rate 0 leaves it to the graph (the device rate) in native mode
+    spa_audio_info_raw info = {};
+    info.format   = SPA_AUDIO_FORMAT_F32;
+    info.rate     = impl->native_rate ? 0 : (uint32_t) sample_rate;
+    info.channels = 1;
+
+    uint8_t pod_buf[1024];
+    spa_pod_builder builder;
+    spa_pod_builder_init(&builder, pod_buf, sizeof(pod_buf));
+    const spa_pod * params[1] = { spa_format_audio_raw_build(&builder, SPA_PARAM_EnumFormat, &info) };
+
+    // Connected inactive: resume() starts the flow
+    int ret = pw_stream_connect(impl->stream, PW_DIRECTION_INPUT, PW_ID_ANY,
+                                (pw_stream_flags) (PW_STREAM_FLAG_AUTOCONNECT |
+                                                   PW_STREAM_FLAG_MAP_BUFFERS |
+                                                   PW_STREAM_FLAG_RT_PROCESS |
+                                                   PW_STREAM_FLAG_INACTIVE),
+                                params, 1);
+    if (ret < 0 || pw_thread_loop_start(impl->pw_loop) < 0) {
+        pw_close(impl);
+        return false;
+    }
+    return true;
+}
+
+static bool pw_set_active(AudioCaptureImpl * impl, bool active) {
+    pw_thread_loop_lock(impl->pw_loop);
+    int ret = pw_stream_set_active(impl->stream, active);
+    pw_thread_loop_unlock(impl->pw_loop);
+    return ret >= 0;
+}
+#endif
+
+// ---- SDL backend ----
+
+// Asked for in native mode; SDL reports the device's rate if it differs
+static constexpr int SDL_NATIVE_RATE = 48000;
+
+static void sdl_callback(void * userdata, Uint8 * stream, int len) {
+    auto * impl = static_cast<AudioCaptureImpl *>(userdata);
+    impl->on_samples(reinterpret_cast<const float *>(stream), (size_t) len / sizeof(float));
+}
+
+// The audio subsystem is initialized once and kept until exit. SDL's init
+// and quit are not thread-safe: an init/quit pair per device scan would
+// race the GUI thread's SDL calls.
+static bool sdl_audio_init() {
+    static const bool ok = [] {
+        SDL_SetHintWithPriority(SDL_HINT_AUDIO_RESAMPLING_MODE, "medium", SDL_HINT_OVERRIDE);
+        if (SDL_InitSubSystem(SDL_INIT_AUDIO) < 0) {
+            fprintf(stderr, "capture: SDL audio init failed: %s\n", SDL_GetError());
+            return false;
+        }
+        return true;
+    }();
+    return ok;
+}
+
+static bool sdl_open(AudioCaptureImpl * impl, int capture_id, int sample_rate) {
+    if (!sdl_audio_init()) return false;
+
+    const int rate = impl->native_rate ? SDL_NATIVE_RATE : sample_rate;
+
+    SDL_AudioSpec want = {};
+    SDL_AudioSpec have = {};
+    want.freq     = rate;
+    want.format   = AUDIO_F32;
+    want.channels = 1;
+    want.samples  = (Uint16) (CAPTURE_PERIOD_SAMPLES * rate / sample_rate);
+    want.callback = sdl_callback;
+    want.userdata = impl;
+
+    // Default: no allowed changes, SDL converts to exactly what we asked for.
+    // Native: take the device's rate and convert ourselves.
+    const char * name = capture_id >= 0 ? SDL_GetAudioDeviceName(capture_id, SDL_TRUE) : nullptr;
+    impl->sdl_dev = SDL_OpenAudioDevice(name, SDL_TRUE, &want, &have,
+                                        impl->native_rate ? SDL_AUDIO_ALLOW_FREQUENCY_CHANGE : 0);
+    if (!impl->sdl_dev) {
+        fprintf(stderr, "capture: couldn't open SDL capture device %s: %s\n",
+                name ? name : "(default)", SDL_GetError());
+        return false;
+    }
+    fprintf(stderr, "capture: SDL device '%s', %d Hz, period %d\n",
+            name ? name : "(default)", have.freq, have.samples);
+    if (!impl->set_device_rate(have.freq)) {
+        SDL_CloseAudioDevice(impl->sdl_dev);
+        impl->sdl_dev = 0;
+        return false;
+    }
+    return true;
+}
+
+static void sdl_close(AudioCaptureImpl * impl) {
+    if (impl->sdl_dev) {
+        SDL_CloseAudioDevice(impl->sdl_dev);
+        impl->sdl_dev = 0;
+    }
+}
+
+// ---- AudioCapture ----
+
+AudioCapture::AudioCapture() = default;
+AudioCapture::~AudioCapture() { shutdown(); }
+
+bool AudioCapture::init(const std::string & backend, int capture_id, int sample_rate, int ring_ms,
+                        bool native_rate) {
+    shutdown();
+    m_impl = std::make_unique<AudioCaptureImpl>();
+    m_impl->sample_rate = sample_rate;
+    m_impl->native_rate = native_rate;
+    m_impl->device_rate = sample_rate;
+    m_impl->ring.reset((size_t) sample_rate * ring_ms / 1000);
+
+    if (backend != "auto" && backend != "pipewire" && backend != "sdl") {
+        fprintf(stderr, "capture: unknown backend '%s'\n", backend.c_str());
+        m_impl.reset();
+        return false;
+    }
+
+#ifdef HAS_PIPEWIRE
+    // PipeWire has no notion of SDL device indices
+    bool try_pw = backend == "pipewire" || (backend == "auto" && capture_id < 0);
+    if (try_pw) {
+        if (pw_open(m_impl.get(), sample_rate)) {
+            m_impl->backend = CaptureBackend::PIPEWIRE;
+            return true;
+        }
+        fprintf(stderr, "capture: PipeWire unavailable%s\n", backend == "auto" ? ", trying SDL" : "");
+        if (backend == "pipewire") {
+            m_impl.reset();
+            return false;
+        }
+    }
+#else
+    if (backend == "pipewire") {
+        fprintf(stderr, "capture: built without PipeWire support\n");
+        m_impl.reset();
+        return false;
+    }
+#endif
+
+    if (sdl_open(m_impl.get(), capture_id, sample_rate)) {
+        m_impl->backend = CaptureBackend::SDL;
+        return true;
+    }
+    m_impl.reset();
+    return false;
+}
+
+bool AudioCapture::resume() {
+    if (!m_impl) return false;
+    switch (m_impl->backend) {
+#ifdef HAS_PIPEWIRE
+        case CaptureBackend::PIPEWIRE: return pw_set_active(m_impl.get(), true);
+#endif
+        case CaptureBackend::SDL:      SDL_PauseAudioDevice(m_impl->sdl_dev, 0); return true;
+        default:                       return false;
+    }
+}
+
+bool AudioCapture::pause() {
+    if (!m_impl) return false;
+    switch (m_impl->backend) {
+#ifdef HAS_PIPEWIRE
+        case CaptureBackend::PIPEWIRE: return pw_set_active(m_impl.get(), false);
+#endif
+        case CaptureBackend::SDL:      SDL_PauseAudioDevice(m_impl->sdl_dev, 1); return true;
+        default:                       return false;
+    }
+}
+
+void AudioCapture::shutdown() {
+    if (!m_impl) return;
+#ifdef HAS_PIPEWIRE
+    pw_close(m_impl.get());
+#endif
+    sdl_close(m_impl.get());
+    m_impl.reset();
+}
+
+const char * AudioCapture::backend_name() const {
+    if (!m_impl) return "none";
+    switch (m_impl->backend) {
+        case CaptureBackend::PIPEWIRE: return "pipewire";
+        case CaptureBackend::SDL:      return "sdl";
+        default:                       return "none";
+    }
+}
+
+int AudioCapture::sample_rate() const {
+    return m_impl ? m_impl->sample_rate : 0;
+}
+
+int AudioCapture::device_rate() const {
+    return m_impl ? m_impl->device_rate.load() : 0;
+}
+
+uint64_t AudioCapture::position() const {
+    return m_impl ? m_impl->ring.position() : 0;
+}
+
+uint64_t AudioCapture::position_at(std::chrono::steady_clock::time_point t) const {
+    if (!m_impl) return 0;
+    int64_t  cb_ns = m_impl->last_cb_ns.load(std::memory_order_acquire);
+    uint64_t pos   = m_impl->ring.position();
+    int64_t  t_ns  = std::chrono::duration_cast<std::chrono::nanoseconds>(t.time_since_epoch()).count();
+    if (cb_ns == 0 || t_ns >= cb_ns) return pos;
+
+    uint64_t back = (uint64_t) ((double) (cb_ns - t_ns) * m_impl->sample_rate / 1e9);
+    return back < pos ? pos - back : 0;
+}
+
+uint64_t AudioCapture::read(uint64_t from, uint64_t to, std::vector<float> & out) const {
+    if (!m_impl) {
+        out.clear();
+        return from;
+    }
+    return m_impl->ring.read(from, to, out);
+}
+
+uint64_t AudioCapture::ms_to_samples(int64_t ms) const {
+    return m_impl && ms > 0 ? (uint64_t) ms * m_impl->sample_rate / 1000 : 0;
+}
+
+void AudioCapture::set_meter(LevelMeter * meter) {
+    if (!m_impl) return;
+    m_impl->meter.store(meter);
+    if (!meter) m_impl->wait_callback();
+}
+
+bool AudioCapture::alive() const {
+    if (!m_impl || m_impl->failed) return false;
+    // SDL reports a disconnected device as stopped; ours are only ever playing or paused
+    if (m_impl->backend == CaptureBackend::SDL) {
+        return SDL_GetAudioDeviceStatus(m_impl->sdl_dev) != SDL_AUDIO_STOPPED;
+    }
+    return true;
+}
+
+std::vector<std::string> AudioCapture::list_devices() {
+    std::vector<std::string> names;
+    if (!sdl_audio_init()) return names;
+    int n = SDL_GetNumAudioDevices(SDL_TRUE);
+    for (int i = 0; i < n; i++) {
+        const char * name = SDL_GetAudioDeviceName(i, SDL_TRUE);
+        names.push_back(name ? name : "");
+    }
+    return names;
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Lock-free single-producer ring of mono float samples.
+//
+// Samples are addressed by their absolute position in the stream (number of
+// samples captured before them), so consumers keep their own read positions
+// instead of clearing the ring. The producer (audio callback) never blocks
+// and overwrites the oldest samples when full. Readers validate their copy
+// against the writer's reservation, seqlock-style, and drop any prefix the
+// writer may have overwritten meanwhile.
+class CaptureRing {
+public:
+    explicit CaptureRing(size_t min_capacity = 0);
+
+    // Allocate for at least min_capacity samples (rounded up to a power of
+    // two) and rewind to position 0. Not safe while the producer is running.
+    void reset(size_t min_capacity);
+
+    // Producer: append n samples
+    void write(const float * data, size_t n);
+
+    // Position one past the newest sample
+    uint64_t position() const { return m_write.load(std::memory_order_acquire); }
+
+    // Position of the oldest sample still retained
+    uint64_t oldest() const;
+
+    size_t capacity() const { return m_buf.size(); }
+
+    // Copy samples [from, to) into out. `to` is clamped to position() and
+    // `from` to the oldest intact sample. Returns the position of out[0].
+    uint64_t read(uint64_t from, uint64_t to, std::vector<float> & out) const;
+
+private:
+    std::vector<float>    m_buf;
+    size_t                m_mask = 0;
+    std::atomic<uint64_t> m_write{0};    // published end
+    std::atomic<uint64_t> m_reserve{0};  // end of the write in progress
+};
+
+struct AudioCaptureImpl;
+class LevelMeter;
+
+// Microphone capture into a CaptureRing.
+//
+// Backends, tried in order for "auto":
+//   pipewire  native pw_stream, 16 kHz mono F32 requested from the graph,
+//             small quantum (node.latency) for low latency
+//   sdl       SDL2 audio device (PulseAudio, ALSA, ... whatever SDL picks)
+// The default device is used unless capture_id selects an SDL device index.
+//
+// With native_rate, the device is opened at its own rate (typically 44.1 or
+// 48 kHz) and converted to sample_rate in-process by the polyphase Resampler
+// in the capture callback, instead of by SDL or the sound server.
+class AudioCapture {
+public:
+    AudioCapture();
+    ~AudioCapture();
+
+    AudioCapture(const AudioCapture &) = delete;
+    AudioCapture & operator=(const AudioCapture &) = delete;
+
+    // backend: "auto", "pipewire" or "sdl". ring_ms is how much audio stays
+    // readable. The stream starts paused.
+    bool init(const std::string & backend, int capture_id, int sample_rate, int ring_ms,
+              bool native_rate = false);
+
+    bool resume();
+    bool pause();
+    void shutdown();
+
+    const char * backend_name() const;
+    int sample_rate() const;
+
+    // Rate the device delivers; differs from sample_rate() when resampling
+    int device_rate() const;
+
+    // Stream position (samples captured so far)
+    uint64_t position() const;
+
+    // Estimated stream position at time t, from the timestamp of the last
+    // callback. Accurate to about one callback period.
+    uint64_t position_at(std::chrono::steady_clock::time_point t) const;
+
+    // Copy samples [from, to) into out; see CaptureRing::read()
+    uint64_t read(uint64_t from, uint64_t to, std::vector<float> & out) const;
+
+    // Convert a duration in ms to samples at the capture rate
+    uint64_t ms_to_samples(int64_t ms) const;
+
+    // False once the device has gone away (unplugged, stream error)
+    bool alive() const;
+
+    // Publish decimated levels of the captured audio to meter from the
+    // capture callback (nullptr to stop). The meter must outlive the stream
+    // or be detached first. Detaching returns once a running callback is
+    // done with the meter.
+    void set_meter(LevelMeter * meter);
+
+    // Names of the SDL capture devices, indexed like capture_id. Re-enumerates,
+    // so hotplugged devices show up.
+    static std::vector<std::string> list_devices();
+
+private:
+    std::unique_ptr<AudioCaptureImpl> m_impl;
+};
@@ -0,0 +1,248 @@
+#include "capture_manager.h"
+#include "whisper.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <map>
+
+// How often the SDL device list is re-read while idle (multi mode)
+static constexpr auto DEVICE_SCAN_INTERVAL = std::chrono::seconds(2);
+
+// Recording blocks: 1 s at the capture rate; up to 10 s worth stay cached
+// while idle so short utterances do not allocate
+static constexpr size_t RECORD_BLOCK_SAMPLES = WHISPER_SAMPLE_RATE;
+static constexpr size_t RECORD_FREE_BLOCKS   = 10;
+
+// record_tick() interval of the background drain, well inside any ring span
+static constexpr auto BACKGROUND_DRAIN_INTERVAL = std::chrono::milliseconds(100);
+
+CaptureManager::CaptureManager() : m_pool(RECORD_BLOCK_SAMPLES, RECORD_FREE_BLOCKS) {}
+
+bool CaptureManager::init(const CaptureOptions & opts) {
+    shutdown();
+    m_opts = opts;
+
+    if (m_opts.multi && m_opts.backend == "pipewire") {
+        fprintf(stderr, "capture: multi-mic uses SDL devices, ignoring backend 'pipewire'\n");
+    }
+
+    bool ok = true;
+    if (!m_opts.multi) {
+        ok = open_source("", m_opts.capture_id);
+    } else {
+        scan_devices();
+        if (m_sources.empty()) {
+            fprintf(stderr, "capture: no capture devices found, using the default device\n");
+            m_opts.multi = false;
+            ok = open_source("", -1);
+        }
+    }
+    attach_meter();
+    return ok;
+}
+
+// The meter takes one publisher at a time: detach the others before the
+// lead's callback starts writing
+void CaptureManager::attach_meter() {
+    for (size_t i = 0; i < m_sources.size(); i++) {
+        if (i != m_lead) m_sources[i].capture->set_meter(nullptr);
+    }
+    if (m_lead < m_sources.size()) m_sources[m_lead].capture->set_meter(&m_meter);
+}
+
+void CaptureManager::shutdown() {
+    end_background_drain();
+    for (auto & s : m_sources) s.capture->shutdown();
+    m_sources.clear();
+    m_lead = 0;
+}
+
+bool CaptureManager::open_source(const std::string & device, int capture_id) {
+    CaptureSource s(m_pool);
+    s.noise_hp.set_cutoff(m_opts.freq_thold, (float) m_opts.sample_rate);
+    s.level_hp.set_cutoff(m_opts.freq_thold, (float) m_opts.sample_rate);
+    s.device  = device;
+    s.name    = device;
+    s.capture = std::make_unique<AudioCapture>();
+    const std::string backend = m_opts.multi ? "sdl" : m_opts.backend;
+    if (!s.capture->init(backend, capture_id, m_opts.sample_rate, m_opts.ring_ms, m_opts.native_rate)) {
+        return false;
+    }
+    if (s.name.empty()) s.name = s.capture->backend_name();
+
+    // Identical models share a device name; the label tells them apart
+    for (int copy = 2; std::any_of(m_sources.begin(), m_sources.end(),
+                                   [&](const CaptureSource & o) { return o.name == s.name; }); copy++) {
+        s.name = s.device + " (" + std::to_string(copy) + ")";
+    }
+
+    // Capture runs all the time: the pre-roll before a keypress and the idle
+    // noise floor both come from the ring
+    s.capture->resume();
+    s.noise_pos = s.capture->position();
+    m_sources.push_back(std::move(s));
+    return true;
+}
+
+void CaptureManager::scan_devices() {
+    m_last_scan = std::chrono::steady_clock::now();
+
+    // Drop unplugged devices, but never the last source: the lead must exist
+    const AudioCapture * lead = m_sources.empty() ? nullptr : m_sources[m_lead].capture.get();
+    for (size_t i = 0; i < m_sources.size() && m_sources.size() > 1;) {
+        if (m_sources[i].capture->alive()) {
+            i++;
+            continue;
+        }
+        fprintf(stderr, "capture: '%s' disconnected\n", m_sources[i].name.c_str());
+        m_sources[i].capture->shutdown();
+        m_sources.erase(m_sources.begin() + i);
+    }
+
+    // Open new ones. SDL indices shift on hotplug and SDL 2 has no stable
+    // device ID, so devices are matched by name and counted: the n-th
+    // device of a name is new when fewer than n of that name are open.
+    // They are opened right after enumeration.
+    const auto names = AudioCapture::list_devices();
+    std::map<std::string, size_t> listed;
+    for (size_t i = 0; i < names.size(); i++) {
+        const size_t nth  = ++listed[names[i]];
+        const size_t n_open = (size_t) std::count_if(m_sources.begin(), m_sources.end(),
+                                                     [&](const CaptureSource & s) { return s.device == names[i]; });
+        if (n_open >= nth) continue;
+        if (open_source(names[i], (int) i)) {
+            fprintf(stderr, "capture: added '%s'\n", m_sources.back().name.c_str());
+        }
+    }
+
+    m_lead = 0;
+    for (size_t i = 0; i < m_sources.size(); i++) {
+        if (m_sources[i].capture.get() == lead) m_lead = i;
+    }
+    attach_meter();
+}
+
+void CaptureManager::idle_tick() {
+    for (size_t i = 0; i < m_sources.size(); i++) {
+        auto & s = m_sources[i];
+        // Calibration reports come from the lead only
+        s.noise.set_collect(m_opts.collect && i == m_lead);
+
+        uint64_t pos = s.capture->position();
+        s.capture->read(s.noise_pos, pos, m_buf);
+        s.noise_pos = pos;
+        s.noise_hp.process(m_buf.data(), m_buf.size());
+        s.noise.feed(m_buf.data(), m_buf.size());
+    }
+
+    if (m_opts.multi && std::chrono::steady_clock::now() - m_last_scan >= DEVICE_SCAN_INTERVAL) {
+        scan_devices();
+    }
+}
+
+void CaptureManager::set_freq_thold(float hz) {
+    m_opts.freq_thold = hz;
+    for (auto & s : m_sources) {
+        s.noise_hp.set_cutoff(hz, (float) m_opts.sample_rate);
+        s.level_hp.set_cutoff(hz, (float) m_opts.sample_rate);
+    }
+}
+
+void CaptureManager::start_recording(std::chrono::steady_clock::time_point key_time, int pre_roll_ms) {
+    for (auto & s : m_sources) {
+        uint64_t key_pos = s.capture->position_at(key_time);
+        uint64_t pre     = s.capture->ms_to_samples(pre_roll_ms);
+        s.record_pos   = key_pos > pre ? key_pos - pre : 0;
+        s.record_start = s.record_pos;
+        s.recording.clear();
+        s.level.reset();
+        s.level_hp.reset();
+    }
+    record_tick();
+}
+
+size_t CaptureManager::lead_length_at(std::chrono::steady_clock::time_point t) const {
+    const CaptureSource & s = m_sources[m_lead];
+    const uint64_t end = s.capture->position_at(t);
+    if (end <= s.record_start) return 0;
+    return (size_t) std::min<uint64_t>(end - s.record_start, s.recording.size());
+}
+
+void CaptureManager::record_tick() {
+    for (auto & s : m_sources) {
+        uint64_t pos   = s.capture->position();
+        uint64_t first = s.capture->read(s.record_pos, pos, m_buf);
+        if (first > s.record_pos + s.capture->ms_to_samples(50)) {
+            fprintf(stderr, "capture: '%s' lost %d ms of audio (main loop stalled)\n", s.name.c_str(),
+                    (int) ((first - s.record_pos) * 1000 / m_opts.sample_rate));
+        }
+        s.recording.append(m_buf.data(), m_buf.size());
+        s.record_pos = first + m_buf.size();
+
+        // Level as the energy VAD sees it, for ranking the mics afterwards
+        if (m_opts.multi) {
+            m_filtered = m_buf;
+            s.level_hp.process(m_filtered.data(), m_filtered.size());
+            s.level.feed(m_filtered.data(), m_filtered.size());
+        }
+    }
+}
+
+void CaptureManager::begin_background_drain() {
+    end_background_drain();
+    m_drain_stop = false;
+    m_drain = std::thread([this]() {
+        std::unique_lock<std::mutex> lock(m_drain_mutex);
+        while (!m_drain_cv.wait_for(lock, BACKGROUND_DRAIN_INTERVAL, [this]() { return m_drain_stop; })) {
+            record_tick();
+        }
+    });
+}
+
+void CaptureManager::end_background_drain() {
+    if (!m_drain.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lock(m_drain_mutex);
+        m_drain_stop = true;
+    }
+    m_drain_cv.notify_one();
+    m_drain.join();
+    record_tick();
+}
+
+void CaptureManager::release_recording_before(size_t pos) {
+    for (auto & s : m_sources) s.recording.release_before(pos);
+}
+
+void CaptureManager::end_recording() {
+    for (auto & s : m_sources) {
+        s.recording.clear();
+        s.noise_pos = s.capture->position();
+        s.noise_hp.reset();  // the idle stream resumes after a gap
+    }
+    m_buf.clear();
+    m_buf.shrink_to_fit();
+    m_filtered.clear();
+    m_filtered.shrink_to_fit();
+}
+
+size_t CaptureManager::select_best() {
+    if (m_sources.size() < 2) return m_lead;
+
+    // Each source against its own idle floor, so a loud but noisy webcam
+    // mic does not win over a quiet headset
+    size_t best     = m_lead;
+    float  best_snr = -1e9f;
+    for (size_t i = 0; i < m_sources.size(); i++) {
+        auto & s = m_sources[i];
+        if (!s.noise.ready() || !s.capture->alive()) continue;
+        s.last_snr_db = s.level.snr_db(s.noise.floor_db());
+        if (s.last_snr_db > best_snr) {
+            best_snr = s.last_snr_db;
+            best     = i;
+        }
+    }
+    m_lead = best;
+    attach_meter();
+    return best;
+}
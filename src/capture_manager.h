@@ -0,0 +1,138 @@
+#pragma once
+
+#include "capture.h"
+#include "level_meter.h"
+#include "recording_store.h"
+#include "vad.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct CaptureOptions {
+    std::string backend     = "auto";
+    int         capture_id  = -1;
+    int         sample_rate = 16000;
+    int         ring_ms     = 3000;   // pre-roll plus slack; recordings go to blocks
+    bool        native_rate = false;
+    bool        multi       = false;  // every capture device at once
+    float       freq_thold  = 100.0f; // high-pass cutoff for energy measurements
+    bool        collect     = false;  // keep noise frames for calibration reports
+};
+
+// One open microphone with its own idle noise floor and recording
+struct CaptureSource {
+    explicit CaptureSource(BlockPool & pool) : recording(pool) {}
+
+    std::string                   device;  // SDL device name, shared by identical models
+    std::string                   name;    // unique label: device, plus " (2)" etc. for further copies
+    std::unique_ptr<AudioCapture> capture;
+    NoiseFloorEstimator           noise;
+    HighPassFilter                noise_hp;  // state kept across idle ticks
+    HighPassFilter                level_hp;  // state kept across record ticks
+    uint64_t                      noise_pos  = 0;  // fed to the noise floor up to here
+    uint64_t                      record_pos = 0;  // moved to the recording up to here
+    uint64_t                      record_start = 0;  // ring position of the recording's first sample
+    RecordingStore                recording;
+    UtteranceLevel                level;   // of the recording, measured as it comes in
+    float                         last_snr_db = 0.0f;
+};
+
+// Owns the capture devices.
+//
+// Single mode opens one device, as selected by backend/capture_id. Multi mode
+// opens every SDL capture device, tracks each one's noise floor while idle
+// and each one's level while recording, and after each utterance picks the
+// source with the best SNR. The device list is re-enumerated while idle, so
+// headsets and docks can come and go without a restart.
+//
+// The rings only hold the pre-roll and some slack. While recording, new
+// audio is moved into per-source RecordingStores built from a shared block
+// pool, so memory follows the length of the dictation and is handed back
+// when it ends.
+//
+// The lead source drives auto-stop VAD while recording; it is the source
+// that won the previous utterance. It also feeds the level meter.
+class CaptureManager {
+public:
+    CaptureManager();
+
+    bool init(const CaptureOptions & opts);
+    void shutdown();
+
+    size_t size() const { return m_sources.size(); }
+    bool   multi() const { return m_opts.multi; }
+
+    size_t                lead_index() const { return m_lead; }
+    AudioCapture &        lead()       { return *m_sources[m_lead].capture; }
+    NoiseFloorEstimator & lead_noise() { return m_sources[m_lead].noise; }
+    const std::string &   lead_name() const { return m_sources[m_lead].name; }
+
+    // Idle work: feed new audio to each noise floor; in multi mode,
+    // periodically pick up added or removed devices.
+    void idle_tick();
+
+    // High-pass cutoff for the noise floor, changed by a config reload
+    void set_freq_thold(float hz);
+
+    // Start recording on every source from pre_roll_ms before key_time
+    void start_recording(std::chrono::steady_clock::time_point key_time, int pre_roll_ms);
+
+    // Length the lead recording had at t (the key that stopped it), at
+    // most its current size
+    size_t lead_length_at(std::chrono::steady_clock::time_point t) const;
+
+    // Move the audio captured since the last call into the recordings.
+    // Must run more often than the ring span (ring_ms minus pre-roll).
+    void record_tick();
+
+    // Run record_tick() on a helper thread until end_background_drain(),
+    // for stretches where the main loop blocks while recording (typing a
+    // long-form chunk with keystroke delays). The caller must not use the
+    // manager in between.
+    void begin_background_drain();
+    void end_background_drain();
+
+    // Release the recordings' blocks and skip audio captured while not
+    // idle (call when returning to idle)
+    void end_recording();
+
+    const RecordingStore & lead_recording() const { return m_sources[m_lead].recording; }
+
+    // Drop recorded audio before pos on every source (long-form chunks
+    // already handed to whisper)
+    void release_recording_before(size_t pos);
+
+    // Multi mode: rank the sources by the SNR of what they recorded and
+    // return the best one's index (the lead in single mode). The winner
+    // becomes the lead.
+    size_t select_best();
+
+    const CaptureSource & source(size_t i) const { return m_sources[i]; }
+
+    // Levels of the lead source, for display
+    LevelMeter & meter() { return m_meter; }
+
+private:
+    CaptureOptions             m_opts;
+    BlockPool                  m_pool;   // before m_sources, which return blocks to it
+    LevelMeter                 m_meter;  // before m_sources, whose callbacks write to it
+    std::vector<CaptureSource> m_sources;
+    size_t                     m_lead = 0;
+    std::vector<float>         m_buf;
+    std::vector<float>         m_filtered;  // m_buf high-passed for the level meters
+    std::chrono::steady_clock::time_point m_last_scan;
+
+    std::thread             m_drain;
+    std::mutex              m_drain_mutex;
+    std::condition_variable m_drain_cv;
+    bool                    m_drain_stop = false;
+
+    bool open_source(const std::string & device, int capture_id);
+    void scan_devices();
+    void attach_meter();
+};
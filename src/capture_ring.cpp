@@ -0,0 +1,79 @@
+// Capture ring buffer, separated from capture.cpp so tests can link
+// without PipeWire/SDL.
+
+#include "capture.h"
+
+#include <algorithm>
+#include <cstring>
+
+CaptureRing::CaptureRing(size_t min_capacity) {
+    reset(min_capacity);
+}
+
+void CaptureRing::reset(size_t min_capacity) {
+    size_t cap = 1;
+    while (cap < min_capacity) cap <<= 1;
+    m_buf.assign(cap, 0.0f);
+    m_mask = cap - 1;
+    m_write.store(0, std::memory_order_relaxed);
+    m_reserve.store(0, std::memory_order_relaxed);
+}
+
+void CaptureRing::write(const float * data, size_t n) {
+    const size_t cap = m_buf.size();
+    uint64_t w = m_write.load(std::memory_order_relaxed);
+
+    // Only the newest `cap` samples can be retained
+    if (n > cap) {
+        data += n - cap;
+        w    += n - cap;
+        n     = cap;
+    }
+
+    // Announce the overwrite before touching the samples
+    m_reserve.store(w + n, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    size_t idx   = (size_t) (w & m_mask);
+    size_t first = std::min(n, cap - idx);
+    memcpy(m_buf.data() + idx, data, first * sizeof(float));
+    if (first < n) {
+        memcpy(m_buf.data(), data + first, (n - first) * sizeof(float));
+    }
+
+    m_write.store(w + n, std::memory_order_release);
+}
+
+uint64_t CaptureRing::oldest() const {
+    uint64_t w = position();
+    return w > m_buf.size() ? w - m_buf.size() : 0;
+}
+
+uint64_t CaptureRing::read(uint64_t from, uint64_t to, std::vector<float> & out) const {
+    out.clear();
+    const size_t cap = m_buf.size();
+    uint64_t w = position();
+    to   = std::min(to, w);
+    from = std::max(from, oldest());
+    if (from >= to) return to;
+
+    size_t n = (size_t) (to - from);
+    out.resize(n);
+    size_t idx   = (size_t) (from & m_mask);
+    size_t first = std::min(n, cap - idx);
+    memcpy(out.data(), m_buf.data() + idx, first * sizeof(float));
+    if (first < n) {
+        memcpy(out.data() + first, m_buf.data(), (n - first) * sizeof(float));
+    }
+
+    // Anything older than reserve - cap may have been overwritten while copying
+    std::atomic_thread_fence(std::memory_order_acquire);
+    uint64_t r     = m_reserve.load(std::memory_order_relaxed);
+    uint64_t valid = r > cap ? r - cap : 0;
+    if (from < valid) {
+        size_t drop = (size_t) std::min<uint64_t>(valid - from, n);
+        out.erase(out.begin(), out.begin() + drop);
+        from += drop;
+    }
+    return from;
+}
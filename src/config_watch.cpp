@@ -0,0 +1,48 @@
+#include "config_watch.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+#include <sys/inotify.h>
+#include <unistd.h>
+
+ConfigWatch::~ConfigWatch() {
+    if (m_fd >= 0) close(m_fd);
+}
+
+bool ConfigWatch::init(const std::string & path) {
+    const auto slash = path.rfind('/');
+    const std::string dir = slash == std::string::npos ? "." : path.substr(0, slash);
+    m_name = slash == std::string::npos ? path : path.substr(slash + 1);
+
+    m_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (m_fd < 0) {
+        fprintf(stderr, "config: inotify_init1 failed: %s\n", strerror(errno));
+        return false;
+    }
+    if (inotify_add_watch(m_fd, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+        fprintf(stderr, "config: cannot watch %s: %s\n", dir.c_str(), strerror(errno));
+        close(m_fd);
+        m_fd = -1;
+        return false;
+    }
+    return true;
+}
+
+bool ConfigWatch::changed() {
+    if (m_fd < 0) return false;
+
+    bool hit = false;
+    alignas(inotify_event) char buf[4096];
+    while (true) {
+        ssize_t n = read(m_fd, buf, sizeof(buf));
+        if (n <= 0) break;  // EAGAIN: drained
+        for (ssize_t off = 0; off < n; ) {
+            const auto * ev = reinterpret_cast<const inotify_event *>(buf + off);
+            if (ev->len > 0 && m_name == ev->name) hit = true;
+            off += sizeof(inotify_event) + ev->len;
+        }
+    }
+    return hit;
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <string>
+
+// Notices when the config file is saved.
+//
+// Watches the containing directory rather than the file: editors save by
+// writing a temporary file and renaming it over the original, which would
+// leave a watch on the old inode behind. Only completed writes and renames
+// count, so a half-written file is never reported.
+class ConfigWatch {
+public:
+    ConfigWatch() = default;
+    ~ConfigWatch();
+
+    ConfigWatch(const ConfigWatch &) = delete;
+    ConfigWatch & operator=(const ConfigWatch &) = delete;
+
+    // The directory must exist; the file need not yet
+    bool init(const std::string & path);
+
+    // True once for any number of saves since the last call. Never blocks.
+    bool changed();
+
+private:
+    int         m_fd = -1;
+    std::string m_name;  // file name inside the watched directory
+};
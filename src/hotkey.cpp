@@ -1,12 +1,15 @@
 #include "hotkey.h"
+#include "spsc_queue.h"
 
 #include <linux/input.h>
 
 #include <cstdio>
+#include <iterator>
 #include <cstring>
 #include <sstream>
 #include <algorithm>
 #include <cctype>
+#include <ctime>
 #include <unistd.h>
 #include <fcntl.h>
 #include <dirent.h>
@@ -22,10 +25,49 @@ enum {
     MOD_SUPER = 1 << 3,
 };
 
-struct HotkeyListener::Impl {
-    std::vector<int> fds;       // open file descriptors for keyboard devices
-    int              key_code  = 0;   // evdev key code for the main key
-    unsigned int     modmask   = 0;   // required modifiers (MOD_CTRL etc.)
+// How a binding's key has to be pressed
+enum class Gesture : uint8_t {
+    PRESS,   // down with the key, up with its release
+    TAP,     // modifier keys: pressed and released alone, quickly
+    DOUBLE,  // "double+": second press within TAP_TIME of the first tap; up with its release
+    HOLD,    // "hold+": down once held alone for the threshold; up with the release
+};
+
+// Matches key events against the binding table on the listener thread.
+// A keycode-indexed bitmap rejects keys no binding uses, so the table size
+// does not cost anything per keystroke. Gestures are a small timing state
+// machine per binding, driven by the evdev timestamps and tick(); nothing
+// allocates per event.
+struct KeyMatcher {
+    using time_point = std::chrono::steady_clock::time_point;
+
+    static constexpr auto TAP_TIME  = std::chrono::milliseconds(300);  // tap length, double-tap gap
+    static constexpr auto HOLD_TIME = std::chrono::milliseconds(500);  // "hold+" default
+
+    // Gesture progress of one binding
+    enum class Phase : uint8_t {
+        IDLE,
+        DOWN,    // key held, gesture not complete yet
+        TAPPED,  // DOUBLE: first tap done, waiting for the second press
+        ACTIVE,  // binding is down (reported)
+    };
+
+    struct Binding {
+        int          key_code = 0;  // evdev key code for the main key
+        unsigned int modmask  = 0;  // required modifiers (MOD_CTRL etc.)
+        Gesture      gesture  = Gesture::PRESS;
+        std::chrono::milliseconds hold = HOLD_TIME;
+
+        // State
+        Phase        phase = Phase::IDLE;
+        time_point   since;  // press (DOWN) or release (TAPPED) time
+    };
+
+    std::vector<Binding> table;
+    uint64_t key_bits[(KEY_CNT + 63) / 64] = {};  // bit per key code used by a binding
+    uint32_t active       = 0;                     // bit per binding that is down
+    uint32_t gesture_bits = 0;                     // bit per binding with a gesture
+    uint32_t hold_bits    = 0;                     // bit per HOLD binding
 
     // Current modifier state (updated from events)
     bool ctrl_l  = false;
@@ -37,23 +79,78 @@ struct HotkeyListener::Impl {
     bool super_l = false;
     bool super_r = false;
 
-    bool mods_match() const {
+    void set_table(const std::vector<Binding> & bindings) {
+        table = bindings;
+        std::fill(std::begin(key_bits), std::end(key_bits), 0);
+        gesture_bits = hold_bits = 0;
+        for (size_t i = 0; i < table.size(); i++) {
+            const auto & b = table[i];
+            key_bits[b.key_code / 64] |= uint64_t(1) << (b.key_code % 64);
+            if (b.gesture != Gesture::PRESS) gesture_bits |= uint32_t(1) << i;
+            if (b.gesture == Gesture::HOLD)  hold_bits    |= uint32_t(1) << i;
+            table[i].phase = Phase::IDLE;
+        }
+        active = 0;
+    }
+
+    // Forget held keys (devices were reopened); held bindings end
+    template <typename Emit>
+    void release_all(time_point t, Emit && emit) {
+        ctrl_l = ctrl_r = shift_l = shift_r = false;
+        alt_l = alt_r = super_l = super_r = false;
+        for (size_t i = 0; i < table.size(); i++) {
+            if (active & (uint32_t(1) << i)) emit((int) i, false, t);
+            table[i].phase = Phase::IDLE;
+        }
+        active = 0;
+    }
+
+    // Catch up with a device's key state (EVIOCGKEY bitmap) after the
+    // kernel dropped its events: modifiers are read back and held bindings
+    // whose keys are up end. Presses lost in the overflow stay lost, and
+    // gestures in progress start over.
+    template <typename Emit>
+    void resync(const unsigned long * keys, time_point t, Emit && emit) {
+        constexpr int BITS = 8 * sizeof(unsigned long);
+        auto is_down = [&](int code) { return ((keys[code / BITS] >> (code % BITS)) & 1) != 0; };
+
+        static const int MODIFIERS[] = {
+            KEY_LEFTCTRL, KEY_RIGHTCTRL, KEY_LEFTSHIFT, KEY_RIGHTSHIFT,
+            KEY_LEFTALT,  KEY_RIGHTALT,  KEY_LEFTMETA,  KEY_RIGHTMETA,
+        };
+        for (int code : MODIFIERS) update_modifier(code, is_down(code));
+
+        for (size_t i = 0; i < table.size(); i++) {
+            const uint32_t bit = uint32_t(1) << i;
+            if ((active & bit) && (!is_down(table[i].key_code) || !mods_match(table[i].modmask))) {
+                end(i, t, emit);
+            } else if (!(active & bit)) {
+                table[i].phase = Phase::IDLE;
+            }
+        }
+    }
+
+    bool bound(int code) const {
+        return code >= 0 && code < KEY_CNT && ((key_bits[code / 64] >> (code % 64)) & 1);
+    }
+
+    bool mods_match(unsigned int mask) const {
         bool ctrl  = ctrl_l  || ctrl_r;
         bool shift = shift_l || shift_r;
         bool alt   = alt_l   || alt_r;
         bool super = super_l || super_r;
 
         // Required modifiers must be held
-        if ((modmask & MOD_CTRL)  && !ctrl)  return false;
-        if ((modmask & MOD_SHIFT) && !shift) return false;
-        if ((modmask & MOD_ALT)   && !alt)   return false;
-        if ((modmask & MOD_SUPER) && !super) return false;
+        if ((mask & MOD_CTRL)  && !ctrl)  return false;
+        if ((mask & MOD_SHIFT) && !shift) return false;
+        if ((mask & MOD_ALT)   && !alt)   return false;
+        if ((mask & MOD_SUPER) && !super) return false;
 
         // Extra modifiers must NOT be held
-        if (!(modmask & MOD_CTRL)  && ctrl)  return false;
-        if (!(modmask & MOD_SHIFT) && shift) return false;
-        if (!(modmask & MOD_ALT)   && alt)   return false;
-        if (!(modmask & MOD_SUPER) && super) return false;
+        if (!(mask & MOD_CTRL)  && ctrl)  return false;
+        if (!(mask & MOD_SHIFT) && shift) return false;
+        if (!(mask & MOD_ALT)   && alt)   return false;
+        if (!(mask & MOD_SUPER) && super) return false;
 
         return true;
     }
@@ -71,21 +168,166 @@ struct HotkeyListener::Impl {
         }
     }
 
-    bool is_modifier(int code) const {
+    static bool is_modifier(int code) {
         return code == KEY_LEFTCTRL  || code == KEY_RIGHTCTRL  ||
                code == KEY_LEFTSHIFT || code == KEY_RIGHTSHIFT ||
                code == KEY_LEFTALT   || code == KEY_RIGHTALT   ||
                code == KEY_LEFTMETA  || code == KEY_RIGHTMETA;
     }
 
+    // Modifier flag a modifier key sets (0 for other keys)
+    static unsigned int modifier_flag(int code) {
+        switch (code) {
+            case KEY_LEFTCTRL:  case KEY_RIGHTCTRL:  return MOD_CTRL;
+            case KEY_LEFTSHIFT: case KEY_RIGHTSHIFT: return MOD_SHIFT;
+            case KEY_LEFTALT:   case KEY_RIGHTALT:   return MOD_ALT;
+            case KEY_LEFTMETA:  case KEY_RIGHTMETA:  return MOD_SUPER;
+        }
+        return 0;
+    }
+
+    // Feed one EV_KEY event (value 1 = press, 0 = release, 2 = repeat)
+    // with its timestamp. emit(binding, down, time) is called for every
+    // binding that changes; at most two calls per binding.
+    template <typename Emit>
+    void feed(int code, int value, time_point t, Emit && emit) {
+        const bool pressed  = (value == 1);
+        const bool released = (value == 0);
+        if (!pressed && !released) return;  // skip repeat events
+
+        if (is_modifier(code)) update_modifier(code, pressed);
+
+        // Any other key interrupts taps and holds in progress
+        if (pressed) {
+            for (uint32_t m = gesture_bits; m; m &= m - 1) {
+                Binding & b = table[__builtin_ctz(m)];
+                if (b.key_code != code && b.phase != Phase::ACTIVE) b.phase = Phase::IDLE;
+            }
+        }
+
+        if (bound(code)) {
+            for (size_t i = 0; i < table.size(); i++) {
+                if (table[i].key_code != code) continue;
+                if (table[i].gesture != Gesture::PRESS) {
+                    step_gesture(i, pressed, t, emit);
+                    continue;
+                }
+                const uint32_t bit = uint32_t(1) << i;
+                if (pressed && !(active & bit) && mods_match(table[i].modmask)) {
+                    active |= bit;
+                    emit((int) i, true, t);
+                } else if (released && (active & bit)) {
+                    active &= ~bit;
+                    emit((int) i, false, t);
+                }
+            }
+        }
+
+        // A modifier released while a binding is held ends it
+        if (released && active && is_modifier(code)) {
+            for (size_t i = 0; i < table.size(); i++) {
+                if ((active & (uint32_t(1) << i)) && !mods_match(table[i].modmask)) {
+                    end(i, t, emit);
+                }
+            }
+        }
+    }
+
+    // Timers: HOLD bindings held long enough go down. Called on every
+    // listener wakeup, since a hold completes without a key event.
+    template <typename Emit>
+    void tick(time_point now, Emit && emit) {
+        for (uint32_t m = hold_bits; m; m &= m - 1) {
+            const int i = __builtin_ctz(m);
+            Binding & b = table[i];
+            if (b.phase == Phase::DOWN && now - b.since >= b.hold) {
+                b.phase = Phase::ACTIVE;
+                active |= uint32_t(1) << i;
+                emit(i, true, b.since);  // the recording starts at the press
+            }
+        }
+    }
+
+private:
+    template <typename Emit>
+    void end(size_t i, time_point t, Emit & emit) {
+        active &= ~(uint32_t(1) << i);
+        table[i].phase = Phase::IDLE;
+        emit((int) i, false, t);
+    }
+
+    template <typename Emit>
+    void step_gesture(size_t i, bool pressed, time_point t, Emit & emit) {
+        Binding & b = table[i];
+        if (pressed) {
+            if (!mods_match(b.modmask)) {
+                b.phase = Phase::IDLE;
+            } else if (b.gesture == Gesture::DOUBLE && b.phase == Phase::TAPPED && t - b.since <= TAP_TIME) {
+                b.phase = Phase::ACTIVE;
+                active |= uint32_t(1) << i;
+                emit((int) i, true, t);
+            } else {
+                b.phase = Phase::DOWN;
+                b.since = t;
+            }
+            return;
+        }
+
+        switch (b.phase) {
+            case Phase::ACTIVE:
+                end(i, t, emit);
+                break;
+            case Phase::DOWN:
+                if (b.gesture == Gesture::TAP && t - b.since <= TAP_TIME) {
+                    emit((int) i, true, b.since);
+                    emit((int) i, false, t);
+                    b.phase = Phase::IDLE;
+                } else if (b.gesture == Gesture::DOUBLE && t - b.since <= TAP_TIME) {
+                    b.phase = Phase::TAPPED;
+                    b.since = t;
+                } else {
+                    b.phase = Phase::IDLE;  // too long for a tap, too short for a hold
+                }
+                break;
+            default:
+                break;
+        }
+    }
+};
+
+static_assert(HotkeyListener::QUEUE_SIZE >= 2 * HotkeyListener::MAX_BINDINGS,
+              "one key event must always fit in the hotkey queue");
+
+struct HotkeyListener::Impl {
+    struct Device {
+        int  fd        = -1;
+        bool monotonic = false;  // event times are on steady_clock (EVIOCSCLOCKID)
+        bool dropped   = false;  // kernel overflow: skipping to the next SYN_REPORT
+    };
+    std::vector<Device> devices;  // open keyboard devices
+    KeyMatcher          matcher;  // listener thread only
+
+    // Listener thread -> poll()
+    SpscQueue<HotkeyEvent, QUEUE_SIZE> events;
+
+    // Room for everything one key event can emit (down and up per binding)
+    bool has_room() const {
+        return QUEUE_SIZE - events.size() >= 2 * matcher.table.size();
+    }
+
     void close_all_fds() {
-        for (int fd : fds) {
-            close(fd);
+        for (const auto & d : devices) {
+            close(d.fd);
         }
-        fds.clear();
+        devices.clear();
     }
 };
 
+static std::chrono::steady_clock::time_point event_time(const input_event & ev) {
+    return std::chrono::steady_clock::time_point(
+        std::chrono::microseconds((int64_t) ev.time.tv_sec * 1000000 + ev.time.tv_usec));
+}
+
 // Map common key names to evdev key codes
 static int name_to_evdev(const std::string & name) {
     std::string lower = name;
@@ -140,6 +382,16 @@ static int name_to_evdev(const std::string & name) {
     if (lower == "pause")       return KEY_PAUSE;
     if (lower == "plus" || lower == "kpplus") return KEY_KPPLUS;
 
+    // Modifier keys, by side (modifier-only bindings)
+    if (lower == "leftctrl"   || lower == "ctrl_l"  || lower == "lctrl")  return KEY_LEFTCTRL;
+    if (lower == "rightctrl"  || lower == "ctrl_r"  || lower == "rctrl")  return KEY_RIGHTCTRL;
+    if (lower == "leftshift"  || lower == "shift_l" || lower == "lshift") return KEY_LEFTSHIFT;
+    if (lower == "rightshift" || lower == "shift_r" || lower == "rshift") return KEY_RIGHTSHIFT;
+    if (lower == "leftalt"    || lower == "alt_l"   || lower == "lalt")   return KEY_LEFTALT;
+    if (lower == "rightalt"   || lower == "alt_r"   || lower == "ralt" || lower == "altgr") return KEY_RIGHTALT;
+    if (lower == "leftmeta"   || lower == "super_l" || lower == "lsuper") return KEY_LEFTMETA;
+    if (lower == "rightmeta"  || lower == "super_r" || lower == "rsuper") return KEY_RIGHTMETA;
+
     // F-keys: KEY_F1..KEY_F10 are contiguous (59-68), but KEY_F11=87, KEY_F12=88 are NOT
     static_assert(KEY_F1 + 9 == KEY_F10, "F1-F10 evdev keycode layout assumption violated");
     if (lower.size() >= 2 && lower[0] == 'f') {
@@ -158,6 +410,105 @@ static int name_to_evdev(const std::string & name) {
     return -1;
 }
 
+// Parse "mod+mod+key" into an evdev key code and modifier mask.
+// Returns false (with a message) on unknown modifiers or keys.
+static bool parse_hotkey(const std::string & hotkey_str, int & key_code, unsigned int & modmask) {
+    // Split on '+' to get parts
+    std::vector<std::string> parts;
+    std::istringstream ss(hotkey_str);
+    std::string part;
+    while (std::getline(ss, part, '+')) {
+        while (!part.empty() && std::isspace((unsigned char)part.front())) part.erase(part.begin());
+        while (!part.empty() && std::isspace((unsigned char)part.back()))  part.pop_back();
+        if (!part.empty()) {
+            parts.push_back(part);
+        }
+    }
+
+    if (parts.empty()) {
+        fprintf(stderr, "hotkey: empty hotkey string\n");
+        return false;
+    }
+
+    // Last part is the key, rest are modifiers
+    std::string key_name = parts.back();
+    modmask = 0;
+
+    for (size_t i = 0; i + 1 < parts.size(); i++) {
+        std::string mod_lower = parts[i];
+        std::transform(mod_lower.begin(), mod_lower.end(), mod_lower.begin(),
+                       [](unsigned char c){ return std::tolower(c); });
+
+        if (mod_lower == "ctrl" || mod_lower == "control") {
+            modmask |= MOD_CTRL;
+        } else if (mod_lower == "shift") {
+            modmask |= MOD_SHIFT;
+        } else if (mod_lower == "alt") {
+            modmask |= MOD_ALT;
+        } else if (mod_lower == "super" || mod_lower == "super_l" || mod_lower == "super_r" || mod_lower == "mod4" || mod_lower == "meta") {
+            modmask |= MOD_SUPER;
+        } else {
+            fprintf(stderr, "hotkey: unknown modifier '%s'\n", parts[i].c_str());
+            return false;
+        }
+    }
+
+    key_code = name_to_evdev(key_name);
+    if (key_code < 0) {
+        fprintf(stderr, "hotkey: unknown key '%s'\n", key_name.c_str());
+        return false;
+    }
+    return true;
+}
+
+// Parse a binding: an optional gesture ("double+", "hold+", "holdMS+")
+// followed by "mod+mod+key". A modifier key on its own is a tap.
+static bool parse_binding(const std::string & str, KeyMatcher::Binding & out) {
+    out = KeyMatcher::Binding();
+
+    std::string rest = str;
+    const size_t plus = str.find('+');
+    if (plus != std::string::npos) {
+        std::string first = str.substr(0, plus);
+        first.erase(std::remove_if(first.begin(), first.end(), [](unsigned char c){ return std::isspace(c); }),
+                    first.end());
+        std::transform(first.begin(), first.end(), first.begin(), [](unsigned char c){ return std::tolower(c); });
+
+        if (first == "double") {
+            out.gesture = Gesture::DOUBLE;
+            rest = str.substr(plus + 1);
+        } else if (first.compare(0, 4, "hold") == 0) {
+            int ms = 0;
+            for (size_t i = 4; i < first.size(); i++) {
+                if (!isdigit((unsigned char) first[i]) || ms > 60000) {
+                    fprintf(stderr, "hotkey: bad hold time '%s' (e.g. hold or hold800)\n", first.c_str());
+                    return false;
+                }
+                ms = ms * 10 + (first[i] - '0');
+            }
+            out.gesture = Gesture::HOLD;
+            if (first.size() > 4) out.hold = std::chrono::milliseconds(ms);
+            rest = str.substr(plus + 1);
+        }
+    }
+
+    if (!parse_hotkey(rest, out.key_code, out.modmask)) return false;
+
+    // A modifier key sets its own flag while it is down
+    if (KeyMatcher::is_modifier(out.key_code)) {
+        out.modmask |= KeyMatcher::modifier_flag(out.key_code);
+        if (out.gesture == Gesture::PRESS) out.gesture = Gesture::TAP;
+    }
+    return true;
+}
+
+// Two bindings on the same keys can only coexist if both are gestures
+// that do not fire on the same presses
+static bool bindings_conflict(const KeyMatcher::Binding & a, const KeyMatcher::Binding & b) {
+    if (a.key_code != b.key_code || a.modmask != b.modmask) return false;
+    return a.gesture == b.gesture || a.gesture == Gesture::PRESS || b.gesture == Gesture::PRESS;
+}
+
 HotkeyListener::HotkeyListener()
     : m_impl(std::make_unique<Impl>()) {}
 
@@ -211,70 +562,46 @@ bool HotkeyListener::open_keyboards() {
             continue;
         }
 
+        // Report event times on CLOCK_MONOTONIC (same clock as steady_clock)
+        // so key times can be compared with audio capture times. Without
+        // it events are stamped when they are read.
+        int clk = CLOCK_MONOTONIC;
+        const bool monotonic = ioctl(fd, EVIOCSCLOCKID, &clk) == 0;
+
         // This looks like a keyboard
         char name[256] = "Unknown";
         ioctl(fd, EVIOCGNAME(sizeof(name)), name);
 
         fprintf(stderr, "hotkey: opened %s (%s)\n", path.c_str(), name);
-        m_impl->fds.push_back(fd);
+        m_impl->devices.push_back({ fd, monotonic, false });
     }
 
     closedir(dir);
-    return !m_impl->fds.empty();
+    return !m_impl->devices.empty();
 }
 
-bool HotkeyListener::init(const std::string & hotkey_str) {
-    // Split on '+' to get parts
-    std::vector<std::string> parts;
-    std::istringstream ss(hotkey_str);
-    std::string part;
-    while (std::getline(ss, part, '+')) {
-        while (!part.empty() && std::isspace((unsigned char)part.front())) part.erase(part.begin());
-        while (!part.empty() && std::isspace((unsigned char)part.back()))  part.pop_back();
-        if (!part.empty()) {
-            parts.push_back(part);
-        }
-    }
-
-    if (parts.empty()) {
-        fprintf(stderr, "hotkey: empty hotkey string\n");
+bool HotkeyListener::bind(const std::vector<HotkeyBinding> & bindings) {
+    if (bindings.empty() || bindings.size() > MAX_BINDINGS) {
+        fprintf(stderr, "hotkey: need 1 to %zu bindings, got %zu\n", MAX_BINDINGS, bindings.size());
         return false;
     }
 
-    // Last part is the key, rest are modifiers
-    std::string key_name = parts.back();
-    unsigned int modmask = 0;
-
-    for (size_t i = 0; i + 1 < parts.size(); i++) {
-        std::string mod_lower = parts[i];
-        std::transform(mod_lower.begin(), mod_lower.end(), mod_lower.begin(),
-                       [](unsigned char c){ return std::tolower(c); });
-
-        if (mod_lower == "ctrl" || mod_lower == "control") {
-            modmask |= MOD_CTRL;
-        } else if (mod_lower == "shift") {
-            modmask |= MOD_SHIFT;
-        } else if (mod_lower == "alt") {
-            modmask |= MOD_ALT;
-        } else if (mod_lower == "super" || mod_lower == "super_l" || mod_lower == "super_r" || mod_lower == "mod4" || mod_lower == "meta") {
-            modmask |= MOD_SUPER;
-        } else {
-            fprintf(stderr, "hotkey: unknown modifier '%s'\n", parts[i].c_str());
-            return false;
+    std::vector<KeyMatcher::Binding> table;
+    for (const auto & b : bindings) {
+        KeyMatcher::Binding kb;
+        if (!parse_binding(b.keys, kb)) return false;
+        for (size_t i = 0; i < table.size(); i++) {
+            if (bindings_conflict(table[i], kb)) {
+                fprintf(stderr, "hotkey: '%s' conflicts with '%s'\n",
+                        b.keys.c_str(), bindings[i].keys.c_str());
+                return false;
+            }
         }
+        table.push_back(kb);
     }
 
-    int key_code = name_to_evdev(key_name);
-    if (key_code < 0) {
-        fprintf(stderr, "hotkey: unknown key '%s'\n", key_name.c_str());
-        return false;
-    }
-
-    m_impl->key_code = key_code;
-    m_impl->modmask  = modmask;
-
     // Open keyboard devices
-    if (!open_keyboards()) {
+    if (m_impl->devices.empty() && !open_keyboards()) {
         fprintf(stderr, "hotkey: no keyboard devices found!\n");
         fprintf(stderr, "hotkey: make sure you are in the 'input' group:\n");
         fprintf(stderr, "hotkey:   sudo usermod -aG input $USER\n");
@@ -282,17 +609,30 @@ bool HotkeyListener::init(const std::string & hotkey_str) {
         return false;
     }
 
-    fprintf(stderr, "hotkey: registered '%s' (evdev keycode=%d, modmask=0x%x)\n",
-            hotkey_str.c_str(), key_code, modmask);
+    const bool was_running = m_running.exchange(false);
+    if (m_thread.joinable()) m_thread.join();
+
+    m_impl->matcher.set_table(table);
+    m_bindings = bindings;
+    HotkeyEvent stale;
+    while (m_impl->events.pop(stale)) {}
+
+    for (size_t i = 0; i < table.size(); i++) {
+        fprintf(stderr, "hotkey: registered '%s' (evdev keycode=%d, modmask=0x%x)\n",
+                bindings[i].keys.c_str(), table[i].key_code, table[i].modmask);
+    }
 
+    if (was_running) {
+        m_running = true;
+        m_thread  = std::thread(&HotkeyListener::listen_thread, this);
+    }
     return true;
 }
 
-bool HotkeyListener::start(HotkeyCallback callback) {
+bool HotkeyListener::start() {
     if (m_running) return false;
-    if (m_impl->fds.empty()) return false;
+    if (m_impl->devices.empty() || m_bindings.empty()) return false;
 
-    m_callback = callback;
     m_running = true;
 
     m_thread = std::thread(&HotkeyListener::listen_thread, this);
@@ -301,7 +641,7 @@ bool HotkeyListener::start(HotkeyCallback callback) {
 }
 
 void HotkeyListener::stop() {
-    if (!m_running && !m_thread.joinable() && m_impl->fds.empty()) return;
+    if (!m_running && !m_thread.joinable() && m_impl->devices.empty()) return;
 
     m_running = false;
 
@@ -312,32 +652,45 @@ void HotkeyListener::stop() {
     m_impl->close_all_fds();
 }
 
-bool HotkeyListener::poll_pressed() {
-    return m_event_press.exchange(false);
+bool HotkeyListener::poll(HotkeyEvent & ev) {
+    return m_impl->events.pop(ev);
 }
 
-bool HotkeyListener::poll_released() {
-    return m_event_release.exchange(false);
+HotkeyEvent take_recording_start(const std::vector<HotkeyBinding> & bindings,
+                                 const std::function<bool(HotkeyEvent &)> & poll,
+                                 const std::function<void(const HotkeyEvent &)> & on_press) {
+    HotkeyEvent ev;
+    while (poll(ev)) {
+        if (!ev.down) continue;
+        const HotkeyAction action = bindings[ev.binding].action;
+        if (action != HotkeyAction::RETYPE && action != HotkeyAction::CANCEL) return ev;
+        on_press(ev);
+    }
+    return HotkeyEvent();
 }
 
 void HotkeyListener::listen_thread() {
-    bool hotkey_active = false;
     bool needs_rescan = false;
+    bool queue_full   = false;
+
+    auto push_event = [this](int binding, bool down, std::chrono::steady_clock::time_point t) {
+        m_impl->events.push(HotkeyEvent{ binding, down, t });
+    };
 
     while (m_running) {
         // Rescan devices if a read error was detected (e.g. Bluetooth disconnect)
         if (needs_rescan) {
+            // Held bindings end, since their releases may never come
+            if (!m_impl->has_room()) {
+                usleep(20000);
+                continue;
+            }
             needs_rescan = false;
-            // Reset modifier state since we lost track
-            m_impl->ctrl_l = m_impl->ctrl_r = false;
-            m_impl->shift_l = m_impl->shift_r = false;
-            m_impl->alt_l = m_impl->alt_r = false;
-            m_impl->super_l = m_impl->super_r = false;
-            hotkey_active = false;
+            m_impl->matcher.release_all(std::chrono::steady_clock::now(), push_event);
 
             fprintf(stderr, "hotkey: device change detected, rescanning...\n");
             if (open_keyboards()) {
-                fprintf(stderr, "hotkey: rescan complete, %zu device(s)\n", m_impl->fds.size());
+                fprintf(stderr, "hotkey: rescan complete, %zu device(s)\n", m_impl->devices.size());
             } else {
                 fprintf(stderr, "hotkey: rescan found no devices, will retry...\n");
                 // Wait longer before next rescan attempt
@@ -353,11 +706,21 @@ void HotkeyListener::listen_thread() {
         // SDL2's PipeWire audio thread which also uses fd polling
         usleep(20000); // 20ms = 50Hz polling rate
 
-        for (size_t i = 0; i < m_impl->fds.size(); i++) {
+        for (size_t i = 0; i < m_impl->devices.size(); i++) {
+            auto & dev = m_impl->devices[i];
             struct input_event ev;
             // fds are O_NONBLOCK, so read returns immediately if no data
             while (true) {
-                ssize_t n = read(m_impl->fds[i], &ev, sizeof(ev));
+                // A full queue leaves the events in the kernel's buffer until
+                // the main loop has caught up, so none are lost
+                if (!m_impl->has_room()) {
+                    if (!queue_full) fprintf(stderr, "hotkey: event queue full, holding key events\n");
+                    queue_full = true;
+                    break;
+                }
+                queue_full = false;
+
+                ssize_t n = read(dev.fd, &ev, sizeof(ev));
                 if (n == (ssize_t)sizeof(ev)) {
                     // Successfully read an event
                 } else {
@@ -369,52 +732,38 @@ void HotkeyListener::listen_thread() {
                     }
                     if (n < 0 && (errno == EIO || errno == ENODEV)) {
                         // Device disconnected
-                        fprintf(stderr, "hotkey: device disconnected (fd %d)\n", m_impl->fds[i]);
+                        fprintf(stderr, "hotkey: device disconnected (fd %d)\n", dev.fd);
                         needs_rescan = true;
                     }
                     break;
                 }
 
-                if (ev.type != EV_KEY) continue;
-
-                bool pressed = (ev.value == 1); // 1 = press, 0 = release, 2 = repeat
-                bool released = (ev.value == 0);
-
-                if (!pressed && !released) continue; // skip repeat events
+                const auto time = dev.monotonic ? event_time(ev) : std::chrono::steady_clock::now();
 
-                // Update modifier state
-                if (m_impl->is_modifier(ev.code)) {
-                    m_impl->update_modifier(ev.code, pressed);
+                // The kernel's buffer overflowed: skip to the next report,
+                // then read the device's key state back
+                if (ev.type == EV_SYN && ev.code == SYN_DROPPED) {
+                    dev.dropped = true;
+                    continue;
                 }
-
-                // Check the main key
-                if (ev.code == m_impl->key_code) {
-                    if (pressed && m_impl->mods_match() && !hotkey_active) {
-                        hotkey_active = true;
-                        m_event_press = true;
-                        if (m_callback) {
-                            m_callback(true);
-                        }
-                    } else if (released && hotkey_active) {
-                        hotkey_active = false;
-                        m_event_release = true;
-                        if (m_callback) {
-                            m_callback(false);
+                if (dev.dropped) {
+                    if (ev.type == EV_SYN && ev.code == SYN_REPORT) {
+                        dev.dropped = false;
+                        unsigned long keys[(KEY_CNT + 8 * sizeof(unsigned long) - 1) / (8 * sizeof(unsigned long))] = {};
+                        if (ioctl(dev.fd, EVIOCGKEY(sizeof(keys)), keys) >= 0) {
+                            m_impl->matcher.resync(keys, time, push_event);
                         }
                     }
+                    continue;
                 }
 
-                // If a modifier is released while hotkey is active, deactivate
-                if (released && m_impl->is_modifier(ev.code) && hotkey_active) {
-                    if (!m_impl->mods_match()) {
-                        hotkey_active = false;
-                        m_event_release = true;
-                        if (m_callback) {
-                            m_callback(false);
-                        }
-                    }
-                }
+                if (ev.type != EV_KEY) continue;
+
+                m_impl->matcher.feed(ev.code, ev.value, time, push_event);
             }
         }
+
+        // Long presses complete between key events
+        if (m_impl->has_room()) m_impl->matcher.tick(std::chrono::steady_clock::now(), push_event);
     }
 }
@@ -1,17 +1,48 @@
 #pragma once
 
 #include <atomic>
+#include <chrono>
 #include <functional>
 #include <memory>
 #include <string>
 #include <thread>
 #include <vector>
 
-// Callback: key_down = true on press, false on release
-using HotkeyCallback = std::function<void(bool key_down)>;
+// What a binding does; the main loop maps each to a pipeline
+enum class HotkeyAction {
+    DICTATE,    // record and type
+    TRANSLATE,  // record, translate to English and type
+    COMMAND,    // record, type without trailing punctuation and press Enter
+    RETYPE,     // type the last transcript again
+    CANCEL,     // discard the recording / abort the transcription
+};
+
+struct HotkeyBinding {
+    std::string  keys;    // e.g. "ctrl+period", "super+v", "ctrl+shift+space"
+    HotkeyAction action = HotkeyAction::DICTATE;
+};
+
+// A binding went down or up
+struct HotkeyEvent {
+    int  binding = -1;  // index into bindings()
+    bool down    = false;
+    std::chrono::steady_clock::time_point time;  // kernel timestamp of the key event
+};
+
+// Take events from poll up to the press that starts the next recording (a
+// binding other than RETYPE and CANCEL going down) and return it; binding
+// is -1 when the queue runs dry first. Events after it, its release
+// included, stay queued for the recording it starts. Earlier releases are
+// dropped and earlier RETYPE and CANCEL presses go to on_press.
+HotkeyEvent take_recording_start(const std::vector<HotkeyBinding> & bindings,
+                                 const std::function<bool(HotkeyEvent &)> & poll,
+                                 const std::function<void(const HotkeyEvent &)> & on_press);
 
 class HotkeyListener {
 public:
+    static constexpr size_t MAX_BINDINGS = 32;
+    static constexpr size_t QUEUE_SIZE   = 64;  // events; at least 2 * MAX_BINDINGS
+
     HotkeyListener();
     ~HotkeyListener();
 
@@ -19,18 +50,25 @@ public:
     HotkeyListener(const HotkeyListener &) = delete;
     HotkeyListener & operator=(const HotkeyListener &) = delete;
 
-    // Parse hotkey string (e.g. "ctrl+period", "super+v", "ctrl+shift+space")
-    bool init(const std::string & hotkey_str);
+    // Parse the binding table and open the keyboards. On a started
+    // listener this swaps the table: the listening thread pauses, devices
+    // stay open and queued events are dropped. Nothing changes if a binding
+    // does not parse or two bindings use the same keys.
+    bool bind(const std::vector<HotkeyBinding> & bindings);
+
+    const std::vector<HotkeyBinding> & bindings() const { return m_bindings; }
 
     // Start listening thread
-    bool start(HotkeyCallback callback);
+    bool start();
 
     // Stop listening thread
     void stop();
 
-    // Poll-based interface: returns true once per event, consuming the flag
-    bool poll_pressed();
-    bool poll_released();
+    // Next binding transition, in the order they happened. Non-blocking;
+    // call from one thread only. Transitions are never dropped: while the
+    // queue is full the listener leaves new key events in the kernel's
+    // buffer.
+    bool poll(HotkeyEvent & ev);
 
 private:
     void listen_thread();
@@ -39,9 +77,7 @@ private:
     struct Impl;
     std::unique_ptr<Impl> m_impl;
 
-    std::thread      m_thread;
-    std::atomic_bool m_running{false};
-    std::atomic_bool m_event_press{false};
-    std::atomic_bool m_event_release{false};
-    HotkeyCallback   m_callback;
+    std::vector<HotkeyBinding> m_bindings;
+    std::thread          m_thread;
+    std::atomic_bool     m_running{false};
 };
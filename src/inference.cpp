@@ -0,0 +1,320 @@
+#include "inference.h"
+
+#include "whisper.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+// Encoder window cap for partial decodes (about 10 s of audio)
+static constexpr int PARTIAL_MAX_AUDIO_CTX = 512;
+
+struct InferenceWorkerImpl {
+    whisper_context * ctx = nullptr;
+    InferenceOptions  opts;
+    std::thread       worker;
+
+    mutable std::mutex          mutex;
+    std::condition_variable     cv;
+    bool                        running = false;
+    bool                        active  = false;  // a job is in whisper_full()
+    std::deque<InferenceJob>    jobs;
+    std::deque<InferenceResult> results;
+    std::deque<std::string>     segments;         // from stream jobs, not yet polled
+    std::string                 prev_text;        // prompt for continue_context jobs
+
+    // At most one partial waits; its text replaces the last one's
+    bool                        has_partial  = false;
+    PartialJob                  partial;
+    bool                        has_partial_text = false;
+    std::string                 partial_text;
+
+    // Bumped by cancel(); a job aborts when it no longer matches
+    std::atomic<unsigned> cancel_gen{0};
+    // Bumped by submit() and cancel(); a partial aborts when it no longer matches
+    std::atomic<unsigned> partial_gen{0};
+};
+
+struct AbortState {
+    InferenceWorkerImpl * impl;
+    unsigned              gen;
+    bool                  partial;
+    unsigned              pgen;
+};
+
+struct SegmentState {
+    AbortState *             abort;
+    bool                     stream;
+    std::vector<std::string> texts;
+};
+
+// Polled by whisper between graph nodes, i.e. at least once per decoder step
+static bool abort_cb(void * user_data) {
+    auto * a = static_cast<AbortState *>(user_data);
+    return a->impl->cancel_gen.load() != a->gen ||
+           (a->partial && a->impl->partial_gen.load() != a->pgen);
+}
+
+// Collect segments as they are finished, so they survive an abort. Stream
+// jobs also queue each one for poll_segment() right away.
+static void new_segment_cb(struct whisper_context * /*ctx*/, struct whisper_state * state,
+                           int n_new, void * user_data) {
+    auto * seg = static_cast<SegmentState *>(user_data);
+    const int n_segments = whisper_full_n_segments_from_state(state);
+    for (int i = n_segments - n_new; i < n_segments; ++i) {
+        seg->texts.push_back(whisper_full_get_segment_text_from_state(state, i));
+        if (seg->stream) {
+            // Checked under the lock so nothing slips in after cancel() cleared the queue
+            std::lock_guard<std::mutex> lock(seg->abort->impl->mutex);
+            if (!abort_cb(seg->abort)) seg->abort->impl->segments.push_back(seg->texts.back());
+        }
+    }
+}
+
+static whisper_full_params base_params(const InferenceOptions & opts, AbortState * abort) {
+    whisper_full_params wparams = whisper_full_default_params(WHISPER_SAMPLING_GREEDY);
+
+    wparams.print_progress   = false;
+    wparams.print_special    = false;
+    wparams.print_realtime   = false;
+    wparams.print_timestamps = false;
+    wparams.translate        = opts.translate;
+    wparams.single_segment   = false;
+    wparams.max_tokens       = 0;
+    wparams.language         = opts.language.c_str();
+    wparams.n_threads        = opts.n_threads;
+    wparams.audio_ctx        = opts.audio_ctx;
+    wparams.no_context       = true;
+    wparams.no_timestamps    = true;
+    wparams.suppress_blank   = true;
+
+    wparams.abort_callback           = abort_cb;
+    wparams.abort_callback_user_data = abort;
+    wparams.encoder_begin_callback   = [](struct whisper_context *, struct whisper_state *, void * user_data) {
+        return !abort_cb(user_data);
+    };
+    wparams.encoder_begin_callback_user_data = abort;
+    return wparams;
+}
+
+static InferenceResult run_job(InferenceWorkerImpl * impl, const InferenceJob & job,
+                               const std::string & prompt, unsigned gen) {
+    const InferenceOptions & opts = impl->opts;
+    AbortState abort = { impl, gen, false, 0 };
+    whisper_full_params wparams = base_params(opts, &abort);
+
+    if (!job.language.empty()) wparams.language = job.language.c_str();
+    if (job.translate)         wparams.translate = true;
+
+    // Long-form: the previous chunk's text keeps names and style consistent
+    if (job.continue_context && !prompt.empty()) {
+        wparams.initial_prompt = prompt.c_str();
+    } else if (!job.prompt.empty()) {
+        wparams.initial_prompt = job.prompt.c_str();
+    }
+
+    SegmentState seg = { &abort, job.stream, {} };
+    wparams.new_segment_callback           = new_segment_cb;
+    wparams.new_segment_callback_user_data = &seg;
+
+    // Silero VAD integration
+    if (!opts.vad_model_path.empty() && !job.speech_only) {
+        wparams.vad            = true;
+        wparams.vad_model_path = opts.vad_model_path.c_str();
+    }
+
+    InferenceResult r;
+    r.streamed = job.stream;
+    if (whisper_full(impl->ctx, wparams, job.pcm.data(), job.pcm.size()) != 0) {
+        if (abort_cb(&abort)) {
+            r.cancelled = true;
+        } else {
+            fprintf(stderr, "error: whisper_full() failed\n");
+            r.failed = true;
+            return r;
+        }
+    }
+    for (const auto & text : seg.texts) {
+        r.text += text;
+    }
+    return r;
+}
+
+// Preview decode: one segment, no temperature fallback, and an encoder
+// window just long enough for the audio instead of the full 30 s.
+// Returns false if aborted or failed.
+static bool run_partial(InferenceWorkerImpl * impl, const PartialJob & job, unsigned gen, unsigned pgen,
+                        std::string & text) {
+    AbortState abort = { impl, gen, true, pgen };
+    whisper_full_params wparams = base_params(impl->opts, &abort);
+
+    // 50 encoder positions per second of audio, plus some margin
+    int ctx = std::min(PARTIAL_MAX_AUDIO_CTX, (int) (job.pcm.size() / 320) + 32);
+    if (impl->opts.audio_ctx > 0) ctx = std::min(ctx, impl->opts.audio_ctx);
+    wparams.audio_ctx        = ctx;
+    wparams.single_segment   = true;
+    wparams.greedy.best_of   = 1;
+    wparams.temperature_inc  = 0.0f;
+    if (!job.language.empty()) wparams.language       = job.language.c_str();
+    if (!job.prompt.empty())   wparams.initial_prompt = job.prompt.c_str();
+    if (job.translate)         wparams.translate      = true;
+
+    if (whisper_full(impl->ctx, wparams, job.pcm.data(), job.pcm.size()) != 0) return false;
+
+    text.clear();
+    const int n = whisper_full_n_segments(impl->ctx);
+    for (int i = 0; i < n; i++) text += whisper_full_get_segment_text(impl->ctx, i);
+    return !abort_cb(&abort);
+}
+
+static void worker_thread(InferenceWorkerImpl * impl) {
+    std::unique_lock<std::mutex> lock(impl->mutex);
+    while (true) {
+        impl->cv.wait(lock, [impl]() { return !impl->jobs.empty() || impl->has_partial || !impl->running; });
+        if (!impl->running) break;
+
+        // Partials only fill the gaps between real jobs
+        if (impl->jobs.empty()) {
+            PartialJob job = std::move(impl->partial);
+            impl->has_partial = false;
+            unsigned gen  = impl->cancel_gen.load();
+            unsigned pgen = impl->partial_gen.load();
+
+            lock.unlock();
+            std::string text;
+            bool ok = run_partial(impl, job, gen, pgen, text);
+            lock.lock();
+
+            // Checked under the lock so nothing slips in after submit() or cancel()
+            if (ok && impl->partial_gen.load() == pgen && impl->cancel_gen.load() == gen) {
+                impl->partial_text     = std::move(text);
+                impl->has_partial_text = true;
+            }
+            continue;
+        }
+
+        InferenceJob job   = std::move(impl->jobs.front());
+        impl->jobs.pop_front();
+        std::string prompt = impl->prev_text;
+        unsigned    gen    = impl->cancel_gen.load();
+        impl->active = true;
+
+        lock.unlock();
+        InferenceResult r = run_job(impl, job, prompt, gen);
+        lock.lock();
+
+        impl->active = false;
+        if (job.continue_context && !r.cancelled && !r.failed) impl->prev_text = r.text;
+        impl->results.push_back(std::move(r));
+    }
+}
+
+InferenceWorker::InferenceWorker() = default;
+InferenceWorker::~InferenceWorker() { stop(); }
+
+bool InferenceWorker::start(whisper_context * ctx, const InferenceOptions & opts) {
+    stop();
+    m_impl = std::make_unique<InferenceWorkerImpl>();
+    m_impl->ctx     = ctx;
+    m_impl->opts    = opts;
+    m_impl->running = true;
+    m_impl->worker  = std::thread(worker_thread, m_impl.get());
+    return true;
+}
+
+void InferenceWorker::stop() {
+    if (!m_impl) return;
+    {
+        std::lock_guard<std::mutex> lock(m_impl->mutex);
+        m_impl->running = false;
+        m_impl->jobs.clear();
+    }
+    m_impl->cancel_gen++;
+    m_impl->cv.notify_one();
+    if (m_impl->worker.joinable()) m_impl->worker.join();
+    m_impl.reset();
+}
+
+void InferenceWorker::submit(InferenceJob job) {
+    if (!m_impl) return;
+    {
+        std::lock_guard<std::mutex> lock(m_impl->mutex);
+        m_impl->jobs.push_back(std::move(job));
+        m_impl->has_partial = false;
+        m_impl->partial_gen++;
+    }
+    m_impl->cv.notify_one();
+}
+
+void InferenceWorker::submit_partial(PartialJob job) {
+    if (!m_impl) return;
+    {
+        std::lock_guard<std::mutex> lock(m_impl->mutex);
+        m_impl->partial     = std::move(job);
+        m_impl->has_partial = true;
+    }
+    m_impl->cv.notify_one();
+}
+
+bool InferenceWorker::poll_partial(std::string & out) {
+    if (!m_impl) return false;
+    std::lock_guard<std::mutex> lock(m_impl->mutex);
+    if (!m_impl->has_partial_text) return false;
+    out = std::move(m_impl->partial_text);
+    m_impl->has_partial_text = false;
+    return true;
+}
+
+bool InferenceWorker::poll(InferenceResult & out) {
+    if (!m_impl) return false;
+    std::lock_guard<std::mutex> lock(m_impl->mutex);
+    if (m_impl->results.empty()) return false;
+    out = std::move(m_impl->results.front());
+    m_impl->results.pop_front();
+    return true;
+}
+
+bool InferenceWorker::poll_segment(std::string & out) {
+    if (!m_impl) return false;
+    std::lock_guard<std::mutex> lock(m_impl->mutex);
+    if (m_impl->segments.empty()) return false;
+    out = std::move(m_impl->segments.front());
+    m_impl->segments.pop_front();
+    return true;
+}
+
+bool InferenceWorker::busy() const {
+    if (!m_impl) return false;
+    std::lock_guard<std::mutex> lock(m_impl->mutex);
+    return m_impl->active || !m_impl->jobs.empty() || !m_impl->results.empty() ||
+           !m_impl->segments.empty();
+}
+
+void InferenceWorker::cancel(bool keep_segments) {
+    if (!m_impl) return;
+    std::lock_guard<std::mutex> lock(m_impl->mutex);
+    m_impl->jobs.clear();
+    if (!keep_segments) m_impl->segments.clear();
+    m_impl->has_partial      = false;
+    m_impl->has_partial_text = false;
+    m_impl->partial_gen++;
+    m_impl->cancel_gen++;
+}
+
+void InferenceWorker::cancel_partial() {
+    if (!m_impl) return;
+    std::lock_guard<std::mutex> lock(m_impl->mutex);
+    m_impl->has_partial      = false;
+    m_impl->has_partial_text = false;
+    m_impl->partial_gen++;
+}
+
+void InferenceWorker::reset_context() {
+    if (!m_impl) return;
+    std::lock_guard<std::mutex> lock(m_impl->mutex);
+    m_impl->prev_text.clear();
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+struct whisper_context;
+struct InferenceWorkerImpl;
+
+struct InferenceOptions {
+    std::string language = "en";
+    bool        translate = false;
+    int         n_threads = 4;
+    int         audio_ctx = 0;
+    std::string vad_model_path;  // whisper's own VAD pass, for jobs that are not speech_only
+};
+
+struct InferenceJob {
+    std::vector<float> pcm;
+    bool speech_only      = false;  // pcm already reduced to speech by the streaming VAD
+    bool continue_context = false;  // prompt with the previous job's text (long-form chunks)
+    bool stream           = false;  // hand out segments as they are decoded, see poll_segment()
+    std::string language;           // overrides InferenceOptions::language when set
+    std::string prompt;             // initial prompt, unless continuing the previous job's text
+    bool translate        = false;  // translate to English even if InferenceOptions::translate is off
+};
+
+// Cheap preview of the recording so far: single segment, encoder window
+// cut to the audio length. See submit_partial().
+struct PartialJob {
+    std::vector<float> pcm;
+    std::string language;  // as InferenceJob
+    std::string prompt;
+    bool        translate = false;
+};
+
+struct InferenceResult {
+    std::string text;               // concatenated segments, possibly partial if cancelled
+    bool        cancelled = false;
+    bool        failed    = false;
+    bool        streamed  = false;  // text was already handed out segment by segment
+};
+
+// Runs whisper_full() on a background thread, one job at a time in
+// submission order, so the main loop keeps recording, polling the hotkey
+// and drawing the window while a transcription runs.
+//
+// The worker owns the whisper context between start() and stop().
+class InferenceWorker {
+public:
+    InferenceWorker();
+    ~InferenceWorker();
+
+    InferenceWorker(const InferenceWorker &) = delete;
+    InferenceWorker & operator=(const InferenceWorker &) = delete;
+
+    bool start(whisper_context * ctx, const InferenceOptions & opts);
+    void stop();
+
+    // Queue a job. A running partial decode is aborted and a pending one
+    // dropped, so previews never delay real work.
+    void submit(InferenceJob job);
+
+    // Low priority: runs only while no job is queued or running. Replaces
+    // a partial that has not started yet.
+    void submit_partial(PartialJob job);
+
+    // Text of the newest finished partial decode, if there is one since the
+    // last call. Non-blocking.
+    bool poll_partial(std::string & out);
+
+    // Next finished result, in submission order. Non-blocking.
+    bool poll(InferenceResult & out);
+
+    // Next segment of a stream job, as soon as whisper has decoded it and
+    // while later segments are still being decoded. Non-blocking.
+    bool poll_segment(std::string & out);
+
+    // Jobs queued or running, or results not yet polled (partials do not count)
+    bool busy() const;
+
+    // Abort the running job (its finished segments are still returned,
+    // marked cancelled) and drop the queued ones and partials. Segments a
+    // stream job handed out but that were not polled yet are dropped too,
+    // unless keep_segments.
+    void cancel(bool keep_segments = false);
+
+    // Abort a running partial decode and drop a pending one and its text,
+    // so a preview never outlives its recording
+    void cancel_partial();
+
+    // Forget the text carried over as prompt between jobs
+    void reset_context();
+
+private:
+    std::unique_ptr<InferenceWorkerImpl> m_impl;
+};
@@ -0,0 +1,68 @@
+// Level meter, separated from capture.cpp so tests can link without
+// PipeWire/SDL.
+
+#include "level_meter.h"
+#include "vad.h"
+
+#include <algorithm>
+#include <cmath>
+
+void LevelMeter::publish(const LevelColumn & c) {
+    const uint64_t i = m_next.load(std::memory_order_relaxed);
+    Slot & s = m_slots[i & (CAPACITY - 1)];
+
+    // Mark the slot torn before touching it
+    s.seq.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    s.min.store(c.min, std::memory_order_relaxed);
+    s.max.store(c.max, std::memory_order_relaxed);
+    s.level_db.store(c.level_db, std::memory_order_relaxed);
+    s.seq.store(i + 1, std::memory_order_release);
+
+    m_next.store(i + 1, std::memory_order_release);
+}
+
+size_t LevelMeter::latest(LevelColumn * out, size_t max_columns) const {
+    const uint64_t end = count();
+    const size_t   n   = (size_t) std::min<uint64_t>({end, (uint64_t) max_columns, (uint64_t) CAPACITY});
+
+    for (size_t k = 0; k < n; k++) {
+        const uint64_t i = end - n + k;
+        const Slot & s = m_slots[i & (CAPACITY - 1)];
+
+        LevelColumn c;
+        const uint64_t before = s.seq.load(std::memory_order_acquire);
+        c.min      = s.min.load(std::memory_order_relaxed);
+        c.max      = s.max.load(std::memory_order_relaxed);
+        c.level_db = s.level_db.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        const uint64_t after = s.seq.load(std::memory_order_relaxed);
+
+        out[k] = (before == i + 1 && after == i + 1) ? c : LevelColumn{};
+    }
+    return n;
+}
+
+void LevelMeter::set_vad(float threshold_db, bool speech) {
+    m_threshold_db.store(threshold_db, std::memory_order_relaxed);
+    m_speech.store(speech, std::memory_order_relaxed);
+}
+
+void LevelDecimator::push(const float * pcm, size_t n, LevelMeter & meter) {
+    for (size_t i = 0; i < n; i++) {
+        const float x = pcm[i];
+        if (m_count == 0) {
+            m_min = m_max = x;
+        } else {
+            m_min = std::min(m_min, x);
+            m_max = std::max(m_max, x);
+        }
+        m_sum += std::fabs(x);
+
+        if (++m_count == LEVEL_COLUMN_SAMPLES) {
+            meter.publish({m_min, m_max, energy_to_dbfs(m_sum / (float) LEVEL_COLUMN_SAMPLES)});
+            m_sum   = 0.0f;
+            m_count = 0;
+        }
+    }
+}
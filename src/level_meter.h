@@ -0,0 +1,73 @@
+#pragma once
+
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+// One decimated column of the input signal
+struct LevelColumn {
+    float min      = 0.0f;     // lowest and highest sample
+    float max      = 0.0f;
+    float level_db = -120.0f;  // mean absolute amplitude, as the energy VAD measures it
+};
+
+// Recent input levels for display, plus the VAD's view of them.
+//
+// Capture callbacks publish one column per LEVEL_COLUMN_SAMPLES through a
+// LevelDecimator; the GUI thread copies the newest columns out. Both sides
+// are lock-free and allocation-free. Slots carry a sequence number, so a
+// reader never shows a column that is being overwritten (it reads as
+// silence). There must be one publisher at a time: CaptureManager moves
+// the meter to a new lead microphone only after the old one's callback
+// has let go of it.
+class LevelMeter {
+public:
+    static constexpr size_t CAPACITY = 512;  // power of two
+
+    // Producer: append a column
+    void publish(const LevelColumn & c);
+
+    // Copy the newest min(max_columns, CAPACITY) columns into out, oldest
+    // first. Returns how many were written; fewer if less has been
+    // published. Columns not yet (or no longer) intact read as silence.
+    size_t latest(LevelColumn * out, size_t max_columns) const;
+
+    // Columns published so far
+    uint64_t count() const { return m_next.load(std::memory_order_acquire); }
+
+    // Set by whoever runs the VAD: the energy threshold in dBFS (NaN when
+    // there is none to show) and whether the current audio counts as speech
+    void  set_vad(float threshold_db, bool speech);
+    float threshold_db() const { return m_threshold_db.load(std::memory_order_relaxed); }
+    bool  speech() const       { return m_speech.load(std::memory_order_relaxed); }
+
+private:
+    struct Slot {
+        std::atomic<uint64_t> seq{0};  // column index + 1 once written, 0 while writing
+        std::atomic<float>    min{0.0f};
+        std::atomic<float>    max{0.0f};
+        std::atomic<float>    level_db{-120.0f};
+    };
+
+    Slot                  m_slots[CAPACITY];
+    std::atomic<uint64_t> m_next{0};
+    std::atomic<float>    m_threshold_db{NAN};
+    std::atomic<bool>     m_speech{false};
+};
+
+// Samples per column: 10 ms at 16 kHz, so the ring spans about 5 s
+constexpr size_t LEVEL_COLUMN_SAMPLES = 160;
+
+// Producer-side accumulator that turns a sample stream into columns.
+// Owned by a single capture callback.
+class LevelDecimator {
+public:
+    void push(const float * pcm, size_t n, LevelMeter & meter);
+
+private:
+    float  m_min   = 0.0f;
+    float  m_max   = 0.0f;
+    float  m_sum   = 0.0f;  // of absolute values
+    size_t m_count = 0;
+};
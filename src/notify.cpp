@@ -0,0 +1,161 @@
+#include "notify.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include <gio/gio.h>
+
+// Upper bound for a single Notify round trip to the notification daemon
+static constexpr int NOTIFY_CALL_TIMEOUT_MS = 2000;
+
+// After another failure (timeout, daemon restarting), notifications are
+// dropped for a while, twice as long after each failure in a row
+static constexpr int NOTIFY_BACKOFF_MIN_MS = 1000;
+static constexpr int NOTIFY_BACKOFF_MAX_MS = 60000;
+
+struct NotifierImpl {
+    GDBusConnection * conn = nullptr;
+    std::thread       worker;
+
+    std::mutex              mutex;
+    std::condition_variable cv;
+    bool                    running     = false;
+    bool                    has_pending = false;
+    std::string             pending_body;
+    int                     pending_timeout_ms = 0;
+
+    // ID of the last notification shown (worker thread only); 0 = none
+    guint32 last_id = 0;
+
+    // Failure backoff (worker thread only)
+    int                                   backoff_ms = 0;
+    std::chrono::steady_clock::time_point retry_at;
+
+    // Set when no notification daemon owns the name: every utterance would
+    // fail (and log) again
+    std::atomic<bool> disabled{false};
+};
+
+static void send_notify(NotifierImpl * impl, const std::string & body, int timeout_ms) {
+    if (impl->backoff_ms > 0 && std::chrono::steady_clock::now() < impl->retry_at) return;
+
+    GVariantBuilder actions;
+    GVariantBuilder hints;
+    g_variant_builder_init(&actions, G_VARIANT_TYPE("as"));
+    g_variant_builder_init(&hints, G_VARIANT_TYPE("a{sv}"));
+    // Status toasts are short-lived; keep them out of the notification history
+    g_variant_builder_add(&hints, "{sv}", "transient", g_variant_new_boolean(TRUE));
+
+    GError * err = nullptr;
+    GVariant * reply = g_dbus_connection_call_sync(
+        impl->conn,
+        "org.freedesktop.Notifications",
+        "/org/freedesktop/Notifications",
+        "org.freedesktop.Notifications",
+        "Notify",
+        g_variant_new("(susssasa{sv}i)",
+                      "whisper-typer",           // app_name
+                      impl->last_id,             // replaces_id
+                      "audio-input-microphone",  // app_icon
+                      "whisper-typer",           // summary
+                      body.c_str(),              // body
+                      &actions, &hints,
+                      (gint32) timeout_ms),
+        G_VARIANT_TYPE("(u)"),
+        G_DBUS_CALL_FLAGS_NONE,
+        NOTIFY_CALL_TIMEOUT_MS,
+        nullptr,
+        &err);
+
+    if (!reply) {
+        impl->last_id = 0;
+        if (g_error_matches(err, G_DBUS_ERROR, G_DBUS_ERROR_SERVICE_UNKNOWN) ||
+            g_error_matches(err, G_DBUS_ERROR, G_DBUS_ERROR_NAME_HAS_NO_OWNER)) {
+            fprintf(stderr, "notify: no notification daemon, notifications disabled: %s\n", err->message);
+            impl->disabled = true;
+        } else {
+            impl->backoff_ms = impl->backoff_ms > 0 ? std::min(NOTIFY_BACKOFF_MAX_MS, impl->backoff_ms * 2)
+                                                    : NOTIFY_BACKOFF_MIN_MS;
+            impl->retry_at   = std::chrono::steady_clock::now() + std::chrono::milliseconds(impl->backoff_ms);
+            fprintf(stderr, "notify: Notify failed, retrying in %d s: %s\n", impl->backoff_ms / 1000,
+                    err ? err->message : "unknown error");
+        }
+        g_clear_error(&err);
+        return;
+    }
+
+    impl->backoff_ms = 0;
+    g_variant_get(reply, "(u)", &impl->last_id);
+    g_variant_unref(reply);
+}
+
+static void notify_thread(NotifierImpl * impl) {
+    std::unique_lock<std::mutex> lock(impl->mutex);
+    while (true) {
+        impl->cv.wait(lock, [impl]() { return impl->has_pending || !impl->running; });
+        if (!impl->running) break;
+
+        std::string body = std::move(impl->pending_body);
+        int timeout_ms   = impl->pending_timeout_ms;
+        impl->has_pending = false;
+
+        lock.unlock();
+        send_notify(impl, body, timeout_ms);
+        lock.lock();
+    }
+}
+
+Notifier::Notifier() = default;
+Notifier::~Notifier() { shutdown(); }
+
+bool Notifier::init() {
+    m_impl = std::make_unique<NotifierImpl>();
+
+    GError * err = nullptr;
+    m_impl->conn = g_bus_get_sync(G_BUS_TYPE_SESSION, nullptr, &err);
+    if (!m_impl->conn) {
+        fprintf(stderr, "notify: cannot connect to session bus: %s\n", err ? err->message : "unknown error");
+        g_clear_error(&err);
+        m_impl.reset();
+        return false;
+    }
+    // The shared bus connection exits the process on disconnect by default
+    g_dbus_connection_set_exit_on_close(m_impl->conn, FALSE);
+
+    m_impl->running = true;
+    m_impl->worker  = std::thread(notify_thread, m_impl.get());
+    return true;
+}
+
+void Notifier::notify(const char * body, int timeout_ms) {
+    if (!m_impl || m_impl->disabled) return;
+    {
+        std::lock_guard<std::mutex> lock(m_impl->mutex);
+        m_impl->pending_body       = body;
+        m_impl->pending_timeout_ms = timeout_ms;
+        m_impl->has_pending        = true;
+    }
+    m_impl->cv.notify_one();
+}
+
+void Notifier::shutdown() {
+    if (!m_impl) return;
+    {
+        std::lock_guard<std::mutex> lock(m_impl->mutex);
+        m_impl->running = false;
+    }
+    m_impl->cv.notify_one();
+    if (m_impl->worker.joinable()) m_impl->worker.join();
+
+    if (m_impl->conn) {
+        g_object_unref(m_impl->conn);
+        m_impl->conn = nullptr;
+    }
+    m_impl.reset();
+}
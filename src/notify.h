@@ -0,0 +1,33 @@
+#pragma once
+
+#include <memory>
+
+struct NotifierImpl;
+
+// Desktop notifications via org.freedesktop.Notifications over D-Bus.
+//
+// Keeps one persistent session bus connection. Notify calls are made on a
+// background thread, so notify() never blocks the caller. All notifications
+// share one ID: each new one replaces the previous toast in place.
+class Notifier {
+public:
+    Notifier();
+    ~Notifier();
+
+    Notifier(const Notifier &) = delete;
+    Notifier & operator=(const Notifier &) = delete;
+
+    // Connect to the session bus and start the sender thread.
+    // Returns false if no session bus is available.
+    bool init();
+
+    // Queue a notification. If one is still pending, it is superseded.
+    // Does nothing once Notify found no notification daemon; after other
+    // failures notifications are dropped for a growing backoff.
+    void notify(const char * body, int timeout_ms);
+
+    void shutdown();
+
+private:
+    std::unique_ptr<NotifierImpl> m_impl;
+};
@@ -0,0 +1,213 @@
+#include "osd.h"
+
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+#include <X11/Xlib.h>
+#include <X11/Xutil.h>
+#include <X11/extensions/XShm.h>
+#include <X11/extensions/shape.h>
+#include <sys/ipc.h>
+#include <sys/shm.h>
+
+// Distance from the top of the screen
+static constexpr int OSD_MARGIN_TOP = 32;
+
+// Transcribing spinner step
+static constexpr auto OSD_SPIN_INTERVAL = std::chrono::milliseconds(120);
+
+struct OsdImpl {
+    Display * dpy    = nullptr;
+    Window    win    = 0;
+    GC        gc     = nullptr;
+    XImage  * image  = nullptr;
+    bool      use_shm = false;
+    XShmSegmentInfo shm = {};
+    std::vector<uint32_t> pixels;  // backing store without MIT-SHM
+
+    OsdState state      = OsdState::HIDDEN;
+    int      lit_bars   = -1;  // meter bars last drawn
+    unsigned phase      = 0;
+    bool     dirty      = true;
+    std::chrono::steady_clock::time_point last_spin;
+};
+
+static uint32_t * image_pixels(OsdImpl * impl) {
+    return reinterpret_cast<uint32_t *>(impl->image->data);
+}
+
+static void draw(OsdImpl * impl, float level) {
+    OsdCanvas c = { image_pixels(impl), OSD_WIDTH, OSD_HEIGHT, impl->image->bytes_per_line / 4 };
+    osd_draw(c, impl->state, level, impl->phase);
+    if (impl->use_shm) {
+        XShmPutImage(impl->dpy, impl->win, impl->gc, impl->image, 0, 0, 0, 0, OSD_WIDTH, OSD_HEIGHT, False);
+    } else {
+        XPutImage(impl->dpy, impl->win, impl->gc, impl->image, 0, 0, 0, 0, OSD_WIDTH, OSD_HEIGHT);
+    }
+    XFlush(impl->dpy);
+    impl->dirty = false;
+}
+
+// Set by on_shm_error while create_shm_image waits for the attach
+static bool g_shm_failed = false;
+
+static int on_shm_error(Display * /*dpy*/, XErrorEvent * /*ev*/) {
+    g_shm_failed = true;
+    return 0;
+}
+
+// MIT-SHM image: the server reads the pixels directly, no copy over the socket
+static bool create_shm_image(OsdImpl * impl, Visual * visual, int depth) {
+    if (!XShmQueryExtension(impl->dpy)) return false;
+    impl->image = XShmCreateImage(impl->dpy, visual, depth, ZPixmap, nullptr, &impl->shm, OSD_WIDTH, OSD_HEIGHT);
+    if (!impl->image) return false;
+
+    impl->shm.shmid = shmget(IPC_PRIVATE, impl->image->bytes_per_line * impl->image->height, IPC_CREAT | 0600);
+    if (impl->shm.shmid < 0) {
+        XDestroyImage(impl->image);
+        impl->image = nullptr;
+        return false;
+    }
+    impl->shm.shmaddr = impl->image->data = static_cast<char *>(shmat(impl->shm.shmid, nullptr, 0));
+    impl->shm.readOnly = False;
+
+    // The attach fails on the server for remote displays or in containers
+    // without a shared IPC namespace. That error must not reach Xlib's
+    // default handler, which exits.
+    bool ok = impl->shm.shmaddr != reinterpret_cast<char *>(-1);
+    if (ok) {
+        XSync(impl->dpy, False);
+        g_shm_failed = false;
+        XErrorHandler previous = XSetErrorHandler(on_shm_error);
+        ok = XShmAttach(impl->dpy, &impl->shm);
+        XSync(impl->dpy, False);
+        XSetErrorHandler(previous);
+        ok = ok && !g_shm_failed;
+    }
+    // Marked for removal now, so the segment goes away with the process
+    shmctl(impl->shm.shmid, IPC_RMID, nullptr);
+    if (!ok) {
+        if (impl->shm.shmaddr != reinterpret_cast<char *>(-1)) shmdt(impl->shm.shmaddr);
+        impl->image->data = nullptr;
+        XDestroyImage(impl->image);
+        impl->image = nullptr;
+        return false;
+    }
+    return true;
+}
+
+Osd::Osd() = default;
+Osd::~Osd() { shutdown(); }
+
+bool Osd::init() {
+    Display * dpy = XOpenDisplay(nullptr);
+    if (!dpy) {
+        fprintf(stderr, "osd: cannot open X display\n");
+        return false;
+    }
+
+    const int screen = DefaultScreen(dpy);
+    Visual *  visual = DefaultVisual(dpy, screen);
+    const int depth  = DefaultDepth(dpy, screen);
+    if (depth != 24 && depth != 32) {
+        fprintf(stderr, "osd: unsupported X visual depth %d\n", depth);
+        XCloseDisplay(dpy);
+        return false;
+    }
+
+    m_impl = std::make_unique<OsdImpl>();
+    m_impl->dpy = dpy;
+
+    XSetWindowAttributes attrs = {};
+    attrs.override_redirect = True;  // no decorations, no focus, not in the taskbar
+    attrs.background_pixel  = BlackPixel(dpy, screen);
+    attrs.event_mask        = ExposureMask;
+    const int x = (DisplayWidth(dpy, screen) - OSD_WIDTH) / 2;
+    m_impl->win = XCreateWindow(dpy, RootWindow(dpy, screen), x, OSD_MARGIN_TOP, OSD_WIDTH, OSD_HEIGHT, 0,
+                                depth, InputOutput, visual,
+                                CWOverrideRedirect | CWBackPixel | CWEventMask, &attrs);
+    XStoreName(dpy, m_impl->win, "whisper-typer-osd");
+
+    // Empty input shape: clicks go to whatever is below
+    XShapeCombineRectangles(dpy, m_impl->win, ShapeInput, 0, 0, nullptr, 0, ShapeSet, Unsorted);
+
+    m_impl->gc = XCreateGC(dpy, m_impl->win, 0, nullptr);
+
+    m_impl->use_shm = create_shm_image(m_impl.get(), visual, depth);
+    if (!m_impl->use_shm) {
+        fprintf(stderr, "osd: MIT-SHM unavailable, sending images over the socket\n");
+        m_impl->pixels.resize((size_t) OSD_WIDTH * OSD_HEIGHT);
+        m_impl->image = XCreateImage(dpy, visual, depth, ZPixmap, 0,
+                                     reinterpret_cast<char *>(m_impl->pixels.data()),
+                                     OSD_WIDTH, OSD_HEIGHT, 32, OSD_WIDTH * 4);
+        if (!m_impl->image) {
+            fprintf(stderr, "osd: cannot create image\n");
+            shutdown();
+            return false;
+        }
+    }
+    XFlush(dpy);
+    return true;
+}
+
+void Osd::set_state(OsdState state) {
+    if (!m_impl || m_impl->state == state) return;
+    const bool was_hidden = m_impl->state == OsdState::HIDDEN;
+    m_impl->state = state;
+    m_impl->dirty = true;
+
+    if (state == OsdState::HIDDEN) {
+        XUnmapWindow(m_impl->dpy, m_impl->win);
+        XFlush(m_impl->dpy);
+    } else if (was_hidden) {
+        XMapRaised(m_impl->dpy, m_impl->win);
+        XFlush(m_impl->dpy);
+    }
+}
+
+void Osd::tick(float level_db) {
+    if (!m_impl) return;
+
+    // Expose after mapping or when uncovered
+    while (XPending(m_impl->dpy)) {
+        XEvent ev;
+        XNextEvent(m_impl->dpy, &ev);
+        if (ev.type == Expose) m_impl->dirty = true;
+    }
+    if (m_impl->state == OsdState::HIDDEN) return;
+
+    const float level = osd_level_from_db(level_db);
+    if (m_impl->state == OsdState::RECORDING) {
+        const int lit = osd_lit_bars(level);
+        if (lit != m_impl->lit_bars) {
+            m_impl->lit_bars = lit;
+            m_impl->dirty    = true;
+        }
+    } else {
+        auto now = std::chrono::steady_clock::now();
+        if (now - m_impl->last_spin >= OSD_SPIN_INTERVAL) {
+            m_impl->last_spin = now;
+            m_impl->phase++;
+            m_impl->dirty = true;
+        }
+    }
+    if (m_impl->dirty) draw(m_impl.get(), level);
+}
+
+void Osd::shutdown() {
+    if (!m_impl) return;
+    if (m_impl->image) {
+        if (m_impl->use_shm) {
+            XShmDetach(m_impl->dpy, &m_impl->shm);
+            shmdt(m_impl->shm.shmaddr);
+        }
+        // Pixels belong to the shm segment or the vector, not to Xlib
+        m_impl->image->data = nullptr;
+        XDestroyImage(m_impl->image);
+    }
+    if (m_impl->gc)  XFreeGC(m_impl->dpy, m_impl->gc);
+    if (m_impl->win) XDestroyWindow(m_impl->dpy, m_impl->win);
+    XCloseDisplay(m_impl->dpy);
+    m_impl.reset();
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "osd_raster.h"
+
+#include <memory>
+
+#ifdef HAS_OSD
+
+struct OsdImpl;
+
+// Small always-on-top recording indicator.
+//
+// An override-redirect X11 window (no window manager involvement, no
+// focus, click-through) painted by the software rasterizer in
+// osd_raster.cpp into a MIT-SHM image, or a plain XImage where shared
+// memory is unavailable. Showing and hiding is a map/unmap; while hidden
+// it costs nothing but the idle X connection.
+//
+// On Wayland this runs through XWayland; there is no layer-shell client.
+class Osd {
+public:
+    Osd();
+    ~Osd();
+
+    Osd(const Osd &) = delete;
+    Osd & operator=(const Osd &) = delete;
+
+    // Open the X display and create the (unmapped) window
+    bool init();
+
+    // HIDDEN unmaps the window; the other states map and redraw it
+    void set_state(OsdState state);
+
+    // Redraw with the current input level (dBFS) if anything changed,
+    // and handle expose events. Cheap to call every main-loop tick.
+    void tick(float level_db);
+
+    void shutdown();
+
+private:
+    std::unique_ptr<OsdImpl> m_impl;
+};
+
+#else
+
+// Stub when built without X11
+class Osd {
+public:
+    bool init() { return false; }
+    void set_state(OsdState) {}
+    void tick(float) {}
+    void shutdown() {}
+};
+
+#endif
@@ -0,0 +1,86 @@
+#include "osd_raster.h"
+
+#include <algorithm>
+#include <cmath>
+
+static constexpr uint32_t OSD_BG        = 0x202020;
+static constexpr uint32_t OSD_BORDER    = 0x505050;
+static constexpr uint32_t OSD_REC       = 0xE04040;
+static constexpr uint32_t OSD_BUSY      = 0xF0C030;
+static constexpr uint32_t OSD_BAR       = 0x60D060;
+static constexpr uint32_t OSD_BAR_OFF   = 0x383838;
+
+// Level range shown by the bars (dBFS)
+static constexpr float OSD_MIN_DB = -60.0f;
+static constexpr float OSD_MAX_DB = -10.0f;
+
+static uint32_t blend(uint32_t dst, uint32_t src, float a) {
+    auto ch = [&](int shift) {
+        float d = (float) ((dst >> shift) & 0xFF);
+        float s = (float) ((src >> shift) & 0xFF);
+        return (uint32_t) std::lround(d + (s - d) * a) << shift;
+    };
+    return ch(16) | ch(8) | ch(0);
+}
+
+void osd_fill_rect(OsdCanvas & c, int x, int y, int w, int h, uint32_t color) {
+    const int x0 = std::max(0, x), x1 = std::min(c.width,  x + w);
+    const int y0 = std::max(0, y), y1 = std::min(c.height, y + h);
+    for (int j = y0; j < y1; j++) {
+        std::fill(c.px + j * c.stride + x0, c.px + j * c.stride + std::max(x0, x1), color);
+    }
+}
+
+void osd_fill_circle(OsdCanvas & c, float cx, float cy, float r, uint32_t color) {
+    const int x0 = std::max(0, (int) std::floor(cx - r - 1)), x1 = std::min(c.width,  (int) std::ceil(cx + r + 1));
+    const int y0 = std::max(0, (int) std::floor(cy - r - 1)), y1 = std::min(c.height, (int) std::ceil(cy + r + 1));
+    for (int j = y0; j < y1; j++) {
+        for (int i = x0; i < x1; i++) {
+            // Coverage from the distance of the pixel centre to the edge
+            float d = std::sqrt((i + 0.5f - cx) * (i + 0.5f - cx) + (j + 0.5f - cy) * (j + 0.5f - cy));
+            float a = std::clamp(r - d + 0.5f, 0.0f, 1.0f);
+            if (a <= 0.0f) continue;
+            uint32_t & p = c.px[j * c.stride + i];
+            p = a >= 1.0f ? color : blend(p, color, a);
+        }
+    }
+}
+
+float osd_level_from_db(float db) {
+    return std::clamp((db - OSD_MIN_DB) / (OSD_MAX_DB - OSD_MIN_DB), 0.0f, 1.0f);
+}
+
+int osd_lit_bars(float level) {
+    return (int) std::lround(std::clamp(level, 0.0f, 1.0f) * OSD_BARS);
+}
+
+void osd_draw(OsdCanvas & c, OsdState state, float level, unsigned phase) {
+    osd_fill_rect(c, 0, 0, c.width, c.height, OSD_BORDER);
+    osd_fill_rect(c, 1, 1, c.width - 2, c.height - 2, OSD_BG);
+    if (state == OsdState::HIDDEN) return;
+
+    const float cy = c.height * 0.5f;
+    const float r  = c.height * 0.25f;
+    osd_fill_circle(c, c.height * 0.5f, cy, r, state == OsdState::RECORDING ? OSD_REC : OSD_BUSY);
+
+    const int left   = c.height;
+    const int right  = c.width - c.height / 3;
+    const int bar_w  = std::max(1, (right - left) / (OSD_BARS * 2 - 1));
+    const int bar_h  = c.height / 2;
+    const int top    = (c.height - bar_h) / 2;
+
+    if (state == OsdState::RECORDING) {
+        // Level meter: lit bars up to the current level
+        const int lit = osd_lit_bars(level);
+        for (int i = 0; i < OSD_BARS; i++) {
+            osd_fill_rect(c, left + i * bar_w * 2, top, bar_w, bar_h, i < lit ? OSD_BAR : OSD_BAR_OFF);
+        }
+    } else {
+        // Transcribing: one dot travels along the bar positions
+        const int on = (int) (phase % OSD_BARS);
+        for (int i = 0; i < OSD_BARS; i++) {
+            float x = left + i * bar_w * 2 + bar_w * 0.5f;
+            osd_fill_circle(c, x, cy, bar_w * 0.5f + 0.5f, i == on ? OSD_BUSY : OSD_BAR_OFF);
+        }
+    }
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+
+// Software rendering of the recording indicator into a 32-bit xRGB
+// buffer (the layout of a 24/32-bit X11 ZPixmap). No toolkit, no GPU.
+
+enum class OsdState { HIDDEN, RECORDING, TRANSCRIBING };
+
+struct OsdCanvas {
+    uint32_t * px;
+    int        width;
+    int        height;
+    int        stride;  // in pixels
+};
+
+// Indicator size in pixels
+constexpr int OSD_WIDTH  = 120;
+constexpr int OSD_HEIGHT = 32;
+
+// Bars of the level meter
+constexpr int OSD_BARS = 8;
+
+// Fill an axis-aligned rectangle, clipped to the canvas
+void osd_fill_rect(OsdCanvas & c, int x, int y, int w, int h, uint32_t color);
+
+// Anti-aliased filled circle, blended over what is there
+void osd_fill_circle(OsdCanvas & c, float cx, float cy, float r, uint32_t color);
+
+// Draw the whole indicator. level is the input level in 0..1 (recording);
+// phase advances by one per animation frame (transcribing spinner).
+void osd_draw(OsdCanvas & c, OsdState state, float level, unsigned phase);
+
+// Map dBFS to the 0..1 level shown by the bars
+float osd_level_from_db(float db);
+
+// Number of lit bars for a 0..1 level
+int osd_lit_bars(float level);
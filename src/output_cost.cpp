@@ -0,0 +1,67 @@
+#include "output_cost.h"
+
+#include <algorithm>
+#include <cctype>
+
+// EMA weight of a new measurement
+static constexpr float COST_ALPHA = 0.2f;
+
+// Below this many characters a typing measurement mostly tells the
+// overhead, above it mostly the per-key cost
+static constexpr size_t COST_SPLIT_CHARS = 20;
+
+float OutputCostModel::type_estimate(size_t n_chars, int delay_ms) const {
+    return m_type_base_ms + (float) n_chars * (m_key_ms + (float) std::max(0, delay_ms));
+}
+
+OutputCostModel::Decision OutputCostModel::choose(size_t n_chars, int delay_ms, Target target) const {
+    Decision d;
+    d.type_ms  = type_estimate(n_chars, delay_ms);
+    d.paste_ms = m_paste_ms;
+    switch (target) {
+        case Target::TYPE_ONLY:  d.method = Method::TYPE;  break;
+        case Target::PASTE_ONLY: d.method = Method::PASTE; break;
+        default:                 d.method = d.type_ms <= d.paste_ms ? Method::TYPE : Method::PASTE; break;
+    }
+    return d;
+}
+
+void OutputCostModel::record_type(size_t n_chars, int delay_ms, float ms) {
+    const float per_char_delay = (float) std::max(0, delay_ms);
+    if (n_chars >= COST_SPLIT_CHARS) {
+        float key = (ms - m_type_base_ms) / (float) n_chars - per_char_delay;
+        m_key_ms += COST_ALPHA * (std::max(0.0f, key) - m_key_ms);
+    } else {
+        float base = ms - (float) n_chars * (m_key_ms + per_char_delay);
+        m_type_base_ms += COST_ALPHA * (std::max(0.0f, base) - m_type_base_ms);
+    }
+}
+
+void OutputCostModel::record_paste(float ms) {
+    m_paste_ms += COST_ALPHA * (ms - m_paste_ms);
+}
+
+OutputCostModel::Target output_target_for(const std::string & window_class, bool is_terminal,
+                                          bool is_password, const std::string & text) {
+    // A pasted secret would stay on the clipboard (and in clipboard history)
+    if (is_password) return OutputCostModel::Target::TYPE_ONLY;
+
+    // A typed newline is Enter: in a terminal it runs a half-dictated
+    // command. Pasting goes through bracketed paste instead.
+    if (is_terminal && text.find('\n') != std::string::npos) return OutputCostModel::Target::PASTE_ONLY;
+
+    std::string lower = window_class;
+    std::transform(lower.begin(), lower.end(), lower.begin(),
+                   [](unsigned char c) { return std::tolower(c); });
+
+    // Remote desktop and VM viewers forward keys but not always the clipboard
+    static const char * type_only[] = {
+        "remmina", "org.remmina.remmina", "xfreerdp", "wlfreerdp", "vncviewer", "tigervnc",
+        "vinagre", "krdc", "virt-viewer", "remote-viewer", "virt-manager", "virtualbox machine",
+        nullptr
+    };
+    for (int i = 0; type_only[i]; i++) {
+        if (lower == type_only[i]) return OutputCostModel::Target::TYPE_ONLY;
+    }
+    return OutputCostModel::Target::ANY;
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <string>
+
+// Chooses between keystroke typing and clipboard paste per transcript.
+//
+// Typing costs a per-spawn overhead plus, per character, the keystroke
+// delay and the time to inject one key; pasting costs a roughly constant
+// clipboard round trip. Both are running averages (EMA) of measured
+// durations, seeded with typical X11 values, so the crossover length
+// adapts to the machine and the tools in use.
+class OutputCostModel {
+public:
+    enum class Method { TYPE, PASTE };
+
+    // Hard constraints from the target window
+    enum class Target {
+        ANY,
+        TYPE_ONLY,   // clipboard may not reach it (remote desktop viewers)
+        PASTE_ONLY,  // typed newlines would execute (terminal, multi-line text)
+    };
+
+    struct Decision {
+        Method method;
+        float  type_ms;   // estimates behind the choice
+        float  paste_ms;
+    };
+
+    Decision choose(size_t n_chars, int delay_ms, Target target) const;
+
+    // Feed back a measured duration
+    void record_type(size_t n_chars, int delay_ms, float ms);
+    void record_paste(float ms);
+
+    float type_estimate(size_t n_chars, int delay_ms) const;
+    float paste_estimate() const { return m_paste_ms; }
+
+    static const char * method_name(Method m) { return m == Method::TYPE ? "type" : "paste"; }
+
+private:
+    float m_type_base_ms = 30.0f;   // process spawn, window lookup
+    float m_key_ms       = 1.5f;    // per character, on top of the delay
+    float m_paste_ms     = 420.0f;  // save, set, paste, settle, restore
+};
+
+// Window classes and widgets that need a particular output method
+OutputCostModel::Target output_target_for(const std::string & window_class, bool is_terminal,
+                                          bool is_password, const std::string & text);
@@ -0,0 +1,65 @@
+#include "pacing.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+int PacingTable::delay_for(const std::string & cls, int start_ms) const {
+    auto it = m_profiles.find(cls);
+    return it != m_profiles.end() ? it->second.delay_ms : start_ms;
+}
+
+int PacingTable::report(const std::string & cls, bool ok, int start_ms) {
+    if (cls.empty()) return start_ms;
+    auto it = m_profiles.find(cls);
+    if (it == m_profiles.end()) {
+        it = m_profiles.emplace(cls, Profile{std::clamp(start_ms, MIN_MS, MAX_MS), 0}).first;
+    }
+    Profile & p = it->second;
+
+    if (ok) {
+        if (++p.streak >= SPEEDUP_STREAK && p.delay_ms > MIN_MS) {
+            p.delay_ms--;
+            p.streak = 0;
+        }
+    } else {
+        p.delay_ms = std::min(MAX_MS, std::max(1, p.delay_ms * 2));
+        p.streak   = 0;
+    }
+    m_dirty = true;
+    return p.delay_ms;
+}
+
+bool PacingTable::load(const std::string & path) {
+    std::ifstream in(path);
+    if (!in) return false;
+
+    std::string line;
+    while (std::getline(in, line)) {
+        std::istringstream ss(line);
+        int delay = 0;
+        if (!(ss >> delay)) continue;
+        std::string cls;
+        std::getline(ss >> std::ws, cls);
+        if (cls.empty()) continue;
+        m_profiles[cls] = Profile{std::clamp(delay, MIN_MS, MAX_MS), 0};
+    }
+    m_dirty = false;
+    return true;
+}
+
+bool PacingTable::save(const std::string & path) const {
+    const std::string tmp = path + ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::trunc);
+        if (!out) return false;
+        for (const auto & kv : m_profiles) {
+            out << kv.second.delay_ms << " " << kv.first << "\n";
+        }
+        if (!out.good()) return false;
+    }
+    if (std::rename(tmp.c_str(), path.c_str()) != 0) return false;
+    m_dirty = false;
+    return true;
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <map>
+#include <string>
+
+// Per-window-class keystroke pacing, learned from verified typing.
+//
+// The inter-key delay for each window class follows AIMD: every few
+// verified transcripts it drops by 1 ms (typing gets faster), and a
+// transcript with dropped keys doubles it. Native toolkits converge on
+// the minimum within a few dictations; Electron and remote-desktop
+// targets that lose keys settle just above the rate where they start to.
+// A class starts at the configured delay and only gets faster once its
+// text has been read back intact; classes that are never verified keep
+// the configured delay.
+class PacingTable {
+public:
+    struct Profile {
+        int delay_ms = 0;
+        int streak   = 0;  // verified transcripts without drops at this delay
+    };
+
+    static constexpr int MIN_MS         = 0;
+    static constexpr int MAX_MS         = 80;
+    static constexpr int SPEEDUP_STREAK = 3;  // clean transcripts before each 1 ms step down
+
+    // Delay to use for a window class; start_ms until it has been learned
+    int delay_for(const std::string & cls, int start_ms) const;
+
+    // Feed back whether text typed at the class's current delay arrived
+    // intact. A new class starts at start_ms. Returns the new delay. An
+    // empty class (window not resolved) is not learned: it would pool
+    // every unknown window under one delay.
+    int report(const std::string & cls, bool ok, int start_ms);
+
+    const std::map<std::string, Profile> & profiles() const { return m_profiles; }
+
+    // "<delay_ms> <class>" per line. load() keeps what it could parse,
+    // skipping lines without a class;
+    // save() writes a temporary file and renames it into place.
+    bool load(const std::string & path);
+    bool save(const std::string & path) const;
+
+    bool dirty() const { return m_dirty; }
+
+private:
+    std::map<std::string, Profile> m_profiles;
+    mutable bool                   m_dirty = false;
+};
@@ -0,0 +1,66 @@
+#include "profile.h"
+
+#include <algorithm>
+#include <cctype>
+
+static std::string lowercase(const std::string & s) {
+    std::string out = s;
+    std::transform(out.begin(), out.end(), out.begin(), [](unsigned char c) { return std::tolower(c); });
+    return out;
+}
+
+bool ProfileTable::set(const std::string & cls, const std::string & key, const std::string & val) {
+    if (cls.empty()) return false;
+
+    AppProfile p;
+    auto it = m_profiles.find(lowercase(cls));
+    if (it != m_profiles.end()) p = it->second;
+    p.name = cls;
+
+    if (key == "language") {
+        if (val.empty()) return false;
+        p.language = val;
+    } else if (key == "prompt") {
+        p.prompt = val;
+    } else if (key == "output") {
+        if      (val == "type")  p.output = ProfileOutput::TYPE;
+        else if (val == "paste") p.output = ProfileOutput::PASTE;
+        else if (val == "auto")  p.output = ProfileOutput::DEFAULT;
+        else return false;
+    } else if (key == "paste-key") {
+        if (val.empty()) return false;
+        p.paste_key = val;
+    } else if (key == "type-delay-ms") {
+        size_t pos = 0;
+        int ms = -1;
+        try { ms = std::stoi(val, &pos); } catch (...) { return false; }
+        if (pos != val.size() || ms < 0) return false;
+        p.type_delay_ms = ms;
+    } else if (key == "trailing-punctuation") {
+        if      (val == "true"  || val == "1") p.strip_punct = false;
+        else if (val == "false" || val == "0") p.strip_punct = true;
+        else return false;
+    } else {
+        return false;
+    }
+
+    m_profiles[lowercase(cls)] = std::move(p);
+    return true;
+}
+
+const AppProfile * ProfileTable::find(const std::string & cls) const {
+    if (cls.empty() || m_profiles.empty()) return nullptr;
+    auto it = m_profiles.find(lowercase(cls));
+    return it != m_profiles.end() ? &it->second : nullptr;
+}
+
+std::string strip_final_punct(const std::string & text) {
+    std::string out = text;
+    while (!out.empty() && std::isspace((unsigned char) out.back())) out.pop_back();
+    while (!out.empty() && std::string(".,!?;:").find(out.back()) != std::string::npos) out.pop_back();
+    return out;
+}
+
+std::string profile_postprocess(const AppProfile & p, const std::string & text) {
+    return p.strip_punct ? strip_final_punct(text) : text;
+}
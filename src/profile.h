@@ -0,0 +1,46 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+
+// Output method a profile forces, instead of the global choice
+enum class ProfileOutput { DEFAULT, TYPE, PASTE };
+
+// Per-application overrides, from a [profile:CLASS] section of the config
+// file. Empty / negative fields keep the global setting.
+struct AppProfile {
+    std::string   name;                  // class as written in the section header
+    std::string   language;              // whisper language code
+    std::string   prompt;                // initial prompt (vocabulary, style)
+    ProfileOutput output        = ProfileOutput::DEFAULT;
+    std::string   paste_key;             // xdotool key for pasting, e.g. "ctrl+shift+v"
+    int           type_delay_ms = -1;    // keystroke delay; overrides adaptive pacing
+    bool          strip_punct   = false; // drop the punctuation whisper ends a transcript with
+};
+
+// Profiles by window class (X11 WM_CLASS) or application name, compared
+// case-insensitively. Built once when the config is read; lookups are a
+// single hash probe.
+class ProfileTable {
+public:
+    // Set one key of the profile for cls, creating it. False (and no
+    // change) for an unknown key or a bad value.
+    bool set(const std::string & cls, const std::string & key, const std::string & val);
+
+    // Profile for a focused window class, or nullptr
+    const AppProfile * find(const std::string & cls) const;
+
+    bool   empty() const { return m_profiles.empty(); }
+    size_t size()  const { return m_profiles.size(); }
+
+    const std::unordered_map<std::string, AppProfile> & profiles() const { return m_profiles; }
+
+private:
+    std::unordered_map<std::string, AppProfile> m_profiles;  // keyed by lowercased class
+};
+
+// Drop trailing whitespace and the punctuation whisper ends a sentence with
+std::string strip_final_punct(const std::string & text);
+
+// Apply a profile's post-processing to a piece of transcript
+std::string profile_postprocess(const AppProfile & p, const std::string & text);
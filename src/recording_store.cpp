@@ -0,0 +1,103 @@
+#include "recording_store.h"
+
+#include <algorithm>
+#include <cstring>
+
+// ---- BlockPool ----
+
+BlockPool::BlockPool(size_t block_samples, size_t max_free)
+    : m_block_samples(block_samples), m_max_free(max_free) {}
+
+std::unique_ptr<float[]> BlockPool::acquire() {
+    m_in_use++;
+    if (!m_free.empty()) {
+        auto block = std::move(m_free.back());
+        m_free.pop_back();
+        return block;
+    }
+    return std::unique_ptr<float[]>(new float[m_block_samples]);
+}
+
+void BlockPool::release(std::unique_ptr<float[]> block) {
+    if (!block) return;
+    m_in_use--;
+    if (m_free.size() < m_max_free) m_free.push_back(std::move(block));
+}
+
+// ---- RecordingStore ----
+
+RecordingStore::RecordingStore(RecordingStore && other) noexcept
+    : m_pool(other.m_pool), m_blocks(std::move(other.m_blocks)), m_size(other.m_size),
+      m_released(other.m_released) {
+    other.m_blocks.clear();
+    other.m_size     = 0;
+    other.m_released = 0;
+}
+
+RecordingStore & RecordingStore::operator=(RecordingStore && other) noexcept {
+    if (this != &other) {
+        clear();
+        m_pool     = other.m_pool;
+        m_blocks   = std::move(other.m_blocks);
+        m_size     = other.m_size;
+        m_released = other.m_released;
+        other.m_blocks.clear();
+        other.m_size     = 0;
+        other.m_released = 0;
+    }
+    return *this;
+}
+
+void RecordingStore::append(const float * data, size_t n) {
+    const size_t bs = m_pool->block_samples();
+    while (n > 0) {
+        size_t off = m_size % bs;
+        if (off == 0 && m_size / bs == m_blocks.size()) m_blocks.push_back(m_pool->acquire());
+        size_t chunk = std::min(n, bs - off);
+        memcpy(m_blocks[m_size / bs].get() + off, data, chunk * sizeof(float));
+        m_size += chunk;
+        data   += chunk;
+        n      -= chunk;
+    }
+}
+
+void RecordingStore::append_to(size_t from, size_t to, std::vector<float> & out) const {
+    const size_t bs = m_pool->block_samples();
+    to   = std::min(to, m_size);
+    from = std::max(from, first());
+    while (from < to) {
+        size_t off   = from % bs;
+        size_t chunk = std::min(to - from, bs - off);
+        const float * src = m_blocks[from / bs].get() + off;
+        out.insert(out.end(), src, src + chunk);
+        from += chunk;
+    }
+}
+
+void RecordingStore::read(size_t from, size_t to, std::vector<float> & out) const {
+    out.clear();
+    append_to(from, to, out);
+}
+
+void RecordingStore::gather(const std::vector<VadSegment> & segments, size_t gap_samples,
+                            std::vector<float> & out) const {
+    out.clear();
+    for (size_t i = 0; i < segments.size(); i++) {
+        if (i > 0) out.insert(out.end(), gap_samples, 0.0f);
+        append_to(segments[i].start, segments[i].end, out);
+    }
+}
+
+void RecordingStore::release_before(size_t pos) {
+    const size_t n = std::min(pos, m_size) / m_pool->block_samples();
+    for (; m_released < n; m_released++) {
+        m_pool->release(std::move(m_blocks[m_released]));
+    }
+}
+
+void RecordingStore::clear() {
+    for (auto & b : m_blocks) m_pool->release(std::move(b));
+    m_blocks.clear();
+    m_size     = 0;
+    m_released = 0;
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "vad.h"
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// Fixed-size sample blocks for recordings, recycled between utterances.
+//
+// Blocks are allocated on demand while recording. Released blocks are kept
+// for reuse up to max_free, the rest go back to the allocator, so an idle
+// daemon holds at most max_free blocks however long the last dictation was.
+class BlockPool {
+public:
+    BlockPool(size_t block_samples, size_t max_free);
+
+    BlockPool(const BlockPool &) = delete;
+    BlockPool & operator=(const BlockPool &) = delete;
+
+    std::unique_ptr<float[]> acquire();
+    void release(std::unique_ptr<float[]> block);
+
+    size_t block_samples() const { return m_block_samples; }
+
+    // Blocks currently handed out / held for reuse
+    size_t in_use() const { return m_in_use; }
+    size_t free_blocks() const { return m_free.size(); }
+
+private:
+    size_t m_block_samples;
+    size_t m_max_free;
+    size_t m_in_use = 0;
+    std::vector<std::unique_ptr<float[]>> m_free;
+};
+
+// Growable recording made of BlockPool blocks.
+//
+// Appending never moves samples already stored, so a long dictation costs
+// one block allocation per block_samples instead of repeated reallocations,
+// and memory follows the actual length rather than the maximum. Consumers
+// copy out only the ranges they need.
+class RecordingStore {
+public:
+    explicit RecordingStore(BlockPool & pool) : m_pool(&pool) {}
+    ~RecordingStore() { clear(); }
+
+    RecordingStore(RecordingStore && other) noexcept;
+    RecordingStore & operator=(RecordingStore && other) noexcept;
+
+    void append(const float * data, size_t n);
+
+    size_t size() const { return m_size; }
+    bool   empty() const { return m_size == 0; }
+
+    // Copy samples [from, to) into out (clamped to size())
+    void read(size_t from, size_t to, std::vector<float> & out) const;
+
+    // Concatenate the given segments into out, separated by gap_samples of
+    // silence; the block-wise equivalent of vad_gather_speech()
+    void gather(const std::vector<VadSegment> & segments, size_t gap_samples, std::vector<float> & out) const;
+
+    // Return the blocks entirely before pos to the pool; positions stay
+    // absolute and reads of released samples come back empty. Long-form
+    // recordings drop each chunk once it has been handed to whisper.
+    void release_before(size_t pos);
+
+    // First sample still held
+    size_t first() const { return m_released * m_pool->block_samples(); }
+
+    // Return all blocks to the pool
+    void clear();
+
+private:
+    BlockPool *                           m_pool;
+    std::vector<std::unique_ptr<float[]>> m_blocks;
+    size_t                                m_size = 0;
+    size_t                                m_released = 0;  // leading blocks already returned
+
+    // Append [from, to) to out
+    void append_to(size_t from, size_t to, std::vector<float> & out) const;
+};
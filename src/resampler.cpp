@@ -0,0 +1,153 @@
+#include "resampler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+
+#if defined(__SSE__) || defined(__x86_64__)
+#include <xmmintrin.h>
+#define RESAMPLER_SSE 1
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define RESAMPLER_NEON 1
+#endif
+
+// Filter design: passband edge and stopband attenuation. The stopband
+// starts at the output Nyquist frequency.
+static constexpr double RS_PASSBAND     = 0.9;   // fraction of output Nyquist
+static constexpr double RS_ATTENUATION  = 80.0;  // dB
+static constexpr size_t RS_MAX_COEFFS   = 1 << 20;
+
+// Zeroth-order modified Bessel function of the first kind (Kaiser window)
+static double bessel_i0(double x) {
+    double sum = 1.0, term = 1.0;
+    for (int k = 1; k < 50; k++) {
+        term *= (x / (2.0 * k)) * (x / (2.0 * k));
+        sum  += term;
+        if (term < sum * 1e-12) break;
+    }
+    return sum;
+}
+
+// n is a multiple of 8 and both pointers are 4-byte aligned
+static float dot(const float * a, const float * b, int n) {
+#if defined(RESAMPLER_SSE)
+    __m128 acc0 = _mm_setzero_ps();
+    __m128 acc1 = _mm_setzero_ps();
+    for (int i = 0; i < n; i += 8) {
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(a + i),     _mm_loadu_ps(b + i)));
+        acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4)));
+    }
+    __m128 acc = _mm_add_ps(acc0, acc1);
+    acc = _mm_add_ps(acc, _mm_movehl_ps(acc, acc));
+    acc = _mm_add_ss(acc, _mm_shuffle_ps(acc, acc, 1));
+    return _mm_cvtss_f32(acc);
+#elif defined(RESAMPLER_NEON)
+    float32x4_t acc0 = vdupq_n_f32(0.0f);
+    float32x4_t acc1 = vdupq_n_f32(0.0f);
+    for (int i = 0; i < n; i += 8) {
+        acc0 = vmlaq_f32(acc0, vld1q_f32(a + i),     vld1q_f32(b + i));
+        acc1 = vmlaq_f32(acc1, vld1q_f32(a + i + 4), vld1q_f32(b + i + 4));
+    }
+    float32x4_t acc = vaddq_f32(acc0, acc1);
+    float32x2_t s   = vadd_f32(vget_low_f32(acc), vget_high_f32(acc));
+    return vget_lane_f32(vpadd_f32(s, s), 0);
+#else
+    float acc0 = 0.0f, acc1 = 0.0f;
+    for (int i = 0; i < n; i += 2) {
+        acc0 += a[i]     * b[i];
+        acc1 += a[i + 1] * b[i + 1];
+    }
+    return acc0 + acc1;
+#endif
+}
+
+bool Resampler::init(int in_rate, int out_rate) {
+    if (in_rate <= 0 || out_rate <= 0) return false;
+
+    int g = std::gcd(in_rate, out_rate);
+    m_in_rate  = in_rate;
+    m_out_rate = out_rate;
+    m_L        = out_rate / g;
+    m_M        = in_rate / g;
+
+    // Prototype runs at in_rate * L. Cutoff centred in the transition band
+    // between the passband edge and the output (or input) Nyquist.
+    const double nyq  = 0.5 * std::min(in_rate, out_rate);
+    const double f_lo = RS_PASSBAND * nyq;
+    const double tw   = (nyq - f_lo) / in_rate;          // transition, cycles per input sample
+    const double fc   = 0.5 * (f_lo + nyq) / in_rate;    // cutoff, cycles per input sample
+
+    // Kaiser estimate of the length in input samples
+    int taps = (int) std::ceil((RS_ATTENUATION - 7.95) / (14.36 * tw));
+    taps = std::max(8, (taps + 7) / 8 * 8);
+    if ((size_t) taps * m_L > RS_MAX_COEFFS) return false;
+    m_taps = taps;
+
+    const int    N    = m_taps * m_L;
+    const double beta = 0.1102 * (RS_ATTENUATION - 8.7);
+    const double i0b  = bessel_i0(beta);
+
+    std::vector<double> h(N);
+    const double c = 0.5 * (N - 1);
+    for (int i = 0; i < N; i++) {
+        double x    = (i - c) / m_L;                     // in input samples
+        double sinc = (x == 0.0) ? 2.0 * fc : std::sin(2.0 * M_PI * fc * x) / (M_PI * x);
+        double r    = (i - c) / c;
+        double w    = bessel_i0(beta * std::sqrt(std::max(0.0, 1.0 - r * r))) / i0b;
+        h[i] = sinc * w;
+    }
+
+    // Split into phases; normalise each for unity DC gain
+    m_coeffs.assign((size_t) N, 0.0f);
+    for (int p = 0; p < m_L; p++) {
+        double sum = 0.0;
+        for (int j = 0; j < m_taps; j++) sum += h[p + j * m_L];
+        for (int j = 0; j < m_taps; j++) {
+            m_coeffs[(size_t) p * m_taps + (m_taps - 1 - j)] = (float) (h[p + j * m_L] / sum);
+        }
+    }
+
+    m_buf.reserve(m_taps - 1 + MAX_BLOCK);
+    reset();
+    return true;
+}
+
+void Resampler::reset() {
+    m_buf.assign((size_t) std::max(0, m_taps - 1), 0.0f);
+    m_t = 0;
+}
+
+size_t Resampler::max_output(size_t n_in) const {
+    return (n_in * m_L) / m_M + 1;
+}
+
+size_t Resampler::process(const float * in, size_t n_in, float * out) {
+    n_in = std::min(n_in, MAX_BLOCK);
+    const size_t hist = (size_t) m_taps - 1;
+    m_buf.resize(hist + n_in);  // within reserved capacity: no allocation
+    memcpy(m_buf.data() + hist, in, n_in * sizeof(float));
+
+    // Output k needs input samples [n - taps + 1, n] with n = t / L, which
+    // are m_buf[n .. n + taps - 1] since the block starts after the history
+    size_t n_out = 0;
+    const size_t L = (size_t) m_L;
+    while (true) {
+        size_t n = m_t / L;
+        if (n >= n_in) break;
+        size_t p = m_t % L;
+        out[n_out++] = dot(m_buf.data() + n, m_coeffs.data() + p * m_taps, m_taps);
+        m_t += (size_t) m_M;
+    }
+    m_t -= n_in * L;
+
+    memmove(m_buf.data(), m_buf.data() + n_in, hist * sizeof(float));
+    m_buf.resize(hist);
+    return n_out;
+}
+
+double Resampler::latency_ms() const {
+    if (m_in_rate <= 0) return 0.0;
+    return 1000.0 * 0.5 * (m_taps - 1.0 / m_L) / m_in_rate;
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+// Streaming polyphase FIR resampler for mono float audio (rational L/M).
+//
+// The prototype low-pass is a Kaiser-windowed sinc with ~80 dB stopband
+// that ends at the output Nyquist frequency, so nothing aliases into the
+// passband. The dot products use SSE or NEON where available. process()
+// keeps the filter history between calls and never allocates, so it can
+// run directly in an audio callback.
+class Resampler {
+public:
+    // Returns false if the rates are invalid or the ratio needs an
+    // unreasonably large filter bank.
+    bool init(int in_rate, int out_rate);
+
+    int in_rate()  const { return m_in_rate; }
+    int out_rate() const { return m_out_rate; }
+
+    // Upper bound of output samples produced for n_in input samples
+    size_t max_output(size_t n_in) const;
+
+    // Resample n_in samples (at most max_input() per call) into out, which
+    // must hold max_output(n_in) samples. Returns the number written.
+    size_t process(const float * in, size_t n_in, float * out);
+
+    // Largest n_in accepted by one process() call
+    size_t max_input() const { return MAX_BLOCK; }
+
+    // Clear the filter history
+    void reset();
+
+    int    taps_per_phase() const { return m_taps; }
+    double latency_ms() const;
+
+private:
+    static constexpr size_t MAX_BLOCK = 8192;
+
+    int m_in_rate  = 0;
+    int m_out_rate = 0;
+    int m_L        = 1;  // interpolation factor
+    int m_M        = 1;  // decimation factor
+    int m_taps     = 0;  // input samples per output (multiple of 8)
+
+    std::vector<float> m_coeffs;  // L phases x taps, each reversed for forward dot products
+    std::vector<float> m_buf;     // taps-1 samples of history, then the current block
+    size_t             m_t = 0;   // next output position, in 1/L input samples from the block start
+};
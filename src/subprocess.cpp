@@ -0,0 +1,257 @@
+#include "subprocess.h"
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <spawn.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char ** environ;
+
+#ifndef SYS_pidfd_open
+#define SYS_pidfd_open 434
+#endif
+
+// Poll interval used only when pidfd_open() is unavailable (kernel < 5.3)
+static constexpr int REAP_FALLBACK_POLL_MS = 10;
+
+static void close_fd(int & fd) {
+    if (fd >= 0) {
+        close(fd);
+        fd = -1;
+    }
+}
+
+// pidfd becomes readable when the child exits, so it can sit in the same
+// poll() set as the stdin/stdout pipes. Returns -1 if the kernel lacks it.
+static int open_pidfd(pid_t pid) {
+    return (int) syscall(SYS_pidfd_open, pid, 0);
+}
+
+// Spawn argv with the given fds as stdin/stdout (-1 = inherit, or /dev/null
+// when quiet). stderr always goes to /dev/null. Returns pid, or -1 on error.
+static pid_t spawn(const char * const argv[], int stdin_fd, int stdout_fd, bool quiet) {
+    posix_spawn_file_actions_t fa;
+    posix_spawnattr_t attr;
+    if (posix_spawn_file_actions_init(&fa) != 0) return -1;
+    if (posix_spawnattr_init(&attr) != 0) {
+        posix_spawn_file_actions_destroy(&fa);
+        return -1;
+    }
+
+    if (stdin_fd >= 0) {
+        posix_spawn_file_actions_adddup2(&fa, stdin_fd, STDIN_FILENO);
+    }
+    if (stdout_fd >= 0) {
+        posix_spawn_file_actions_adddup2(&fa, stdout_fd, STDOUT_FILENO);
+    } else if (quiet) {
+        posix_spawn_file_actions_addopen(&fa, STDOUT_FILENO, "/dev/null", O_WRONLY, 0);
+    }
+    posix_spawn_file_actions_addopen(&fa, STDERR_FILENO, "/dev/null", O_WRONLY, 0);
+
+    // Children must not inherit our blocked signals or ignored SIGTSTP
+    sigset_t mask, defaults;
+    sigemptyset(&mask);
+    sigemptyset(&defaults);
+    sigaddset(&defaults, SIGTSTP);
+    sigaddset(&defaults, SIGPIPE);
+    posix_spawnattr_setsigmask(&attr, &mask);
+    posix_spawnattr_setsigdefault(&attr, &defaults);
+    posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETSIGMASK | POSIX_SPAWN_SETSIGDEF);
+
+    pid_t pid = -1;
+    int err = posix_spawnp(&pid, argv[0], &fa, &attr,
+                           const_cast<char * const *>(argv), environ);
+
+    posix_spawnattr_destroy(&attr);
+    posix_spawn_file_actions_destroy(&fa);
+
+    if (err != 0) {
+        errno = err;
+        return -1;
+    }
+    return pid;
+}
+
+int run_cmd(const char * const argv[], int timeout_ms,
+            const std::string * stdin_data,
+            std::string * stdout_data) {
+    int stdin_pipe[2]  = {-1, -1};
+    int stdout_pipe[2] = {-1, -1};
+
+    // O_CLOEXEC: the dup2'd copies in the child are unaffected, but other
+    // concurrently spawned children won't inherit our pipe ends.
+    if (stdin_data) {
+        if (pipe2(stdin_pipe, O_CLOEXEC) < 0) return -1;
+    }
+    if (stdout_data) {
+        if (pipe2(stdout_pipe, O_CLOEXEC) < 0) {
+            close_fd(stdin_pipe[0]);
+            close_fd(stdin_pipe[1]);
+            return -1;
+        }
+    }
+
+    pid_t pid = spawn(argv, stdin_pipe[0], stdout_pipe[1], false);
+    close_fd(stdin_pipe[0]);
+    close_fd(stdout_pipe[1]);
+
+    int in_fd  = stdin_pipe[1];
+    int out_fd = stdout_pipe[0];
+
+    if (pid < 0) {
+        close_fd(in_fd);
+        close_fd(out_fd);
+        return -1;
+    }
+
+    int pidfd = open_pidfd(pid);
+
+    const char * data = stdin_data ? stdin_data->data() : nullptr;
+    size_t remaining  = stdin_data ? stdin_data->size() : 0;
+
+    if (in_fd >= 0) {
+        fcntl(in_fd, F_SETFL, O_NONBLOCK);
+        if (remaining == 0) close_fd(in_fd);  // nothing to send: EOF right away
+    }
+    if (out_fd >= 0) {
+        fcntl(out_fd, F_SETFL, O_NONBLOCK);
+        stdout_data->clear();
+    }
+
+    std::array<char, 4096> buf;
+    auto drain_stdout = [&]() {
+        while (out_fd >= 0) {
+            ssize_t n = read(out_fd, buf.data(), buf.size());
+            if (n > 0) {
+                stdout_data->append(buf.data(), n);
+            } else if (n < 0 && errno == EINTR) {
+                continue;
+            } else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                break;
+            } else {
+                close_fd(out_fd);  // EOF or error
+            }
+        }
+    };
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    int  status   = 0;
+    bool exited   = false;
+    bool failed   = false;
+
+    while (!exited) {
+        auto left_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+            deadline - std::chrono::steady_clock::now()).count();
+        if (left_ms <= 0) break;
+
+        struct pollfd pfds[3];
+        nfds_t nfds = 0;
+        int i_in = -1, i_out = -1, i_pid = -1;
+        if (in_fd >= 0)  { i_in  = (int) nfds; pfds[nfds++] = {in_fd,  POLLOUT, 0}; }
+        if (out_fd >= 0) { i_out = (int) nfds; pfds[nfds++] = {out_fd, POLLIN,  0}; }
+        if (pidfd >= 0)  { i_pid = (int) nfds; pfds[nfds++] = {pidfd,  POLLIN,  0}; }
+
+        int wait_ms = (int) left_ms;
+        if (pidfd < 0) wait_ms = std::min(wait_ms, REAP_FALLBACK_POLL_MS);
+
+        int ret = poll(pfds, nfds, wait_ms);
+        if (ret < 0) {
+            if (errno == EINTR) continue;
+            failed = true;
+            break;
+        }
+
+        if (i_in >= 0 && pfds[i_in].revents) {
+            if (pfds[i_in].revents & (POLLERR | POLLHUP)) {
+                close_fd(in_fd);  // child closed its stdin early
+            } else {
+                ssize_t written = write(in_fd, data, remaining);
+                if (written > 0) {
+                    data      += written;
+                    remaining -= written;
+                    if (remaining == 0) close_fd(in_fd);
+                } else if (written < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                    close_fd(in_fd);
+                }
+            }
+        }
+
+        if (i_out >= 0 && pfds[i_out].revents) {
+            drain_stdout();
+        }
+
+        if (pidfd < 0 || (i_pid >= 0 && pfds[i_pid].revents)) {
+            pid_t r = waitpid(pid, &status, WNOHANG);
+            if (r == pid) {
+                exited = true;
+            } else if (r < 0 && errno != EINTR) {
+                failed = true;
+                break;
+            }
+        }
+    }
+
+    if (exited) {
+        // Everything the child wrote is already in the pipe; don't wait on
+        // EOF, which a backgrounded grandchild (e.g. xclip) may hold open.
+        drain_stdout();
+    } else {
+        kill(pid, SIGKILL);
+        while (waitpid(pid, &status, 0) < 0 && errno == EINTR) {}
+        if (!failed) {
+            fprintf(stderr, "subprocess: command timed out after %d ms: %s\n", timeout_ms, argv[0]);
+        }
+    }
+
+    close_fd(in_fd);
+    close_fd(out_fd);
+    close_fd(pidfd);
+
+    if (!exited) return -1;
+    return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+
+bool spawn_detached(const char * const argv[], const std::string * stdin_data) {
+    int stdin_pipe[2] = {-1, -1};
+    if (stdin_data) {
+        if (pipe2(stdin_pipe, O_CLOEXEC) < 0) return false;
+    }
+
+    pid_t pid = spawn(argv, stdin_pipe[0], -1, true);
+    close_fd(stdin_pipe[0]);
+
+    if (pid < 0) {
+        close_fd(stdin_pipe[1]);
+        return false;
+    }
+
+    if (stdin_data) {
+        const char * data = stdin_data->data();
+        size_t remaining  = stdin_data->size();
+        while (remaining > 0) {
+            ssize_t n = write(stdin_pipe[1], data, remaining);
+            if (n > 0) { data += n; remaining -= n; }
+            else if (n < 0 && errno == EINTR) continue;
+            else break;
+        }
+        close_fd(stdin_pipe[1]);
+    }
+
+    // Reap on a short-lived thread instead of double-forking
+    std::thread([pid]() {
+        int status;
+        while (waitpid(pid, &status, 0) < 0 && errno == EINTR) {}
+    }).detach();
+
+    return true;
+}
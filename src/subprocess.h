@@ -0,0 +1,25 @@
+#pragma once
+
+#include <string>
+
+// Subprocess helpers built on posix_spawn (no shell, no fork of the parent).
+//
+// glibc implements posix_spawn with clone(CLONE_VM | CLONE_VFORK), so the
+// child never copies the parent's page tables. Spawn cost therefore does not
+// grow with the size of the loaded whisper model.
+
+// Run a command with explicit argv (PATH lookup, no shell involved).
+// Optionally writes stdin_data to the child's stdin and captures the child's
+// stdout into stdout_data. Stdin, stdout and child exit are multiplexed in a
+// single poll() loop (via pidfd) against one deadline covering the whole call.
+// Returns child exit status, or -1 on error/timeout.
+int run_cmd(const char * const argv[], int timeout_ms,
+            const std::string * stdin_data = nullptr,
+            std::string * stdout_data = nullptr);
+
+// Fire-and-forget: launch a command with stdout/stderr sent to /dev/null,
+// optionally feeding stdin_data to its stdin. The child is reaped in the
+// background so it never lingers as a zombie.
+// Returns false if the command could not be started.
+bool spawn_detached(const char * const argv[],
+                    const std::string * stdin_data = nullptr);
@@ -1,4 +1,5 @@
 #include "text-output.h"
+#include "subprocess.h"
 
 #include <cstdio>
 #include <cstdlib>
@@ -9,15 +10,8 @@
 #include <sstream>
 #include <thread>
 #include <chrono>
-#include <array>
 #include <vector>
 
-#include <unistd.h>
-#include <fcntl.h>
-#include <sys/wait.h>
-#include <signal.h>
-#include <errno.h>
-
 // Timeout for subprocess calls (xclip, xdotool, wtype, wl-copy)
 static constexpr int CMD_TIMEOUT_MS = 5000;
 
@@ -27,6 +21,25 @@ static constexpr int CLIPBOARD_SET_DELAY_MS = 50;
 // Delay after paste before restoring the original clipboard
 static constexpr int CLIPBOARD_RESTORE_DELAY_MS = 300;
 
+// Longest text verified by reading it back (adaptive pacing)
+static constexpr size_t READBACK_MAX_CHARS = 200;
+
+// Time for the target to handle the last synthesized keys before reading back
+static constexpr int READBACK_SETTLE_MS = 50;
+
+static void strip_newlines(std::string & s) {
+    while (!s.empty() && (s.back() == '\n' || s.back() == '\r')) s.pop_back();
+}
+
+// Characters (not bytes): what shift+Left steps over
+static size_t utf8_length(const std::string & s) {
+    size_t n = 0;
+    for (unsigned char c : s) {
+        if ((c & 0xC0) != 0x80) n++;
+    }
+    return n;
+}
+
 DisplayBackend detect_display_backend() {
     if (getenv("WAYLAND_DISPLAY")) return DisplayBackend::WAYLAND;
     if (getenv("DISPLAY"))         return DisplayBackend::X11;
@@ -52,14 +65,65 @@ void TextOutput::set_allow_wtype(bool allow) {
     m_allow_wtype = allow;
 }
 
+void TextOutput::set_hybrid(bool hybrid) {
+    m_hybrid = hybrid;
+}
+
+void TextOutput::set_adaptive_pacing(const std::string & state_path) {
+    m_adaptive    = true;
+    m_pacing_path = state_path;
+    if (m_pacing.load(state_path)) {
+        fprintf(stderr, "text-output: loaded typing delays for %zu window classes\n", m_pacing.profiles().size());
+    }
+}
+
 bool TextOutput::init_libei() {
     return m_libei.init();
 }
 
+bool TextOutput::init_atspi(bool insert) {
+    m_atspi_insert = insert;
+    return m_atspi.init();
+}
+
+void TextOutput::set_profile(const AppProfile * profile) {
+    if (profile) m_profile = *profile;
+    else         m_profile.reset();
+}
+
+std::string TextOutput::focused_class() {
+    if (m_backend == DisplayBackend::X11) return window_class(active_window_id());
+    return m_atspi.focused_app();
+}
+
+int TextOutput::delay_for(const std::string & cls) const {
+    if (m_profile && m_profile->type_delay_ms >= 0) return m_profile->type_delay_ms;
+    return m_adaptive ? m_pacing.delay_for(cls, m_type_delay_ms) : m_type_delay_ms;
+}
+
 bool TextOutput::type(const std::string & text) {
     if (text.empty()) return true;
 
+    // Accessible widgets take the text directly, on either display server,
+    // unless the target needs a paste (multi-line text into a terminal,
+    // where an inserted newline would run the line). Single-line text
+    // skips the window class lookup.
+    if (m_atspi_insert && m_atspi.is_initialized()) {
+        bool paste_only = false;
+        if (text.find('\n') != std::string::npos) {
+            const std::string cls = focused_class();
+            paste_only = output_target_for(cls, is_terminal_class(cls), false, text) ==
+                         OutputCostModel::Target::PASTE_ONLY;
+        }
+        if (!paste_only && m_atspi.insert(text)) return true;
+    }
+
     if (m_backend == DisplayBackend::WAYLAND) {
+        if (m_profile && m_profile->output == ProfileOutput::PASTE && !m_profile_paste_warned) {
+            fprintf(stderr, "text-output: profile '%s': output=paste needs X11, typing instead\n",
+                    m_profile->name.c_str());
+            m_profile_paste_warned = true;
+        }
         // Primary: libei (compositor-mediated, secure)
         if (m_libei.is_initialized()) {
             if (type_libei(text)) return true;
@@ -73,124 +137,79 @@ bool TextOutput::type(const std::string & text) {
     }
 
     // X11 path
-    if (m_use_clipboard) {
-        return type_clipboard(text);
-    } else {
-        return type_xdotool(text);
-    }
-}
-
-bool TextOutput::type_libei(const std::string & text) {
-    return m_libei.type_text(text, m_type_delay_ms);
-}
-
-// Run a command with explicit argv (no shell involved).
-// Optionally writes stdin_data to the child's stdin.
-// Optionally captures child's stdout into stdout_data.
-// Returns child exit status, or -1 on error/timeout.
-int TextOutput::run_cmd(const char * const argv[], int timeout_ms,
-                        const std::string * stdin_data,
-                        std::string * stdout_data) {
-    int stdin_pipe[2]  = {-1, -1};
-    int stdout_pipe[2] = {-1, -1};
-
-    if (stdin_data) {
-        if (pipe(stdin_pipe) < 0) return -1;
+    if (m_profile && m_profile->output != ProfileOutput::DEFAULT) {
+        const std::string window_id = active_window_id();
+        if (m_profile->output == ProfileOutput::PASTE) return type_clipboard(text, window_id);
+        return type_xdotool(text, window_class(window_id));
     }
-    if (stdout_data) {
-        if (pipe(stdout_pipe) < 0) {
-            if (stdin_data) { close(stdin_pipe[0]); close(stdin_pipe[1]); }
-            return -1;
-        }
+    if (m_hybrid) {
+        return type_hybrid(text);
     }
-
-    pid_t pid = fork();
-    if (pid < 0) {
-        if (stdin_data)  { close(stdin_pipe[0]); close(stdin_pipe[1]); }
-        if (stdout_data) { close(stdout_pipe[0]); close(stdout_pipe[1]); }
-        return -1;
+    if (m_use_clipboard) {
+        return type_clipboard(text, active_window_id());
     }
+    std::string cls;
+    if (m_adaptive) cls = window_class(active_window_id());
+    return type_xdotool(text, cls);
+}
 
-    if (pid == 0) {
-        // Child process
-        if (stdin_data) {
-            close(stdin_pipe[1]);
-            dup2(stdin_pipe[0], STDIN_FILENO);
-            close(stdin_pipe[0]);
-        }
-        if (stdout_data) {
-            close(stdout_pipe[0]);
-            dup2(stdout_pipe[1], STDOUT_FILENO);
-            close(stdout_pipe[1]);
+bool TextOutput::press_enter() {
+    if (m_backend == DisplayBackend::WAYLAND) {
+        if (m_libei.is_initialized() && m_libei.type_text("\n", 0)) return true;
+        if (!m_allow_wtype) {
+            fprintf(stderr, "text-output: no Wayland typing backend available\n");
+            return false;
         }
-        // Suppress stderr from child commands
-        int devnull = open("/dev/null", O_WRONLY);
-        if (devnull >= 0) {
-            dup2(devnull, STDERR_FILENO);
-            close(devnull);
+        const char * argv[] = { "wtype", "-k", "Return", nullptr };
+        int ret = run_cmd(argv, CMD_TIMEOUT_MS);
+        if (ret != 0) {
+            fprintf(stderr, "text-output: wtype failed (exit %d)\n", ret);
+            return false;
         }
-
-        execvp(argv[0], const_cast<char * const *>(argv));
-        _exit(127);
+        return true;
     }
 
-    // Parent process
-    if (stdin_data) {
-        close(stdin_pipe[0]);
-        // Set write end to non-blocking for timeout support
-        fcntl(stdin_pipe[1], F_SETFL, O_NONBLOCK);
-        auto write_deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
-        const char * data = stdin_data->c_str();
-        size_t remaining = stdin_data->size();
-        while (remaining > 0) {
-            ssize_t written = write(stdin_pipe[1], data, remaining);
-            if (written > 0) {
-                data += written;
-                remaining -= written;
-            } else if (written < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
-                if (std::chrono::steady_clock::now() >= write_deadline) break;
-                usleep(1000);
-            } else {
-                break;
-            }
-        }
-        close(stdin_pipe[1]);
+    const char * argv[] = { "xdotool", "key", "--clearmodifiers", "Return", nullptr };
+    int ret = run_cmd(argv, CMD_TIMEOUT_MS);
+    if (ret != 0) {
+        fprintf(stderr, "text-output: xdotool key failed (exit %d)\n", ret);
+        return false;
     }
+    return true;
+}
 
-    if (stdout_data) {
-        close(stdout_pipe[1]);
-        stdout_data->clear();
-        std::array<char, 4096> buf;
-        while (true) {
-            ssize_t n = read(stdout_pipe[0], buf.data(), buf.size());
-            if (n <= 0) break;
-            stdout_data->append(buf.data(), n);
-        }
-        close(stdout_pipe[0]);
+// Pick typing or paste for this transcript, and feed the measured time
+// back into the cost model
+bool TextOutput::type_hybrid(const std::string & text) {
+    const std::string window_id = active_window_id();
+    const std::string cls       = window_class(window_id);
+    const int    delay_ms = delay_for(cls);
+    const size_t n_chars  = utf8_length(text);
+
+    const auto target = output_target_for(cls, is_terminal_class(cls), m_atspi.focused_is_password(), text);
+    const auto d      = m_cost.choose(n_chars, delay_ms, target);
+    fprintf(stderr, "text-output: %zu chars to '%s' -> %s (type ~%.0f ms, paste ~%.0f ms%s)\n",
+            n_chars, cls.c_str(), OutputCostModel::method_name(d.method), d.type_ms, d.paste_ms,
+            target == OutputCostModel::Target::ANY ? "" : ", forced by target");
+
+    if (d.method == OutputCostModel::Method::TYPE) {
+        if (!type_xdotool(text, cls)) return false;
+        m_cost.record_type(n_chars, delay_ms, m_last_type_ms);
+        return true;
     }
 
-    // Wait for child with timeout
-    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
-    while (true) {
-        int status;
-        pid_t ret = waitpid(pid, &status, WNOHANG);
-        if (ret == pid) {
-            return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
-        }
-        if (ret < 0) return -1;
+    const auto t0 = std::chrono::steady_clock::now();
+    if (!type_clipboard(text, window_id)) return false;
+    m_cost.record_paste(std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - t0).count());
+    return true;
+}
 
-        if (std::chrono::steady_clock::now() >= deadline) {
-            kill(pid, SIGKILL);
-            waitpid(pid, &status, 0);
-            fprintf(stderr, "text-output: command timed out after %d ms: %s\n", timeout_ms, argv[0]);
-            return -1;
-        }
-        usleep(10000); // 10ms poll interval
-    }
+bool TextOutput::type_libei(const std::string & text) {
+    return m_libei.type_text(text, delay_for(""));
 }
 
 bool TextOutput::type_wtype(const std::string & text) {
-    std::string delay_str = std::to_string(m_type_delay_ms);
+    std::string delay_str = std::to_string(delay_for(""));
     const char * argv[] = {
         "wtype", "--delay", delay_str.c_str(),
         "--", text.c_str(), nullptr
@@ -204,23 +223,89 @@ bool TextOutput::type_wtype(const std::string & text) {
     return true;
 }
 
-bool TextOutput::type_xdotool(const std::string & text) {
-    std::string delay_str = std::to_string(m_type_delay_ms);
+bool TextOutput::type_xdotool(const std::string & text, const std::string & cls) {
+    const int delay_ms = delay_for(cls);
+
+    std::string delay_str = std::to_string(delay_ms);
     const char * argv[] = {
         "xdotool", "type", "--clearmodifiers",
         "--delay", delay_str.c_str(),
         "--", text.c_str(), nullptr
     };
 
+    // A profile's fixed delay is not learned from. Terminals redraw the
+    // prompt line, so their caret does not follow the typed text.
+    const bool fixed = m_profile && m_profile->type_delay_ms >= 0;
+    const bool learn = m_adaptive && !fixed && !is_terminal_class(cls);
+    int caret_before = -1;
+    if (learn) {
+        std::string unused;
+        if (!m_atspi.text_before_caret(0, caret_before, unused)) caret_before = -1;
+    }
+
+    const auto t0 = std::chrono::steady_clock::now();
     int ret = run_cmd(argv, CMD_TIMEOUT_MS);
     if (ret != 0) {
         fprintf(stderr, "text-output: xdotool type failed (exit %d)\n", ret);
         return false;
     }
+    m_last_type_ms = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - t0).count();
+
+    if (learn) learn_pacing(cls, readback_atspi(text, caret_before));
     return true;
 }
 
-bool TextOutput::type_clipboard(const std::string & text) {
+// Read the text before the caret over AT-SPI and compare it with what was
+// typed. Nothing in the target changes. No verdict when the widget exposes
+// no text or the caret moved by more than was typed (the user typed too).
+TextOutput::Readback TextOutput::readback_atspi(const std::string & text, int caret_before) {
+    const size_t n = utf8_length(text);
+    if (n == 0 || n > READBACK_MAX_CHARS || caret_before < 0) return Readback::UNKNOWN;
+
+    // xdotool returns once the events are sent, not when they are handled
+    std::this_thread::sleep_for(std::chrono::milliseconds(READBACK_SETTLE_MS));
+
+    int caret = 0;
+    std::string got;
+    if (!m_atspi.text_before_caret(n, caret, got)) return Readback::UNKNOWN;
+
+    const int moved = caret - caret_before;
+    if (moved < (int) n) return Readback::DROPPED;
+    if (moved > (int) n) return Readback::UNKNOWN;
+    return got == text ? Readback::OK : Readback::DROPPED;
+}
+
+void TextOutput::learn_pacing(const std::string & cls, Readback rb) {
+    if (rb == Readback::UNKNOWN || cls.empty()) return;
+    int before = m_pacing.delay_for(cls, m_type_delay_ms);
+    int after  = m_pacing.report(cls, rb == Readback::OK, m_type_delay_ms);
+    if (after != before) {
+        fprintf(stderr, "text-output: %s, typing delay for '%s' %d -> %d ms\n",
+                rb == Readback::OK ? "no drops" : "dropped keys", cls.c_str(), before, after);
+    }
+    if (!m_pacing_path.empty() && m_pacing.dirty() && !m_pacing.save(m_pacing_path)) {
+        fprintf(stderr, "text-output: warning: cannot save typing delays to %s\n", m_pacing_path.c_str());
+    }
+}
+
+std::string TextOutput::active_window_id() {
+    std::string window_id;
+    const char * argv[] = {"xdotool", "getactivewindow", nullptr};
+    if (run_cmd(argv, CMD_TIMEOUT_MS, nullptr, &window_id) != 0) return "";
+    strip_newlines(window_id);
+    return window_id;
+}
+
+std::string TextOutput::window_class(const std::string & window_id) {
+    if (window_id.empty()) return "";
+    std::string cls;
+    const char * argv[] = {"xdotool", "getwindowclassname", window_id.c_str(), nullptr};
+    if (run_cmd(argv, CMD_TIMEOUT_MS, nullptr, &cls) != 0) return "";
+    strip_newlines(cls);
+    return cls;
+}
+
+bool TextOutput::type_clipboard(const std::string & text, const std::string & window_id) {
     // 1. Save current clipboard
     std::string saved_clipboard;
     {
@@ -242,53 +327,26 @@ bool TextOutput::type_clipboard(const std::string & text) {
     // 3. Small delay to ensure clipboard is set
     std::this_thread::sleep_for(std::chrono::milliseconds(CLIPBOARD_SET_DELAY_MS));
 
-    // 4. Get active window ID once and use it for both terminal check and paste
-    std::string window_id;
-    {
-        const char * argv[] = {"xdotool", "getactivewindow", nullptr};
-        int ret = run_cmd(argv, CMD_TIMEOUT_MS, nullptr, &window_id);
-        if (ret != 0) {
-            // Fallback: paste without window targeting
-            window_id.clear();
-        }
-        // Strip trailing newline
-        while (!window_id.empty() && (window_id.back() == '\n' || window_id.back() == '\r')) {
-            window_id.pop_back();
-        }
-    }
-
-    // 5. Check if the target window is a terminal
-    bool is_terminal = false;
-    if (!window_id.empty()) {
-        std::string window_class;
-        const char * argv[] = {"xdotool", "getwindowclassname", window_id.c_str(), nullptr};
-        int ret = run_cmd(argv, CMD_TIMEOUT_MS, nullptr, &window_class);
-        if (ret == 0) {
-            while (!window_class.empty() && (window_class.back() == '\n' || window_class.back() == '\r')) {
-                window_class.pop_back();
-            }
-            is_terminal = is_terminal_class(window_class);
-        }
+    // 4. Paste shortcut: the profile's, else ctrl+shift+v for terminals
+    //    (empty window_id: paste without window targeting)
+    std::string paste_key;
+    if (m_profile && !m_profile->paste_key.empty()) {
+        paste_key = m_profile->paste_key;
+    } else {
+        bool is_terminal = !window_id.empty() && is_terminal_class(window_class(window_id));
+        paste_key = is_terminal ? "ctrl+shift+v" : "ctrl+v";
     }
 
-    // 6. Send paste keystroke to the specific window
+    // 5. Send paste keystroke to the specific window
     int paste_ret;
     if (!window_id.empty()) {
-        if (is_terminal) {
-            const char * argv[] = {"xdotool", "key", "--clearmodifiers",
-                                   "--window", window_id.c_str(),
-                                   "ctrl+shift+v", nullptr};
-            paste_ret = run_cmd(argv, CMD_TIMEOUT_MS);
-        } else {
-            const char * argv[] = {"xdotool", "key", "--clearmodifiers",
-                                   "--window", window_id.c_str(),
-                                   "ctrl+v", nullptr};
-            paste_ret = run_cmd(argv, CMD_TIMEOUT_MS);
-        }
+        const char * argv[] = {"xdotool", "key", "--clearmodifiers",
+                               "--window", window_id.c_str(),
+                               paste_key.c_str(), nullptr};
+        paste_ret = run_cmd(argv, CMD_TIMEOUT_MS);
     } else {
         // Fallback: no window targeting
-        const char * paste_key = is_terminal ? "ctrl+shift+v" : "ctrl+v";
-        const char * argv[] = {"xdotool", "key", "--clearmodifiers", paste_key, nullptr};
+        const char * argv[] = {"xdotool", "key", "--clearmodifiers", paste_key.c_str(), nullptr};
         paste_ret = run_cmd(argv, CMD_TIMEOUT_MS);
     }
 
@@ -296,7 +354,7 @@ bool TextOutput::type_clipboard(const std::string & text) {
         fprintf(stderr, "text-output: paste simulation failed (exit %d)\n", paste_ret);
     }
 
-    // 7. Wait for paste to be processed, then restore original clipboard
+    // 6. Wait for paste to be processed, then restore original clipboard
     std::this_thread::sleep_for(std::chrono::milliseconds(CLIPBOARD_RESTORE_DELAY_MS));
 
     {
@@ -1,7 +1,12 @@
 #pragma once
 
+#include <optional>
 #include <string>
+#include "atspi.h"
 #include "libei-kbd.h"
+#include "output_cost.h"
+#include "pacing.h"
+#include "profile.h"
 
 enum class DisplayBackend { X11, WAYLAND, UNKNOWN };
 
@@ -21,13 +26,44 @@ public:
     void set_backend(DisplayBackend backend);
     void set_allow_wtype(bool allow);
 
+    // X11: choose keystrokes or clipboard paste per transcript, whichever
+    // the cost model expects to finish first for its length and target
+    // window. Overrides use_clipboard.
+    void set_hybrid(bool hybrid);
+
+    // Learn the typing delay per window class instead of using
+    // type_delay_ms: typed text is read back and the class's delay backs
+    // off when keys were dropped. Learned delays are kept in state_path.
+    // Read-back needs X11 keystroke typing (no clipboard mode, or
+    // transcripts the hybrid mode types) and a widget that exposes its
+    // text over AT-SPI; other targets keep their current delay.
+    void set_adaptive_pacing(const std::string & state_path);
+
     // Initialize the libei keyboard (Wayland only, compositor-mediated).
     // Blocks up to 30s for portal consent dialog.
     bool init_libei();
 
+    // Connect to the accessibility bus. With insert, text afterwards goes
+    // straight into the focused widget when it is editable through AT-SPI,
+    // and the other backends are only the fallback. Without, the bus is
+    // only used to read typed text back for adaptive pacing.
+    bool init_atspi(bool insert = true);
+
+    // Output overrides (method, paste key, keystroke delay) from the
+    // focused application's profile, until cleared with nullptr
+    void set_profile(const AppProfile * profile);
+
+    // Class of the focused window for profile lookup: WM_CLASS on X11, the
+    // application name from AT-SPI otherwise. Empty if unknown.
+    std::string focused_class();
+
     // Type text into the currently focused window
     bool type(const std::string & text);
 
+    // Press Enter in the focused window (keystroke backends only; AT-SPI
+    // insertion cannot submit)
+    bool press_enter();
+
 private:
     bool           m_use_clipboard = true;
     int            m_type_delay_ms = 12;
@@ -35,21 +71,41 @@ private:
     bool           m_allow_wtype   = false;
 
     LibeiKbd       m_libei;
+    AtspiText      m_atspi;
+    bool           m_atspi_insert = false;
+
+    bool            m_hybrid       = false;
+    OutputCostModel m_cost;
+    float           m_last_type_ms = 0.0f;  // duration of the last xdotool type run
+
+    bool           m_adaptive = false;
+    PacingTable    m_pacing;
+    std::string    m_pacing_path;
+
+    std::optional<AppProfile> m_profile;
+    bool                      m_profile_paste_warned = false;  // paste profile on Wayland, logged once
+
+    // Keystroke delay for a window class: profile, learned or global
+    int delay_for(const std::string & cls) const;
+
+    // Outcome of reading typed text back from the target
+    enum class Readback { OK, DROPPED, UNKNOWN };
+    Readback readback_atspi(const std::string & text, int caret_before);
+    void     learn_pacing(const std::string & cls, Readback rb);
 
     // X11 backends
-    bool type_xdotool(const std::string & text);
-    bool type_clipboard(const std::string & text);
+    bool type_hybrid(const std::string & text);
+    bool type_xdotool(const std::string & text, const std::string & cls);
+    bool type_clipboard(const std::string & text, const std::string & window_id);
 
     // Wayland backends
     bool type_libei(const std::string & text);
     bool type_wtype(const std::string & text);
 
+    // Focused X11 window and its class (empty if unavailable)
+    static std::string active_window_id();
+    static std::string window_class(const std::string & window_id);
+
     // Check if a window class name is a known terminal
     static bool is_terminal_class(const std::string & cls);
-
-    // Run a command with argv, optional stdin, optional stdout capture, with timeout
-    // Returns exit status, or -1 on error/timeout
-    static int run_cmd(const char * const argv[], int timeout_ms,
-                       const std::string * stdin_data = nullptr,
-                       std::string * stdout_data = nullptr);
 };
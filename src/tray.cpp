@@ -1,15 +1,115 @@
 #include "tray.h"
 
+#include <atomic>
+#include <condition_variable>
 #include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
 
-#include <libayatana-appindicator/app-indicator.h>
-#include <gtk/gtk.h>
+#include <gio/gio.h>
+#include <unistd.h>
+
+// Longest live-transcript tail shown in the tooltip
+static constexpr size_t TOOLTIP_MAX_CHARS = 80;
+
+// Upper bound for calls to the bus daemon and the tray host
+static constexpr int TRAY_CALL_TIMEOUT_MS = 2000;
+
+static constexpr const char * ITEM_PATH = "/StatusNotifierItem";
+static constexpr const char * MENU_PATH = "/MenuBar";
+static constexpr const char * TITLE     = "Whisper Typer";
+
+static const char * const INTROSPECTION_XML =
+    "<node>"
+    "  <interface name='org.kde.StatusNotifierItem'>"
+    "    <property name='Category' type='s' access='read'/>"
+    "    <property name='Id' type='s' access='read'/>"
+    "    <property name='Title' type='s' access='read'/>"
+    "    <property name='Status' type='s' access='read'/>"
+    "    <property name='IconName' type='s' access='read'/>"
+    "    <property name='ToolTip' type='(sa(iiay)ss)' access='read'/>"
+    "    <property name='ItemIsMenu' type='b' access='read'/>"
+    "    <property name='Menu' type='o' access='read'/>"
+    "    <method name='Activate'><arg type='i' direction='in'/><arg type='i' direction='in'/></method>"
+    "    <method name='SecondaryActivate'><arg type='i' direction='in'/><arg type='i' direction='in'/></method>"
+    "    <method name='ContextMenu'><arg type='i' direction='in'/><arg type='i' direction='in'/></method>"
+    "    <method name='Scroll'><arg type='i' direction='in'/><arg type='s' direction='in'/></method>"
+    "    <signal name='NewIcon'/>"
+    "    <signal name='NewToolTip'/>"
+    "  </interface>"
+    "  <interface name='com.canonical.dbusmenu'>"
+    "    <property name='Version' type='u' access='read'/>"
+    "    <property name='TextDirection' type='s' access='read'/>"
+    "    <property name='Status' type='s' access='read'/>"
+    "    <property name='IconThemePath' type='as' access='read'/>"
+    "    <method name='GetLayout'>"
+    "      <arg type='i' direction='in'/><arg type='i' direction='in'/><arg type='as' direction='in'/>"
+    "      <arg type='u' direction='out'/><arg type='(ia{sv}av)' direction='out'/>"
+    "    </method>"
+    "    <method name='GetGroupProperties'>"
+    "      <arg type='ai' direction='in'/><arg type='as' direction='in'/>"
+    "      <arg type='a(ia{sv})' direction='out'/>"
+    "    </method>"
+    "    <method name='GetProperty'>"
+    "      <arg type='i' direction='in'/><arg type='s' direction='in'/><arg type='v' direction='out'/>"
+    "    </method>"
+    "    <method name='Event'>"
+    "      <arg type='i' direction='in'/><arg type='s' direction='in'/>"
+    "      <arg type='v' direction='in'/><arg type='u' direction='in'/>"
+    "    </method>"
+    "    <method name='EventGroup'>"
+    "      <arg type='a(isvu)' direction='in'/><arg type='ai' direction='out'/>"
+    "    </method>"
+    "    <method name='AboutToShow'><arg type='i' direction='in'/><arg type='b' direction='out'/></method>"
+    "    <method name='AboutToShowGroup'>"
+    "      <arg type='ai' direction='in'/><arg type='ai' direction='out'/><arg type='ai' direction='out'/>"
+    "    </method>"
+    "    <signal name='LayoutUpdated'><arg type='u'/><arg type='i'/></signal>"
+    "  </interface>"
+    "</node>";
+
+// The menu never changes, so its layout has a single revision
+enum MenuId { MENU_ROOT = 0, MENU_SHOW = 1, MENU_SEPARATOR = 2, MENU_QUIT = 3 };
+
+struct MenuItem {
+    int          id;
+    const char * label;  // nullptr for a separator
+};
+
+static const MenuItem MENU_ITEMS[] = {
+    { MENU_SHOW,      "Show Window" },
+    { MENU_SEPARATOR, nullptr       },
+    { MENU_QUIT,      "Quit"        },
+};
 
 struct TrayIconImpl {
-    AppIndicator * indicator = nullptr;
-    GtkWidget    * menu      = nullptr;
-    TrayCallbacks  callbacks;
-    TrayState      state = TrayState::IDLE;
+    GDBusConnection * conn    = nullptr;  // private session bus connection
+    GMainContext *    context = nullptr;
+    GMainLoop *       loop    = nullptr;
+    GDBusNodeInfo *   node    = nullptr;
+    std::string       bus_name;
+    TrayCallbacks     callbacks;
+    std::thread       worker;
+
+    // Loop thread only
+    guint       item_reg    = 0;
+    guint       menu_reg    = 0;
+    guint       watcher     = 0;
+    TrayState   state       = TrayState::IDLE;
+    std::string tooltip;
+
+    // Mailbox from the main thread: written with a store / exchange, taken
+    // by the loop thread, which is woken at most once per batch
+    std::atomic<int>           pending_state{-1};  // TrayState, or -1
+    std::atomic<std::string *> pending_tooltip{nullptr};
+    std::atomic<bool>          wake_posted{false};
+
+    // Startup handshake with the loop thread
+    std::mutex              mutex;
+    std::condition_variable cv;
+    bool                    ready = false;
 };
 
 static const char * state_icon(TrayState s) {
@@ -21,73 +121,351 @@ static const char * state_icon(TrayState s) {
     return "audio-input-microphone";
 }
 
-static void on_show_window(GtkMenuItem * /*item*/, gpointer data) {
-    auto * impl = static_cast<TrayIconImpl *>(data);
-    if (impl->callbacks.on_show_window) impl->callbacks.on_show_window();
+static const char * state_label(TrayState s) {
+    switch (s) {
+        case TrayState::IDLE:         return "Ready";
+        case TrayState::RECORDING:    return "Recording...";
+        case TrayState::TRANSCRIBING: return "Transcribing...";
+    }
+    return "";
 }
 
-static void on_quit(GtkMenuItem * /*item*/, gpointer data) {
-    auto * impl = static_cast<TrayIconImpl *>(data);
-    if (impl->callbacks.on_quit) impl->callbacks.on_quit();
+static void emit(TrayIconImpl * impl, const char * iface, const char * path, const char * signal, GVariant * args) {
+    g_dbus_connection_emit_signal(impl->conn, nullptr, path, iface, signal, args, nullptr);
 }
 
-TrayIcon::TrayIcon() = default;
-TrayIcon::~TrayIcon() { shutdown(); }
+// --- StatusNotifierItem ---
 
-bool TrayIcon::init(const TrayCallbacks & cb) {
-    m_impl = std::make_unique<TrayIconImpl>();
-    m_impl->callbacks = cb;
+static GVariant * item_tooltip(TrayIconImpl * impl) {
+    GVariantBuilder pixmaps;
+    g_variant_builder_init(&pixmaps, G_VARIANT_TYPE("a(iiay)"));
+    const std::string body = impl->tooltip.empty() ? state_label(impl->state) : impl->tooltip;
+    return g_variant_new("(sa(iiay)ss)", "", &pixmaps, TITLE, body.c_str());
+}
 
-    if (!gtk_init_check(nullptr, nullptr)) {
-        fprintf(stderr, "warning: gtk_init_check failed, tray disabled\n");
-        return false;
+static GVariant * item_get_property(GDBusConnection * /*conn*/, const gchar * /*sender*/, const gchar * /*path*/,
+                                    const gchar * /*iface*/, const gchar * name, GError ** /*err*/,
+                                    gpointer user_data) {
+    auto * impl = static_cast<TrayIconImpl *>(user_data);
+    if (strcmp(name, "Category") == 0)   return g_variant_new_string("ApplicationStatus");
+    if (strcmp(name, "Id") == 0)         return g_variant_new_string("whisper-typer");
+    if (strcmp(name, "Title") == 0)      return g_variant_new_string(TITLE);
+    if (strcmp(name, "Status") == 0)     return g_variant_new_string("Active");
+    if (strcmp(name, "IconName") == 0)   return g_variant_new_string(state_icon(impl->state));
+    if (strcmp(name, "ToolTip") == 0)    return item_tooltip(impl);
+    if (strcmp(name, "ItemIsMenu") == 0) return g_variant_new_boolean(TRUE);
+    if (strcmp(name, "Menu") == 0)       return g_variant_new_object_path(MENU_PATH);
+    return nullptr;
+}
+
+static void item_method_call(GDBusConnection * /*conn*/, const gchar * /*sender*/, const gchar * /*path*/,
+                             const gchar * /*iface*/, const gchar * method, GVariant * /*params*/,
+                             GDBusMethodInvocation * invocation, gpointer user_data) {
+    auto * impl = static_cast<TrayIconImpl *>(user_data);
+    // Hosts that ignore ItemIsMenu send left clicks here
+    if (strcmp(method, "Activate") == 0 && impl->callbacks.on_show_window) {
+        impl->callbacks.on_show_window();
     }
+    g_dbus_method_invocation_return_value(invocation, nullptr);
+}
 
-    m_impl->indicator = app_indicator_new(
-        "whisper-typer",
-        "audio-input-microphone",
-        APP_INDICATOR_CATEGORY_APPLICATION_STATUS
-    );
-    if (!m_impl->indicator) {
-        fprintf(stderr, "warning: app_indicator_new failed, tray disabled\n");
-        return false;
+// --- com.canonical.dbusmenu ---
+
+static const MenuItem * find_item(TrayIconImpl * impl, int id) {
+    for (const auto & item : MENU_ITEMS) {
+        if (item.id != id) continue;
+        if (id == MENU_SHOW && !impl->callbacks.on_show_window) return nullptr;
+        return &item;
     }
+    return nullptr;
+}
 
-    app_indicator_set_status(m_impl->indicator, APP_INDICATOR_STATUS_ACTIVE);
-    app_indicator_set_title(m_impl->indicator, "Whisper Typer");
+static GVariant * menu_props(int id) {
+    GVariantBuilder props;
+    g_variant_builder_init(&props, G_VARIANT_TYPE("a{sv}"));
+    if (id == MENU_ROOT) {
+        g_variant_builder_add(&props, "{sv}", "children-display", g_variant_new_string("submenu"));
+    }
+    for (const auto & item : MENU_ITEMS) {
+        if (item.id != id) continue;
+        if (item.label) {
+            g_variant_builder_add(&props, "{sv}", "label", g_variant_new_string(item.label));
+        } else {
+            g_variant_builder_add(&props, "{sv}", "type", g_variant_new_string("separator"));
+        }
+    }
+    return g_variant_builder_end(&props);
+}
 
-    // Minimal right-click menu
-    m_impl->menu = gtk_menu_new();
+static GVariant * menu_layout(TrayIconImpl * impl, int id) {
+    GVariantBuilder children;
+    g_variant_builder_init(&children, G_VARIANT_TYPE("av"));
+    if (id == MENU_ROOT) {
+        for (const auto & item : MENU_ITEMS) {
+            if (!find_item(impl, item.id)) continue;
+            g_variant_builder_add(&children, "v", menu_layout(impl, item.id));
+        }
+    }
+    return g_variant_new("(i@a{sv}av)", id, menu_props(id), &children);
+}
 
-    GtkWidget * show_item = gtk_menu_item_new_with_label("Show Window");
-    g_signal_connect(show_item, "activate", G_CALLBACK(on_show_window), m_impl.get());
-    gtk_menu_shell_append(GTK_MENU_SHELL(m_impl->menu), show_item);
+static void menu_event(TrayIconImpl * impl, int id, const char * event) {
+    if (strcmp(event, "clicked") != 0) return;
+    if (id == MENU_SHOW && impl->callbacks.on_show_window) impl->callbacks.on_show_window();
+    if (id == MENU_QUIT && impl->callbacks.on_quit)        impl->callbacks.on_quit();
+}
 
-    gtk_menu_shell_append(GTK_MENU_SHELL(m_impl->menu), gtk_separator_menu_item_new());
+static GVariant * menu_get_property(GDBusConnection * /*conn*/, const gchar * /*sender*/, const gchar * /*path*/,
+                                    const gchar * /*iface*/, const gchar * name, GError ** /*err*/,
+                                    gpointer /*user_data*/) {
+    if (strcmp(name, "Version") == 0)       return g_variant_new_uint32(3);
+    if (strcmp(name, "TextDirection") == 0) return g_variant_new_string("ltr");
+    if (strcmp(name, "Status") == 0)        return g_variant_new_string("normal");
+    if (strcmp(name, "IconThemePath") == 0) return g_variant_new_array(G_VARIANT_TYPE_STRING, nullptr, 0);
+    return nullptr;
+}
 
-    GtkWidget * quit_item = gtk_menu_item_new_with_label("Quit");
-    g_signal_connect(quit_item, "activate", G_CALLBACK(on_quit), m_impl.get());
-    gtk_menu_shell_append(GTK_MENU_SHELL(m_impl->menu), quit_item);
+static void menu_method_call(GDBusConnection * /*conn*/, const gchar * /*sender*/, const gchar * /*path*/,
+                             const gchar * /*iface*/, const gchar * method, GVariant * params,
+                             GDBusMethodInvocation * invocation, gpointer user_data) {
+    auto * impl = static_cast<TrayIconImpl *>(user_data);
 
-    gtk_widget_show_all(m_impl->menu);
-    app_indicator_set_menu(m_impl->indicator, GTK_MENU(m_impl->menu));
+    if (strcmp(method, "GetLayout") == 0) {
+        gint32 parent = 0;
+        g_variant_get(params, "(ii@as)", &parent, nullptr, nullptr);
+        if (parent != MENU_ROOT && !find_item(impl, parent)) {
+            g_dbus_method_invocation_return_dbus_error(invocation, "org.freedesktop.DBus.Error.InvalidArgs", "unknown menu item");
+            return;
+        }
+        g_dbus_method_invocation_return_value(invocation, g_variant_new("(u@(ia{sv}av))", 1u, menu_layout(impl, parent)));
+    } else if (strcmp(method, "GetGroupProperties") == 0) {
+        GVariant * ids = g_variant_get_child_value(params, 0);
+        GVariantBuilder out;
+        g_variant_builder_init(&out, G_VARIANT_TYPE("a(ia{sv})"));
+        const gsize n = g_variant_n_children(ids);
+        for (int id = MENU_ROOT; id <= MENU_QUIT; id++) {
+            bool wanted = n == 0;
+            for (gsize i = 0; i < n && !wanted; i++) {
+                GVariant * v = g_variant_get_child_value(ids, i);
+                wanted = g_variant_get_int32(v) == id;
+                g_variant_unref(v);
+            }
+            if (wanted && (id == MENU_ROOT || find_item(impl, id))) {
+                g_variant_builder_add(&out, "(i@a{sv})", id, menu_props(id));
+            }
+        }
+        g_variant_unref(ids);
+        g_dbus_method_invocation_return_value(invocation, g_variant_new("(a(ia{sv}))", &out));
+    } else if (strcmp(method, "GetProperty") == 0) {
+        gint32 id = 0;
+        const gchar * name = nullptr;
+        g_variant_get(params, "(i&s)", &id, &name);
+        const MenuItem * item = find_item(impl, id);
+        if (!item || !item->label || strcmp(name, "label") != 0) {
+            g_dbus_method_invocation_return_dbus_error(invocation, "org.freedesktop.DBus.Error.InvalidArgs", "unknown property");
+            return;
+        }
+        g_dbus_method_invocation_return_value(invocation, g_variant_new("(v)", g_variant_new_string(item->label)));
+    } else if (strcmp(method, "Event") == 0) {
+        gint32 id = 0;
+        const gchar * event = nullptr;
+        g_variant_get(params, "(i&svu)", &id, &event, nullptr, nullptr);
+        menu_event(impl, id, event);
+        g_dbus_method_invocation_return_value(invocation, nullptr);
+    } else if (strcmp(method, "EventGroup") == 0) {
+        GVariant * events = g_variant_get_child_value(params, 0);
+        for (gsize i = 0; i < g_variant_n_children(events); i++) {
+            gint32 id = 0;
+            const gchar * event = nullptr;
+            GVariant * ev = g_variant_get_child_value(events, i);
+            g_variant_get(ev, "(i&svu)", &id, &event, nullptr, nullptr);
+            menu_event(impl, id, event);
+            g_variant_unref(ev);
+        }
+        g_variant_unref(events);
+        g_dbus_method_invocation_return_value(invocation, g_variant_new("(ai)", nullptr));
+    } else if (strcmp(method, "AboutToShow") == 0) {
+        g_dbus_method_invocation_return_value(invocation, g_variant_new("(b)", FALSE));
+    } else if (strcmp(method, "AboutToShowGroup") == 0) {
+        g_dbus_method_invocation_return_value(invocation, g_variant_new("(aiai)", nullptr, nullptr));
+    } else {
+        g_dbus_method_invocation_return_dbus_error(invocation, "org.freedesktop.DBus.Error.UnknownMethod", method);
+    }
+}
 
+// --- loop thread ---
+
+// The tray host (StatusNotifierWatcher) appeared, or was restarted
+static void on_watcher_appeared(GDBusConnection * conn, const gchar * /*name*/, const gchar * /*owner*/,
+                                gpointer user_data) {
+    auto * impl = static_cast<TrayIconImpl *>(user_data);
+    GError * err = nullptr;
+    GVariant * reply = g_dbus_connection_call_sync(
+        conn, "org.kde.StatusNotifierWatcher", "/StatusNotifierWatcher", "org.kde.StatusNotifierWatcher",
+        "RegisterStatusNotifierItem", g_variant_new("(s)", impl->bus_name.c_str()),
+        nullptr, G_DBUS_CALL_FLAGS_NONE, TRAY_CALL_TIMEOUT_MS, nullptr, &err);
+    if (!reply) {
+        fprintf(stderr, "tray: RegisterStatusNotifierItem failed: %s\n", err ? err->message : "unknown error");
+        g_clear_error(&err);
+        return;
+    }
+    g_variant_unref(reply);
+}
+
+// Take what the main thread posted and tell the host
+static gboolean drain_mailbox(gpointer user_data) {
+    auto * impl = static_cast<TrayIconImpl *>(user_data);
+    impl->wake_posted.store(false);
+
+    bool tooltip_changed = false;
+    const int state = impl->pending_state.exchange(-1);
+    if (state >= 0 && (TrayState) state != impl->state) {
+        impl->state = (TrayState) state;
+        emit(impl, "org.kde.StatusNotifierItem", ITEM_PATH, "NewIcon", nullptr);
+        tooltip_changed = impl->tooltip.empty();
+    }
+    if (std::string * text = impl->pending_tooltip.exchange(nullptr)) {
+        tooltip_changed |= *text != impl->tooltip;
+        impl->tooltip = std::move(*text);
+        delete text;
+    }
+    if (tooltip_changed) emit(impl, "org.kde.StatusNotifierItem", ITEM_PATH, "NewToolTip", nullptr);
+    return G_SOURCE_REMOVE;
+}
+
+static void tray_thread(TrayIconImpl * impl) {
+    // Method calls and name watches are dispatched on the context that was
+    // the thread default when registering
+    g_main_context_push_thread_default(impl->context);
+
+    static const GDBusInterfaceVTable item_vtable = { item_method_call, item_get_property, nullptr, {} };
+    static const GDBusInterfaceVTable menu_vtable = { menu_method_call, menu_get_property, nullptr, {} };
+    impl->item_reg = g_dbus_connection_register_object(
+        impl->conn, ITEM_PATH, g_dbus_node_info_lookup_interface(impl->node, "org.kde.StatusNotifierItem"),
+        &item_vtable, impl, nullptr, nullptr);
+    impl->menu_reg = g_dbus_connection_register_object(
+        impl->conn, MENU_PATH, g_dbus_node_info_lookup_interface(impl->node, "com.canonical.dbusmenu"),
+        &menu_vtable, impl, nullptr, nullptr);
+    impl->watcher = g_bus_watch_name_on_connection(
+        impl->conn, "org.kde.StatusNotifierWatcher", G_BUS_NAME_WATCHER_FLAGS_NONE,
+        on_watcher_appeared, nullptr, impl, nullptr);
+    {
+        std::lock_guard<std::mutex> lock(impl->mutex);
+        impl->ready = true;
+    }
+    impl->cv.notify_one();
+
+    g_main_loop_run(impl->loop);
+
+    g_bus_unwatch_name(impl->watcher);
+    g_dbus_connection_unregister_object(impl->conn, impl->menu_reg);
+    g_dbus_connection_unregister_object(impl->conn, impl->item_reg);
+    g_main_context_pop_thread_default(impl->context);
+}
+
+static void post(TrayIconImpl * impl) {
+    if (!impl->wake_posted.exchange(true)) {
+        g_main_context_invoke(impl->context, drain_mailbox, impl);
+    }
+}
+
+TrayIcon::TrayIcon() = default;
+TrayIcon::~TrayIcon() { shutdown(); }
+
+bool TrayIcon::init(const TrayCallbacks & cb) {
+    GError * err = nullptr;
+    gchar * address = g_dbus_address_get_for_bus_sync(G_BUS_TYPE_SESSION, nullptr, &err);
+    GDBusConnection * conn = address ? g_dbus_connection_new_for_address_sync(
+        address,
+        (GDBusConnectionFlags) (G_DBUS_CONNECTION_FLAGS_AUTHENTICATION_CLIENT |
+                                G_DBUS_CONNECTION_FLAGS_MESSAGE_BUS_CONNECTION),
+        nullptr, nullptr, &err) : nullptr;
+    g_free(address);
+    if (!conn) {
+        fprintf(stderr, "warning: cannot connect to session bus, tray disabled: %s\n", err ? err->message : "unknown error");
+        g_clear_error(&err);
+        return false;
+    }
+    g_dbus_connection_set_exit_on_close(conn, FALSE);
+
+    // The per-process name hosts expect from a StatusNotifierItem. The
+    // connection is private, so closing it releases the name.
+    char name[64];
+    snprintf(name, sizeof(name), "org.kde.StatusNotifierItem-%d-1", (int) getpid());
+    GVariant * reply = g_dbus_connection_call_sync(
+        conn, "org.freedesktop.DBus", "/org/freedesktop/DBus", "org.freedesktop.DBus", "RequestName",
+        g_variant_new("(su)", name, 4u /* DBUS_NAME_FLAG_DO_NOT_QUEUE */),
+        G_VARIANT_TYPE("(u)"), G_DBUS_CALL_FLAGS_NONE, TRAY_CALL_TIMEOUT_MS, nullptr, &err);
+    if (!reply) {
+        fprintf(stderr, "warning: cannot own %s, tray disabled: %s\n", name, err ? err->message : "unknown error");
+        g_clear_error(&err);
+        g_dbus_connection_close_sync(conn, nullptr, nullptr);
+        g_object_unref(conn);
+        return false;
+    }
+    guint32 owner = 0;
+    g_variant_get(reply, "(u)", &owner);
+    g_variant_unref(reply);
+    if (owner != 1 /* DBUS_REQUEST_NAME_REPLY_PRIMARY_OWNER */) {
+        fprintf(stderr, "warning: %s is owned by another connection, tray disabled\n", name);
+        g_dbus_connection_close_sync(conn, nullptr, nullptr);
+        g_object_unref(conn);
+        return false;
+    }
+
+    m_impl = std::make_unique<TrayIconImpl>();
+    m_impl->conn      = conn;
+    m_impl->bus_name  = name;
+    m_impl->callbacks = cb;
+    m_impl->node      = g_dbus_node_info_new_for_xml(INTROSPECTION_XML, nullptr);
+    m_impl->context   = g_main_context_new();
+    m_impl->loop      = g_main_loop_new(m_impl->context, FALSE);
+
+    m_impl->worker = std::thread(tray_thread, m_impl.get());
+    std::unique_lock<std::mutex> lock(m_impl->mutex);
+    m_impl->cv.wait(lock, [this]() { return m_impl->ready; });
     return true;
 }
 
 void TrayIcon::set_state(TrayState state) {
-    if (!m_impl || !m_impl->indicator) return;
-    m_impl->state = state;
-    app_indicator_set_icon(m_impl->indicator, state_icon(state));
+    if (!m_impl) return;
+    m_impl->pending_state.store((int) state);
+    post(m_impl.get());
 }
 
-void TrayIcon::poll() {
-    while (g_main_context_iteration(nullptr, FALSE)) {}
+void TrayIcon::set_tooltip(const std::string & text) {
+    if (!m_impl) return;
+    // Whisper partials can end mid-character, and GVariant rejects
+    // invalid UTF-8, so repair first and cut on character boundaries
+    gchar * valid = g_utf8_make_valid(text.c_str(), (gssize) text.size());
+    const glong n_chars = g_utf8_strlen(valid, -1);
+    auto * tip = new std::string(n_chars > (glong) TOOLTIP_MAX_CHARS
+        ? "..." + std::string(g_utf8_offset_to_pointer(valid, n_chars - (glong) TOOLTIP_MAX_CHARS))
+        : std::string(valid));
+    g_free(valid);
+    delete m_impl->pending_tooltip.exchange(tip);
+    post(m_impl.get());
 }
 
 void TrayIcon::shutdown() {
-    if (!m_impl || !m_impl->indicator) return;
-    app_indicator_set_status(m_impl->indicator, APP_INDICATOR_STATUS_PASSIVE);
-    g_object_unref(m_impl->indicator);
-    m_impl->indicator = nullptr;
+    if (!m_impl) return;
+    // Quit from inside the loop: a quit before g_main_loop_run starts
+    // would be lost. The tray thread owns the context from
+    // push_thread_default on, so this is queued, not run here.
+    g_main_context_invoke(m_impl->context, [](gpointer loop) -> gboolean {
+        g_main_loop_quit(static_cast<GMainLoop *>(loop));
+        return G_SOURCE_REMOVE;
+    }, m_impl->loop);
+    if (m_impl->worker.joinable()) m_impl->worker.join();
+
+    // Drop wakeups still queued on the context before freeing what they point to
+    while (g_main_context_iteration(m_impl->context, FALSE)) {}
+    delete m_impl->pending_tooltip.exchange(nullptr);
+
+    g_dbus_connection_close_sync(m_impl->conn, nullptr, nullptr);
+    g_object_unref(m_impl->conn);
+    g_dbus_node_info_unref(m_impl->node);
+    g_main_loop_unref(m_impl->loop);
+    g_main_context_unref(m_impl->context);
+    m_impl.reset();
 }
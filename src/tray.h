@@ -2,16 +2,21 @@
 
 #include <functional>
 #include <memory>
+#include <string>
 
 enum class TrayState { IDLE, RECORDING, TRANSCRIBING };
 
 struct TrayIconImpl;
 
+// Called on the tray's own thread
 struct TrayCallbacks {
     std::function<void()> on_show_window;  // toggle window visibility
     std::function<void()> on_quit;         // exit the app
 };
 
+// StatusNotifierItem with a dbusmenu menu, served over D-Bus from its own
+// GLib loop thread. State and tooltip updates are posted to a mailbox and
+// never block the caller on the bus.
 class TrayIcon {
 public:
     TrayIcon();
@@ -22,7 +27,8 @@ public:
 
     bool init(const TrayCallbacks & cb);
     void set_state(TrayState state);
-    void poll();
+    // Tooltip body, e.g. the live transcript (empty shows the state)
+    void set_tooltip(const std::string & text);
     void shutdown();
 
 private:
@@ -3,12 +3,22 @@
 // Records speech via global hotkey, transcribes with whisper.cpp,
 // and types the result into the focused window.
 //
+#include "capture_manager.h"
+#include "config_watch.h"
 #include "common-sdl.h"
 #include "common.h"
 #include "common-whisper.h"
 #include "whisper.h"
 #include "hotkey.h"
+#include "inference.h"
+#include "profile.h"
+#include "osd.h"
+#include "subprocess.h"
 #include "text-output.h"
+#include "vad.h"
+#ifdef HAS_DBUS
+#include "notify.h"
+#endif
 #ifdef HAS_GUI
 #include "window.h"
 #endif
@@ -16,16 +26,21 @@
 #include "tray.h"
 #endif
 
+#include <algorithm>
 #include <atomic>
 #include <cerrno>
 #include <chrono>
+#include <cmath>
 #include <csignal>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
 #include <fstream>
+#include <optional>
 #include <string>
 #include <thread>
+#include <type_traits>
+#include <variant>
 #include <vector>
 
 #ifdef __linux__
@@ -33,7 +48,6 @@
 #include <fcntl.h>
 #include <sys/file.h>
 #include <sys/stat.h>
-#include <sys/wait.h>
 #endif
 
 static_assert(std::atomic<bool>::is_always_lock_free,
@@ -44,6 +58,9 @@ struct typer_params {
     // whisper
     int32_t     n_threads      = std::min(5, (int32_t) std::thread::hardware_concurrency());
     int32_t     capture_id     = -1;
+    std::string capture_backend = "auto";
+    bool        native_rate    = false;  // capture at the device rate, resample in-process
+    bool        multi_mic      = false;  // open every mic, record the best one per utterance
     int32_t     audio_ctx      = 0;
     bool        translate      = false;
     bool        use_gpu        = true;
@@ -54,17 +71,30 @@ struct typer_params {
     // VAD
     float       vad_thold      = 0.6f;
     float       freq_thold     = 100.0f;
+    bool        vad_adapt      = false;  // energy VAD threshold from the measured noise floor
     int32_t     silence_ms     = 1500;
     int32_t     max_record_ms  = 30000;
+    int32_t     pre_roll_ms    = 300;
+    bool        long_form      = false;  // no length limit, transcribe pause-aligned chunks while recording
     std::string vad_model_path;
 
     // hotkey
     std::string hotkey         = "ctrl+period";
+    std::string cancel_key     = "none";  // off by default: keys are not grabbed, so the focused app gets it too
+    std::string translate_key  = "none";  // extra bindings with their own pipeline ("none" = off)
+    std::string command_key    = "none";
+    std::string retype_key     = "none";
     bool        push_to_talk   = false;
 
     // output
     bool        use_clipboard  = true;
     int32_t     type_delay_ms  = 12;
+    bool        adaptive_pacing = false;  // learn the typing delay per window class
+    bool        hybrid_output  = false;  // type or paste per transcript, whichever is faster
+    bool        atspi          = false;  // insert via AT-SPI into accessible widgets first
+    bool        keep_partial   = false;
+    bool        progressive    = false;  // type each segment as soon as whisper decodes it
+    int32_t     partial_ms     = 0;      // live preview decode interval while recording (0 = off)
 
     // history
     bool        no_history        = false;
@@ -73,15 +103,20 @@ struct typer_params {
 
     // gui
     bool        no_gui         = false;
+    bool        osd            = false;  // small recording indicator at the top of the screen
 
     // daemon
     bool        daemonize      = false;
     bool        stop_daemon    = false;
+    bool        cancel_daemon  = false;
     bool        print_energy   = false;
 
     // wayland
     bool        allow_wtype    = false;
     bool        threads_explicit = false;
+
+    // [profile:CLASS] sections of the config file
+    ProfileTable profiles;
 };
 
 static bool parse_int(const char * s, int32_t & out) {
@@ -114,23 +149,121 @@ static bool parse_float(const char * s, float & out) {
     }
 }
 
-static bool load_config_file(typer_params & params) {
-    std::string config_path;
+// How a changed key takes effect when the config file is reloaded
+enum class ConfigReload {
+    HOT,      // applied before the next utterance
+    RESTART,  // read once at startup (model, devices, backends)
+};
+
+using ConfigField = std::variant<int32_t typer_params::*, float typer_params::*,
+                                 bool typer_params::*, std::string typer_params::*>;
+
+struct ConfigKey {
+    const char * name;
+    ConfigField  field;
+    ConfigReload reload;
+    bool         negate = false;  // "no-gpu" style keys store the inverse
+};
+
+static const ConfigKey CONFIG_KEYS[] = {
+    { "threads",         &typer_params::n_threads,       ConfigReload::RESTART },
+    { "model",           &typer_params::model,           ConfigReload::RESTART },
+    { "language",        &typer_params::language,        ConfigReload::HOT     },
+    { "capture",         &typer_params::capture_id,      ConfigReload::RESTART },
+    { "capture-backend", &typer_params::capture_backend, ConfigReload::RESTART },
+    { "native-rate",     &typer_params::native_rate,     ConfigReload::RESTART },
+    { "multi-mic",       &typer_params::multi_mic,       ConfigReload::RESTART },
+    { "long-form",       &typer_params::long_form,       ConfigReload::RESTART },
+    { "progressive",     &typer_params::progressive,     ConfigReload::HOT     },
+    { "no-gpu",          &typer_params::use_gpu,         ConfigReload::RESTART, true },
+    { "flash-attn",      &typer_params::flash_attn,      ConfigReload::RESTART },
+    { "translate",       &typer_params::translate,       ConfigReload::HOT     },
+    { "audio-ctx",       &typer_params::audio_ctx,       ConfigReload::RESTART },
+    { "hotkey",          &typer_params::hotkey,          ConfigReload::HOT     },
+    { "cancel-key",      &typer_params::cancel_key,      ConfigReload::HOT     },
+    { "translate-key",   &typer_params::translate_key,   ConfigReload::HOT     },
+    { "command-key",     &typer_params::command_key,     ConfigReload::HOT     },
+    { "retype-key",      &typer_params::retype_key,      ConfigReload::HOT     },
+    { "push-to-talk",    &typer_params::push_to_talk,    ConfigReload::HOT     },
+    { "silence-ms",      &typer_params::silence_ms,      ConfigReload::HOT     },
+    { "max-record-ms",   &typer_params::max_record_ms,   ConfigReload::HOT     },
+    { "pre-roll-ms",     &typer_params::pre_roll_ms,     ConfigReload::RESTART },  // sizes the capture ring
+    { "vad-thold",       &typer_params::vad_thold,       ConfigReload::HOT     },
+    { "freq-thold",      &typer_params::freq_thold,      ConfigReload::HOT     },
+    { "vad-adapt",       &typer_params::vad_adapt,       ConfigReload::HOT     },
+    { "vad-model",       &typer_params::vad_model_path,  ConfigReload::RESTART },
+    { "no-clipboard",    &typer_params::use_clipboard,   ConfigReload::RESTART, true },
+    { "type-delay-ms",   &typer_params::type_delay_ms,   ConfigReload::HOT     },
+    { "adaptive-pacing", &typer_params::adaptive_pacing, ConfigReload::RESTART },
+    { "hybrid-output",   &typer_params::hybrid_output,   ConfigReload::RESTART },
+    { "atspi",           &typer_params::atspi,           ConfigReload::RESTART },
+    { "partial-ms",      &typer_params::partial_ms,      ConfigReload::HOT     },
+    { "keep-partial",    &typer_params::keep_partial,    ConfigReload::HOT     },
+    { "no-gui",          &typer_params::no_gui,          ConfigReload::RESTART },
+    { "osd",             &typer_params::osd,             ConfigReload::RESTART },
+    { "no-history",      &typer_params::no_history,      ConfigReload::RESTART },
+    { "history-file",    &typer_params::history_file,    ConfigReload::RESTART },
+    { "max-history-mb",  &typer_params::max_history_mb,  ConfigReload::HOT     },
+    { "daemon",          &typer_params::daemonize,       ConfigReload::RESTART },
+    { "allow-wtype",     &typer_params::allow_wtype,     ConfigReload::RESTART },
+};
+
+static const ConfigKey * find_config_key(const std::string & name) {
+    for (const auto & k : CONFIG_KEYS) {
+        if (name == k.name) return &k;
+    }
+    return nullptr;
+}
+
+static void config_set(typer_params & params, const ConfigKey & k, const std::string & val) {
+    if (auto f = std::get_if<int32_t typer_params::*>(&k.field)) {
+        parse_int(val.c_str(), params.**f);
+    } else if (auto f = std::get_if<float typer_params::*>(&k.field)) {
+        parse_float(val.c_str(), params.**f);
+    } else if (auto f = std::get_if<bool typer_params::*>(&k.field)) {
+        params.**f = (val == "true" || val == "1") != k.negate;
+    } else if (auto f = std::get_if<std::string typer_params::*>(&k.field)) {
+        params.**f = val;
+    }
+}
+
+static bool config_equal(const typer_params & a, const typer_params & b, const ConfigKey & k) {
+    return std::visit([&](auto field) { return a.*field == b.*field; }, k.field);
+}
+
+static void config_copy(typer_params & dst, const typer_params & src, const ConfigKey & k) {
+    std::visit([&](auto field) { dst.*field = src.*field; }, k.field);
+}
+
+static std::string config_value(const typer_params & params, const ConfigKey & k) {
+    return std::visit([&](auto field) -> std::string {
+        const auto & v = params.*field;
+        using T = std::decay_t<decltype(v)>;
+        if constexpr (std::is_same_v<T, std::string>) return v;
+        else if constexpr (std::is_same_v<T, bool>)   return (v != k.negate) ? "true" : "false";
+        else                                          return std::to_string(v);
+    }, k.field);
+}
+
+static std::string config_file_path() {
     const char * xdg_config = getenv("XDG_CONFIG_HOME");
     if (xdg_config && xdg_config[0] != '\0') {
-        config_path = std::string(xdg_config) + "/whisper-typer/config";
-    } else {
-        const char * home = getenv("HOME");
-        if (!home) return false;
-        config_path = std::string(home) + "/.config/whisper-typer/config";
+        return std::string(xdg_config) + "/whisper-typer/config";
     }
+    const char * home = getenv("HOME");
+    if (!home) return "";
+    return std::string(home) + "/.config/whisper-typer/config";
+}
 
+static bool load_config_file(const std::string & config_path, typer_params & params) {
+    if (config_path.empty()) return false;
     std::ifstream f(config_path);
     if (!f.is_open()) return false;
 
     fprintf(stderr, "whisper-typer: loading config from %s\n", config_path.c_str());
 
     std::string line;
+    std::string section;  // "profile:CLASS" once a section header was seen
     int line_num = 0;
     while (std::getline(f, line)) {
         line_num++;
@@ -141,6 +274,14 @@ static bool load_config_file(typer_params & params) {
         while (!line.empty() && std::isspace((unsigned char)line.back()))  line.pop_back();
         if (line.empty()) continue;
 
+        if (line.front() == '[' && line.back() == ']') {
+            section = line.substr(1, line.size() - 2);
+            if (section.rfind("profile:", 0) != 0 || section.size() == 8) {
+                fprintf(stderr, "config:%d: unknown section '%s', skipping it\n", line_num, line.c_str());
+            }
+            continue;
+        }
+
         auto eq_pos = line.find('=');
         if (eq_pos == std::string::npos) {
             fprintf(stderr, "config:%d: missing '=' in '%s'\n", line_num, line.c_str());
@@ -152,36 +293,53 @@ static bool load_config_file(typer_params & params) {
         while (!key.empty() && std::isspace((unsigned char)key.back()))  key.pop_back();
         while (!val.empty() && std::isspace((unsigned char)val.front())) val.erase(val.begin());
 
-        if      (key == "threads")        { parse_int(val.c_str(), params.n_threads); params.threads_explicit = true; }
-        else if (key == "model")          { params.model = val; }
-        else if (key == "language")       { params.language = val; }
-        else if (key == "capture")        { parse_int(val.c_str(), params.capture_id); }
-        else if (key == "no-gpu")         { params.use_gpu = (val != "true" && val != "1"); }
-        else if (key == "flash-attn")     { params.flash_attn = (val == "true" || val == "1"); }
-        else if (key == "translate")      { params.translate = (val == "true" || val == "1"); }
-        else if (key == "audio-ctx")      { parse_int(val.c_str(), params.audio_ctx); }
-        else if (key == "hotkey")         { params.hotkey = val; }
-        else if (key == "push-to-talk")   { params.push_to_talk = (val == "true" || val == "1"); }
-        else if (key == "silence-ms")     { parse_int(val.c_str(), params.silence_ms); }
-        else if (key == "max-record-ms")  { parse_int(val.c_str(), params.max_record_ms); }
-        else if (key == "vad-thold")      { parse_float(val.c_str(), params.vad_thold); }
-        else if (key == "freq-thold")     { parse_float(val.c_str(), params.freq_thold); }
-        else if (key == "vad-model")      { params.vad_model_path = val; }
-        else if (key == "no-clipboard")   { params.use_clipboard = !(val == "true" || val == "1"); }
-        else if (key == "type-delay-ms")  { parse_int(val.c_str(), params.type_delay_ms); }
-        else if (key == "no-gui")        { params.no_gui = (val == "true" || val == "1"); }
-        else if (key == "no-history")     { params.no_history = (val == "true" || val == "1"); }
-        else if (key == "history-file")   { params.history_file = val; }
-        else if (key == "max-history-mb") { parse_int(val.c_str(), params.max_history_mb); }
-        else if (key == "daemon")         { params.daemonize = (val == "true" || val == "1"); }
-        else if (key == "allow-wtype")   { params.allow_wtype = (val == "true" || val == "1"); }
-        else {
+        if (!section.empty()) {
+            if (section.rfind("profile:", 0) == 0 && section.size() > 8 &&
+                !params.profiles.set(section.substr(8), key, val)) {
+                fprintf(stderr, "config:%d: invalid profile setting '%s'\n", line_num, line.c_str());
+            }
+            continue;
+        }
+
+        const ConfigKey * k = find_config_key(key);
+        if (!k) {
             fprintf(stderr, "config:%d: unknown key '%s'\n", line_num, key.c_str());
+            continue;
         }
+        config_set(params, *k, val);
+        if (key == "threads") params.threads_explicit = true;
     }
     return true;
 }
 
+// The hotkey table: dictation plus the extra bindings that are set
+static std::vector<HotkeyBinding> hotkey_bindings(const typer_params & params) {
+    std::vector<HotkeyBinding> table = { { params.hotkey, HotkeyAction::DICTATE } };
+    const HotkeyBinding extra[] = {
+        { params.translate_key, HotkeyAction::TRANSLATE },
+        { params.command_key,   HotkeyAction::COMMAND   },
+        { params.retype_key,    HotkeyAction::RETYPE    },
+        { params.cancel_key,    HotkeyAction::CANCEL    },
+    };
+    for (const auto & b : extra) {
+        if (!b.keys.empty() && b.keys != "none") table.push_back(b);
+    }
+    return table;
+}
+
+// What a recording does with its transcript, by the binding that started it
+struct Pipeline {
+    bool translate = false;  // translate to English
+    bool submit    = false;  // no final punctuation, press Enter after the text
+};
+
+static Pipeline pipeline_for(HotkeyAction action) {
+    Pipeline p;
+    p.translate = action == HotkeyAction::TRANSLATE;
+    p.submit    = action == HotkeyAction::COMMAND;
+    return p;
+}
+
 static void typer_print_usage(int /*argc*/, char ** argv, const typer_params & params) {
     fprintf(stderr, "\n");
     fprintf(stderr, "usage: %s [options]\n", argv[0]);
@@ -191,29 +349,47 @@ static void typer_print_usage(int /*argc*/, char ** argv, const typer_params & p
     fprintf(stderr, "  -t N,     --threads N     [%-7d] number of threads\n",                       params.n_threads);
     fprintf(stderr, "  -m FNAME, --model FNAME   [%-7s] model path\n",                              params.model.c_str());
     fprintf(stderr, "  -l LANG,  --language LANG [%-7s] spoken language\n",                         params.language.c_str());
-    fprintf(stderr, "  -c ID,    --capture ID    [%-7d] capture device ID\n",                       params.capture_id);
+    fprintf(stderr, "  -c ID,    --capture ID    [%-7d] capture device ID (SDL)\n",                 params.capture_id);
+    fprintf(stderr, "            --capture-backend B  [%s] auto, pipewire or sdl\n",                 params.capture_backend.c_str());
+    fprintf(stderr, "            --native-rate        capture at the device rate, resample in-process\n");
+    fprintf(stderr, "            --multi-mic          open all microphones, record the best one per utterance\n");
+    fprintf(stderr, "            --long-form          no length limit, transcribe at pauses while recording\n");
+    fprintf(stderr, "            --progressive        type each segment as soon as it is decoded\n");
     fprintf(stderr, "  -ng,      --no-gpu            disable GPU inference\n");
     fprintf(stderr, "  -fa,      --flash-attn        enable flash attention (default)\n");
     fprintf(stderr, "  -nfa,     --no-flash-attn     disable flash attention\n");
     fprintf(stderr, "  -tr,      --translate         translate to English\n");
     fprintf(stderr, "  -ac N,    --audio-ctx N   [%-7d] audio context size (0 = full)\n",            params.audio_ctx);
-    fprintf(stderr, "            --hotkey KEY    [%-7s] global hotkey\n",                            params.hotkey.c_str());
+    fprintf(stderr, "            --hotkey KEY    [%-7s] global hotkey (also double+KEY, hold+KEY, rightctrl)\n", params.hotkey.c_str());
+    fprintf(stderr, "            --cancel-key KEY[%-7s] cancel recording/transcription (\"none\" = off)\n", params.cancel_key.c_str());
+    fprintf(stderr, "            --translate-key KEY  [%s] record and translate to English\n",     params.translate_key.c_str());
+    fprintf(stderr, "            --command-key KEY    [%s] record, type without final punctuation, press Enter\n", params.command_key.c_str());
+    fprintf(stderr, "            --retype-key KEY     [%s] type the last transcript again\n",      params.retype_key.c_str());
     fprintf(stderr, "            --push-to-talk       hold-to-record mode\n");
     fprintf(stderr, "            --silence-ms N  [%-7d] silence to auto-stop (ms)\n",               params.silence_ms);
     fprintf(stderr, "            --max-record-ms N[%-6d] max recording time (ms)\n",                params.max_record_ms);
+    fprintf(stderr, "            --pre-roll-ms N [%-7d] audio kept from before the keypress (ms)\n", params.pre_roll_ms);
     fprintf(stderr, "            --vad-thold N   [%-7.2f] VAD energy threshold\n",                  params.vad_thold);
     fprintf(stderr, "            --freq-thold N  [%-7.2f] high-pass filter cutoff Hz\n",            params.freq_thold);
+    fprintf(stderr, "            --vad-adapt          derive the VAD threshold from the noise floor\n");
     fprintf(stderr, "            --vad-model F        Silero VAD model path\n");
     fprintf(stderr, "            --no-clipboard       use keystroke simulation\n");
     fprintf(stderr, "            --type-delay-ms N[%-6d] keystroke delay (ms)\n",                   params.type_delay_ms);
+    fprintf(stderr, "            --adaptive-pacing    learn the keystroke delay per application\n");
+    fprintf(stderr, "            --hybrid-output      type or paste per transcript, whichever is faster\n");
+    fprintf(stderr, "            --atspi              insert text directly into accessible widgets\n");
+    fprintf(stderr, "            --keep-partial       type finished segments of a cancelled transcription\n");
+    fprintf(stderr, "            --partial-ms N  [%-7d] live transcript preview interval while recording (0 = off)\n", params.partial_ms);
     fprintf(stderr, "            --no-gui             disable GUI window\n");
+    fprintf(stderr, "            --osd                show a recording indicator at the top of the screen\n");
     fprintf(stderr, "            --no-history         disable transcript history\n");
     fprintf(stderr, "            --history-file F     custom history file path\n");
     fprintf(stderr, "            --max-history-mb N   max history file size (MB, default 10)\n");
     fprintf(stderr, "            --daemon             start with window hidden (for autostart)\n");
     fprintf(stderr, "            --stop               stop running daemon\n");
+    fprintf(stderr, "            --cancel             cancel the running daemon's recording/transcription\n");
     fprintf(stderr, "            --allow-wtype        enable wtype fallback (Wayland, see security note)\n");
-    fprintf(stderr, "  -pe,      --print-energy       print audio energy levels\n");
+    fprintf(stderr, "  -pe,      --print-energy       print audio energy levels and noise calibration\n");
     fprintf(stderr, "\n");
 }
 
@@ -238,26 +414,44 @@ static bool typer_params_parse(int argc, char ** argv, typer_params & params) {
         else if (arg == "-m"   || arg == "--model")          { auto v = next_arg(); if (!v) return false; params.model           = v; }
         else if (arg == "-l"   || arg == "--language")       { auto v = next_arg(); if (!v) return false; params.language         = v; }
         else if (arg == "-c"   || arg == "--capture")        { auto v = next_arg(); if (!v || !parse_int(v, params.capture_id))    return false; }
+        else if (                 arg == "--capture-backend") { auto v = next_arg(); if (!v) return false; params.capture_backend = v; }
+        else if (                 arg == "--native-rate")    { params.native_rate         = true; }
+        else if (                 arg == "--multi-mic")      { params.multi_mic           = true; }
+        else if (                 arg == "--long-form")      { params.long_form           = true; }
+        else if (                 arg == "--progressive")    { params.progressive         = true; }
         else if (arg == "-ng"  || arg == "--no-gpu")         { params.use_gpu          = false; }
         else if (arg == "-fa"  || arg == "--flash-attn")     { params.flash_attn       = true; }
         else if (arg == "-nfa" || arg == "--no-flash-attn")  { params.flash_attn       = false; }
         else if (arg == "-tr"  || arg == "--translate")      { params.translate         = true; }
         else if (arg == "-ac"  || arg == "--audio-ctx")      { auto v = next_arg(); if (!v || !parse_int(v, params.audio_ctx))     return false; }
         else if (                 arg == "--hotkey")          { auto v = next_arg(); if (!v) return false; params.hotkey            = v; }
+        else if (                 arg == "--cancel-key")     { auto v = next_arg(); if (!v) return false; params.cancel_key        = v; }
+        else if (                 arg == "--translate-key")  { auto v = next_arg(); if (!v) return false; params.translate_key     = v; }
+        else if (                 arg == "--command-key")    { auto v = next_arg(); if (!v) return false; params.command_key       = v; }
+        else if (                 arg == "--retype-key")     { auto v = next_arg(); if (!v) return false; params.retype_key        = v; }
         else if (                 arg == "--push-to-talk")   { params.push_to_talk      = true; }
         else if (                 arg == "--silence-ms")     { auto v = next_arg(); if (!v || !parse_int(v, params.silence_ms))    return false; }
         else if (                 arg == "--max-record-ms")  { auto v = next_arg(); if (!v || !parse_int(v, params.max_record_ms)) return false; }
+        else if (                 arg == "--pre-roll-ms")    { auto v = next_arg(); if (!v || !parse_int(v, params.pre_roll_ms))   return false; }
         else if (                 arg == "--vad-thold")      { auto v = next_arg(); if (!v || !parse_float(v, params.vad_thold))   return false; }
         else if (                 arg == "--freq-thold")     { auto v = next_arg(); if (!v || !parse_float(v, params.freq_thold))  return false; }
+        else if (                 arg == "--vad-adapt")      { params.vad_adapt           = true; }
         else if (                 arg == "--vad-model")      { auto v = next_arg(); if (!v) return false; params.vad_model_path     = v; }
         else if (                 arg == "--no-clipboard")   { params.use_clipboard      = false; }
         else if (                 arg == "--type-delay-ms")  { auto v = next_arg(); if (!v || !parse_int(v, params.type_delay_ms)) return false; }
+        else if (                 arg == "--adaptive-pacing") { params.adaptive_pacing    = true; }
+        else if (                 arg == "--hybrid-output")  { params.hybrid_output      = true; }
+        else if (                 arg == "--atspi")          { params.atspi              = true; }
+        else if (                 arg == "--partial-ms")     { auto v = next_arg(); if (!v || !parse_int(v, params.partial_ms))    return false; }
+        else if (                 arg == "--keep-partial")   { params.keep_partial        = true; }
         else if (                 arg == "--no-gui")          { params.no_gui               = true; }
+        else if (                 arg == "--osd")             { params.osd                  = true; }
         else if (                 arg == "--no-history")      { params.no_history            = true; }
         else if (                 arg == "--history-file")   { auto v = next_arg(); if (!v) return false; params.history_file = v; }
         else if (                 arg == "--max-history-mb") { auto v = next_arg(); if (!v || !parse_int(v, params.max_history_mb)) return false; }
         else if (                 arg == "--daemon")         { params.daemonize           = true; }
         else if (                 arg == "--stop")           { params.stop_daemon         = true; }
+        else if (                 arg == "--cancel")         { params.cancel_daemon       = true; }
         else if (                 arg == "--allow-wtype")   { params.allow_wtype         = true; }
         else if (arg == "-pe"  || arg == "--print-energy")   { params.print_energy        = true; }
         else {
@@ -272,55 +466,13 @@ static bool typer_params_parse(int argc, char ** argv, typer_params & params) {
 static std::atomic<bool> g_running(true);
 static std::atomic<bool> g_sigusr1(false);
 static std::atomic<bool> g_sigusr2(false);  // show window
+static std::atomic<bool> g_cancel(false);   // cancel recording/transcription
 
-static bool whisper_abort_cb(void * /*user_data*/) {
-    return !g_running;
-}
-
-// Transcribe audio buffer and return concatenated text
-static std::string transcribe(
-        struct whisper_context * ctx,
-        const typer_params & params,
-        const std::vector<float> & pcmf32) {
-
-    whisper_full_params wparams = whisper_full_default_params(WHISPER_SAMPLING_GREEDY);
-
-    wparams.print_progress   = false;
-    wparams.print_special    = false;
-    wparams.print_realtime   = false;
-    wparams.print_timestamps = false;
-    wparams.translate        = params.translate;
-    wparams.single_segment   = false;
-    wparams.max_tokens       = 0;
-    wparams.language         = params.language.c_str();
-    wparams.n_threads        = params.n_threads;
-    wparams.audio_ctx        = params.audio_ctx;
-    wparams.no_context       = true;
-    wparams.no_timestamps    = true;
-    wparams.suppress_blank   = true;
-
-    wparams.abort_callback           = whisper_abort_cb;
-    wparams.abort_callback_user_data = nullptr;
-
-    // Silero VAD integration
-    if (!params.vad_model_path.empty()) {
-        wparams.vad            = true;
-        wparams.vad_model_path = params.vad_model_path.c_str();
-    }
-
-    if (whisper_full(ctx, wparams, pcmf32.data(), pcmf32.size()) != 0) {
-        fprintf(stderr, "error: whisper_full() failed\n");
-        return "";
-    }
-
-    std::string result;
-    const int n_segments = whisper_full_n_segments(ctx);
-    for (int i = 0; i < n_segments; ++i) {
-        const char * text = whisper_full_get_segment_text(ctx, i);
-        result += text;
-    }
-
-    return result;
+// The streaming VAD runs on every push during recording; keep its per-call
+// progress lines out of the log
+static void whisper_log_cb(enum ggml_log_level level, const char * text, void * /*user_data*/) {
+    if (level <= GGML_LOG_LEVEL_INFO && strncmp(text, "whisper_vad", 11) == 0) return;
+    fputs(text, stderr);
 }
 
 static void signal_handler(int /*sig*/) {
@@ -334,6 +486,49 @@ static void sigusr1_handler(int /*sig*/) {
 static void sigusr2_handler(int /*sig*/) {
     g_sigusr2 = true;
 }
+static void sigcancel_handler(int /*sig*/) {
+    g_cancel = true;
+}
+
+// Single-instance lock file; holds the PID of the running daemon
+static std::string lock_file_path() {
+    const char * xdg_runtime = getenv("XDG_RUNTIME_DIR");
+    if (xdg_runtime && xdg_runtime[0] != '\0') {
+        return std::string(xdg_runtime) + "/whisper-typer.lock";
+    }
+    return "/tmp/whisper-typer.lock";
+}
+
+// Look up the PID of the running daemon from its lock file.
+// Returns -1 (after printing why) if no daemon is running.
+static pid_t find_daemon_pid() {
+    int fd = open(lock_file_path().c_str(), O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "error: no running daemon found (no lock file)\n");
+        return -1;
+    }
+    // Try to acquire lock — if we can, no daemon is running
+    if (flock(fd, LOCK_EX | LOCK_NB) == 0) {
+        flock(fd, LOCK_UN);
+        close(fd);
+        fprintf(stderr, "error: no running daemon found\n");
+        return -1;
+    }
+    // Read PID from lock file
+    char pid_buf[32] = {};
+    ssize_t n = read(fd, pid_buf, sizeof(pid_buf) - 1);
+    close(fd);
+    if (n <= 0) {
+        fprintf(stderr, "error: could not read PID from lock file\n");
+        return -1;
+    }
+    pid_t pid = atoi(pid_buf);
+    if (pid <= 0) {
+        fprintf(stderr, "error: invalid PID in lock file\n");
+        return -1;
+    }
+    return pid;
+}
 #endif
 
 // Escape a string for safe inclusion in a JSON value
@@ -359,6 +554,25 @@ static std::string json_escape_string(const std::string & s) {
     return out;
 }
 
+// Reject values the main loop cannot work with, keeping fallback's value
+// for the key instead: the defaults at startup, the running values on a
+// config reload
+static void normalize_params(typer_params & params, const typer_params & fallback) {
+    auto at_least = [&](int32_t typer_params::* field, const char * name, int32_t min) {
+        if (params.*field >= min) return;
+        fprintf(stderr, "warning: %s must be at least %d, keeping %d\n", name, min, fallback.*field);
+        params.*field = fallback.*field;
+    };
+    at_least(&typer_params::silence_ms,     "silence-ms",     1);
+    at_least(&typer_params::max_record_ms,  "max-record-ms",  1);
+    at_least(&typer_params::partial_ms,     "partial-ms",     0);
+    at_least(&typer_params::type_delay_ms,  "type-delay-ms",  0);
+    at_least(&typer_params::max_history_mb, "max-history-mb", 1);
+
+    // Pre-roll is meant to catch a clipped first syllable, not to record the past
+    params.pre_roll_ms = std::max(0, std::min(params.pre_roll_ms, params.max_record_ms / 2));
+}
+
 // Create directories recursively (like mkdir -p)
 static void mkdir_p(const std::string & path) {
     std::string accum;
@@ -417,14 +631,26 @@ int main(int argc, char ** argv) {
     ggml_backend_load_all();
 
     typer_params params;
-    load_config_file(params);  // config file first; CLI overrides
+    const std::string config_path = config_file_path();
+    const bool have_config = load_config_file(config_path, params);  // config file first; CLI overrides
 
     if (!typer_params_parse(argc, argv, params)) {
         return 1;
     }
+    // As read, before the adjustments below; config reloads diff against it
+    typer_params params_read = params;
 
     // (daemon mode no longer caps threads — it runs with full GUI, just hidden)
 
+    normalize_params(params, typer_params());
+
+    // Chunks are cut at pauses the streaming VAD finds
+    if (params.long_form && params.vad_model_path.empty()) {
+        fprintf(stderr, "warning: --long-form needs --vad-model, recordings stay limited to %d ms\n",
+                params.max_record_ms);
+        params.long_form = false;
+    }
+
     // Resolve history file path
     std::string history_path;
     if (!params.no_history) {
@@ -441,67 +667,24 @@ int main(int argc, char ** argv) {
         }
     }
 
-    // Handle --stop: send SIGTERM to running daemon and exit
+    // Handle --stop / --cancel: signal the running daemon and exit
 #ifdef __linux__
-    if (params.stop_daemon) {
-        std::string stop_lock_path;
-        const char * stop_xdg = getenv("XDG_RUNTIME_DIR");
-        if (stop_xdg && stop_xdg[0] != '\0') {
-            stop_lock_path = std::string(stop_xdg) + "/whisper-typer.lock";
-        } else {
-            stop_lock_path = "/tmp/whisper-typer.lock";
-        }
-        int stop_fd = open(stop_lock_path.c_str(), O_RDONLY);
-        if (stop_fd < 0) {
-            fprintf(stderr, "error: no running daemon found (no lock file)\n");
-            return 1;
-        }
-        // Try to acquire lock — if we can, no daemon is running
-        if (flock(stop_fd, LOCK_EX | LOCK_NB) == 0) {
-            flock(stop_fd, LOCK_UN);
-            close(stop_fd);
-            fprintf(stderr, "error: no running daemon found\n");
-            return 1;
-        }
-        // Read PID from lock file
-        char pid_buf[32] = {};
-        ssize_t n = read(stop_fd, pid_buf, sizeof(pid_buf) - 1);
-        close(stop_fd);
-        if (n <= 0) {
-            fprintf(stderr, "error: could not read PID from lock file\n");
-            return 1;
-        }
-        pid_t daemon_pid = atoi(pid_buf);
-        if (daemon_pid <= 0) {
-            fprintf(stderr, "error: invalid PID in lock file\n");
+    if (params.stop_daemon || params.cancel_daemon) {
+        pid_t daemon_pid = find_daemon_pid();
+        if (daemon_pid < 0) {
             return 1;
         }
-        if (kill(daemon_pid, SIGTERM) != 0) {
-            fprintf(stderr, "error: failed to send SIGTERM to PID %d: %s\n", daemon_pid, strerror(errno));
+        int          sig      = params.stop_daemon ? SIGTERM : SIGRTMIN;
+        const char * sig_name = params.stop_daemon ? "SIGTERM" : "cancel (SIGRTMIN)";
+        if (kill(daemon_pid, sig) != 0) {
+            fprintf(stderr, "error: failed to send %s to PID %d: %s\n", sig_name, daemon_pid, strerror(errno));
             return 1;
         }
-        fprintf(stderr, "whisper-typer: sent SIGTERM to PID %d\n", daemon_pid);
+        fprintf(stderr, "whisper-typer: sent %s to PID %d\n", sig_name, daemon_pid);
         return 0;
     }
 #endif
 
-    // Fire-and-forget notification via notify-send (if available)
-    // Uses double-fork so the grandchild is reparented to init (no zombies).
-    auto notify = [](const char * summary, int timeout_ms) {
-        pid_t pid = fork();
-        if (pid < 0) return;
-        if (pid == 0) {
-            if (fork() != 0) _exit(0);
-            int devnull = open("/dev/null", O_WRONLY);
-            if (devnull >= 0) { dup2(devnull, STDOUT_FILENO); dup2(devnull, STDERR_FILENO); close(devnull); }
-            std::string t = std::to_string(timeout_ms);
-            execlp("notify-send", "notify-send", "-t", t.c_str(), "whisper-typer", summary, nullptr);
-            _exit(127);
-        }
-        int status;
-        waitpid(pid, &status, 0);
-    };
-
     // Check if a program exists in PATH (no shell, no fork — pure access() search)
     auto check_dep = [](const char * prog) -> bool {
         if (!prog || prog[0] == '\0') return false;
@@ -535,22 +718,47 @@ int main(int argc, char ** argv) {
             fprintf(stderr, "error: xdotool not found. Install with: sudo apt install xdotool\n");
             return 1;
         }
-        if (params.use_clipboard && !check_dep("xclip")) {
+        if ((params.use_clipboard || params.hybrid_output) && !check_dep("xclip")) {
             fprintf(stderr, "error: xclip not found. Install with: sudo apt install xclip\n");
             return 1;
         }
+        for (const auto & kv : params.profiles.profiles()) {
+            if (kv.second.output == ProfileOutput::PASTE && !params.use_clipboard && !params.hybrid_output &&
+                !check_dep("xclip")) {
+                fprintf(stderr, "warning: profile '%s' pastes but xclip is not installed\n", kv.second.name.c_str());
+            }
+        }
     }
+
+    // Desktop notifications: native D-Bus client when built with GIO and a
+    // session bus is up, otherwise fire-and-forget notify-send (if available).
+    // posix_spawn avoids copying the model-sized address space; the child
+    // is reaped in the background (no zombies).
+    auto notify_send = [](const char * body, int timeout_ms) {
+        std::string t = std::to_string(timeout_ms);
+        const char * argv[] = {"notify-send", "-t", t.c_str(), "whisper-typer", body, nullptr};
+        spawn_detached(argv);
+    };
+#ifdef HAS_DBUS
+    Notifier notifier;
+    const bool dbus_notify = notifier.init();
+    bool has_notify = dbus_notify || check_dep("notify-send");
+    if (!dbus_notify && has_notify) fprintf(stderr, "notify: using notify-send\n");
+    auto notify = [&](const char * body, int timeout_ms) {
+        if (dbus_notify) {
+            notifier.notify(body, timeout_ms);
+        } else {
+            notify_send(body, timeout_ms);
+        }
+    };
+#else
     bool has_notify = check_dep("notify-send");
+    auto notify = notify_send;
+#endif
 
     // Single-instance lock
 #ifdef __linux__
-    std::string lock_path;
-    const char * xdg_runtime = getenv("XDG_RUNTIME_DIR");
-    if (xdg_runtime && xdg_runtime[0] != '\0') {
-        lock_path = std::string(xdg_runtime) + "/whisper-typer.lock";
-    } else {
-        lock_path = "/tmp/whisper-typer.lock";
-    }
+    std::string lock_path = lock_file_path();
     int lock_fd = open(lock_path.c_str(), O_CREAT | O_RDWR, 0600);
     if (lock_fd >= 0) {
         if (flock(lock_fd, LOCK_EX | LOCK_NB) != 0) {
@@ -587,6 +795,7 @@ int main(int argc, char ** argv) {
 #ifdef __linux__
     signal(SIGUSR1, sigusr1_handler);
     signal(SIGUSR2, sigusr2_handler);
+    signal(SIGRTMIN, sigcancel_handler);
     signal(SIGTSTP, SIG_IGN);  // Prevent job-control stop (Ctrl+Z) — a stopped process can't respond to SIGTERM
 #endif
 
@@ -596,6 +805,8 @@ int main(int argc, char ** argv) {
         return 1;
     }
 
+    whisper_log_set(whisper_log_cb, nullptr);
+
     // Init whisper
     struct whisper_context_params cparams = whisper_context_default_params();
     cparams.use_gpu    = params.use_gpu;
@@ -607,25 +818,61 @@ int main(int argc, char ** argv) {
         return 2;
     }
 
-    // Init audio capture with buffer large enough for max recording
-    audio_async audio(params.max_record_ms);
-    if (!audio.init(params.capture_id, WHISPER_SAMPLE_RATE)) {
-        fprintf(stderr, "error: audio.init() failed\n");
+    // Streaming Silero VAD drives auto-stop when a VAD model is given;
+    // otherwise the energy-based vad_simple is used
+    StreamingVad vad;
+    if (!params.vad_model_path.empty() && !vad.init(params.vad_model_path, params.n_threads)) {
+        fprintf(stderr, "warning: falling back to energy VAD for auto-stop\n");
+    }
+    const VadDecisionParams vad_dp;
+    const VadChunkParams    vad_chunk;
+
+    // Transcription runs on a worker thread; the main loop keeps recording
+    // (long-form), polling the cancel key and drawing the window meanwhile
+    InferenceOptions inference_opts;
+    inference_opts.language       = params.language;
+    inference_opts.translate      = params.translate;
+    inference_opts.n_threads      = params.n_threads;
+    inference_opts.audio_ctx      = params.audio_ctx;
+    inference_opts.vad_model_path = params.vad_model_path;
+    InferenceWorker inference;
+    inference.start(ctx, inference_opts);
+
+    // Init audio capture. The rings only hold the pre-roll plus slack for
+    // the main loop; recordings are moved into pooled blocks as they grow,
+    // so max_record_ms costs nothing until it is used. Long-form typing
+    // while recording drains the rings from a helper thread.
+    CaptureOptions capture_opts;
+    capture_opts.backend     = params.capture_backend;
+    capture_opts.capture_id  = params.capture_id;
+    capture_opts.sample_rate = WHISPER_SAMPLE_RATE;
+    capture_opts.ring_ms     = params.pre_roll_ms + 2000;
+    capture_opts.native_rate = params.native_rate;
+    capture_opts.multi       = params.multi_mic;
+    capture_opts.freq_thold  = params.freq_thold;
+    capture_opts.collect     = params.print_energy;
+
+    CaptureManager mics;
+    if (!mics.init(capture_opts)) {
+        fprintf(stderr, "error: audio capture init failed\n");
         whisper_free(ctx);
         return 3;
     }
 
-    // Start audio immediately and keep it running.
-    // On PipeWire, SDL audio callbacks fail if the device is resumed after
-    // the evdev hotkey listener thread has started. Keeping audio always
-    // running avoids this — we just clear() the buffer when recording starts.
-    audio.resume();
-
     // Init hotkey listener
     HotkeyListener hotkey;
     bool hotkey_ok = false;
-    if (hotkey.init(params.hotkey)) {
-        if (hotkey.start(nullptr)) {
+    bool hotkey_bound = hotkey.bind(hotkey_bindings(params));
+    if (!hotkey_bound && hotkey_bindings(params).size() > 1) {
+        fprintf(stderr, "warning: invalid extra hotkey, only '%s' is bound\n", params.hotkey.c_str());
+        hotkey_bound = hotkey.bind({ { params.hotkey, HotkeyAction::DICTATE } });
+    }
+    if (hotkey_bound && params.translate_key != "none" && !params.translate_key.empty() &&
+        !whisper_is_multilingual(ctx)) {
+        fprintf(stderr, "warning: %s is English-only, the translate key will only transcribe\n", params.model.c_str());
+    }
+    if (hotkey_bound) {
+        if (hotkey.start()) {
             hotkey_ok = true;
         } else {
             fprintf(stderr, "warning: failed to start hotkey listener\n");
@@ -650,6 +897,66 @@ int main(int argc, char ** argv) {
     output.set_use_clipboard(params.use_clipboard);
     output.set_type_delay_ms(params.type_delay_ms);
 
+    // Wayland has no paste path yet: libei/wtype always type
+    bool hybrid_ok = false;
+    if (params.hybrid_output) {
+        if (display != DisplayBackend::X11) {
+            fprintf(stderr, "warning: hybrid output needs X11, always typing\n");
+        } else {
+            output.set_hybrid(true);
+            hybrid_ok = true;
+        }
+    }
+
+    // Learned per-class typing delays live with other state, not config
+    bool pacing_ok = false;
+    if (params.adaptive_pacing) {
+        if (display != DisplayBackend::X11 || (params.use_clipboard && !params.hybrid_output)) {
+            fprintf(stderr, "warning: adaptive pacing needs X11 keystroke typing (--no-clipboard or --hybrid-output), "
+                            "using type-delay-ms\n");
+        } else {
+            std::string state_dir;
+            const char * xdg_state = getenv("XDG_STATE_HOME");
+            if (xdg_state && xdg_state[0] != '\0') {
+                state_dir = std::string(xdg_state) + "/whisper-typer";
+            } else if (const char * home = getenv("HOME")) {
+                state_dir = std::string(home) + "/.local/state/whisper-typer";
+            }
+            if (!state_dir.empty()) {
+                mkdir_p(state_dir);
+                output.set_adaptive_pacing(state_dir + "/pacing");
+                pacing_ok = true;
+            }
+        }
+    }
+
+    // AT-SPI goes first when the focused widget is editable through it
+    bool atspi_ok = false;
+    if (params.atspi) {
+#ifdef HAS_DBUS
+        atspi_ok = output.init_atspi();
+        if (!atspi_ok) {
+            fprintf(stderr, "warning: AT-SPI unavailable, using the other output backends\n");
+        }
+#else
+        fprintf(stderr, "warning: built without D-Bus, --atspi ignored\n");
+#endif
+    }
+
+    // Adaptive pacing reads typed text back over AT-SPI and hybrid output
+    // asks it for password fields; without --atspi the bus is only read from
+    if ((pacing_ok || hybrid_ok) && !params.atspi) {
+#ifdef HAS_DBUS
+        if (!output.init_atspi(false)) {
+            fprintf(stderr, "warning: AT-SPI unavailable, typing delays will not be learned "
+                            "and password fields not recognised\n");
+        }
+#else
+        fprintf(stderr, "warning: built without D-Bus, typing delays will not be learned "
+                        "and password fields not recognised\n");
+#endif
+    }
+
     // Initialize keyboard backend for Wayland
     if (display == DisplayBackend::WAYLAND) {
         if (output.init_libei()) {
@@ -669,19 +976,21 @@ int main(int argc, char ** argv) {
     }
 
     // Init GUI window (always created; hidden in daemon mode, shown otherwise)
+    std::string last_transcript;  // for the retype binding and the window
 #ifdef HAS_GUI
     AppWindow window;
     bool window_ok = false;
-    std::string last_transcript;
     if (!params.no_gui) {
         WindowCallbacks cb;
         cb.on_toggle = [&]() { g_sigusr1 = true; };
+        cb.on_cancel = [&]() { g_cancel = true; };
         cb.on_quit   = [&]() { g_running = false; };
         cb.get_last_transcript = [&]() { return last_transcript; };
         cb.get_history_path    = [&]() { return history_path; };
         window_ok = window.init(cb);
         if (window_ok) {
             window.set_hotkey(params.hotkey);
+            window.set_level_meter(&mics.meter());
             if (params.daemonize) {
                 window.hide();  // daemon mode: start hidden, show via tray or SIGUSR2
             }
@@ -689,7 +998,8 @@ int main(int argc, char ** argv) {
     }
 #endif
 
-    // Init system tray icon
+    // Init system tray icon. Its callbacks run on the tray thread; the
+    // window setters are thread-safe.
 #ifdef HAS_TRAY
     TrayIcon tray;
     bool tray_ok = false;
@@ -708,6 +1018,24 @@ int main(int argc, char ** argv) {
     }
 #endif
 
+    // Recording indicator overlay. X11 only; on Wayland it goes through
+    // XWayland and compositors may place it differently.
+    Osd osd;
+    bool osd_ok = false;
+    if (params.osd) {
+#ifdef HAS_OSD
+        if (display == DisplayBackend::WAYLAND) {
+            fprintf(stderr, "warning: --osd uses XWayland on Wayland\n");
+        }
+        osd_ok = osd.init();
+        if (!osd_ok) {
+            fprintf(stderr, "warning: recording indicator unavailable\n");
+        }
+#else
+        fprintf(stderr, "warning: built without X11, --osd ignored\n");
+#endif
+    }
+
     // Print info
     fprintf(stderr, "\n");
     fprintf(stderr, "whisper-typer:\n");
@@ -718,9 +1046,19 @@ int main(int argc, char ** argv) {
     fprintf(stderr, "  pid       = %d\n", (int)getpid());
     fprintf(stderr, "  mode      = %s\n", params.push_to_talk ? "push-to-talk" : "toggle");
     fprintf(stderr, "  display   = %s\n", display == DisplayBackend::WAYLAND ? "wayland" : "x11");
-    fprintf(stderr, "  clipboard = %s\n", params.use_clipboard ? "yes" : "no");
+    fprintf(stderr, "  clipboard = %s\n", (params.hybrid_output && display == DisplayBackend::X11) ? "per transcript" :
+                                           params.use_clipboard ? "yes" : "no");
+    if (atspi_ok) {
+        fprintf(stderr, "  atspi     = insert into accessible widgets first\n");
+    }
+    fprintf(stderr, "  capture   = %s, %d Hz\n", mics.lead().backend_name(), mics.lead().device_rate());
+    if (mics.multi()) {
+        fprintf(stderr, "  mics      = %zu open, best per utterance\n", mics.size());
+    }
     if (!params.vad_model_path.empty()) {
         fprintf(stderr, "  vad-model = %s\n", params.vad_model_path.c_str());
+    } else if (params.vad_adapt) {
+        fprintf(stderr, "  vad       = energy, threshold from noise floor\n");
     }
     if (!history_path.empty()) {
         fprintf(stderr, "  history   = %s\n", history_path.c_str());
@@ -732,14 +1070,242 @@ int main(int argc, char ** argv) {
     // With 2000ms request and 1000ms last_ms, we need at least 2 * WHISPER_SAMPLE_RATE samples
     const size_t vad_min_samples = (size_t)(WHISPER_SAMPLE_RATE * 2) + 1;
 
+    // Live previews decode only the newest audio, to stay cheap
+    const size_t partial_window = (size_t) WHISPER_SAMPLE_RATE * 10;
+
     // State machine
     enum class State { IDLE, RECORDING, TRANSCRIBING };
     State state = State::IDLE;
 
-    std::vector<float> pcmf32;
+    std::vector<float> pcm_live;    // new audio for the streaming VAD
     auto record_start  = std::chrono::steady_clock::now();
     auto silence_start = std::chrono::steady_clock::now();
     bool speech_detected = false;
+    auto noise_report  = std::chrono::steady_clock::now();
+    auto last_partial  = std::chrono::steady_clock::now();
+
+    // Transcription of the current utterance
+    size_t      chunk_frame     = 0;      // first VAD frame not yet handed to whisper (long-form)
+    int         n_chunks        = 0;      // jobs submitted for this utterance
+    bool        final_submitted = false;  // the last job is queued, waiting for results
+    bool        cancelling      = false;
+    size_t      n_recorded      = 0;
+    std::string session_text;             // typed so far
+    std::string held_tail;                // final punctuation of the last piece, not typed yet
+
+    // Live preview of the recording in the window and the tray tooltip
+    auto show_live = [&](const std::string & text) {
+#ifdef HAS_GUI
+        if (window_ok) window.set_live_transcript(text);
+#endif
+#ifdef HAS_TRAY
+        if (tray_ok) tray.set_tooltip(text);
+#endif
+        (void) text;
+    };
+
+    // Focused application's profile, chosen when a recording starts
+    std::optional<AppProfile> profile;
+
+    auto select_profile = [&]() {
+        profile.reset();
+        output.set_profile(nullptr);
+        if (params.profiles.empty()) return;
+
+        const std::string cls = output.focused_class();
+        const AppProfile * p  = params.profiles.find(cls);
+        if (!p) return;
+        profile = *p;
+        if (!profile->language.empty() && profile->language != "auto" &&
+            whisper_lang_id(profile->language.c_str()) == -1) {
+            fprintf(stderr, "warning: profile '%s': unknown language '%s'\n", p->name.c_str(), p->language.c_str());
+            profile->language.clear();
+        }
+        output.set_profile(&*profile);
+        fprintf(stderr, "[profile: %s]\n", p->name.c_str());
+    };
+
+    // Binding that started the recording (-1: signal or window) and its pipeline
+    int         rec_binding = -1;
+    HotkeyEvent next_start;  // pressed while transcribing: starts the next recording
+    Pipeline    pipeline;
+
+    // Kernel time of the key that stopped the recording; the audio after
+    // it is not transcribed
+    std::optional<std::chrono::steady_clock::time_point> stop_time;
+
+    // Pipeline translation and the profile's language and prompt, for
+    // every job of the utterance
+    auto setup_job = [&](auto & job) {
+        // Language and translate follow reloads: the worker's options
+        // only hold their startup values
+        job.translate = pipeline.translate || params.translate;
+        job.language  = profile && !profile->language.empty() ? profile->language : params.language;
+        if (!profile) return;
+        job.prompt = profile->prompt;
+    };
+
+    // Return to IDLE after an utterance (done, skipped or cancelled)
+    auto go_idle = [&]() {
+        state = State::IDLE;
+        profile.reset();
+        output.set_profile(nullptr);
+        rec_binding = -1;
+        pipeline    = Pipeline();
+        stop_time.reset();
+        g_cancel = false;
+        // A preview of this recording must not show up in the next one
+        inference.cancel_partial();
+        // Hand the recording's memory back and don't feed its tail to the
+        // noise floor
+        mics.end_recording();
+        pcm_live.clear();
+        pcm_live.shrink_to_fit();
+        session_text.clear();
+        held_tail.clear();
+        show_live("");
+        if (osd_ok) osd.set_state(OsdState::HIDDEN);
+#ifdef HAS_GUI
+        if (window_ok) window.set_state(AppState::IDLE);
+#endif
+#ifdef HAS_TRAY
+        if (tray_ok) tray.set_state(TrayState::IDLE);
+#endif
+        fprintf(stderr, "[ready]\n");
+    };
+
+    // Speech in VAD frames [from, to) of rec, gathered for whisper. end_sample
+    // bounds a segment still open at the last frame.
+    auto gather_speech = [&](const RecordingStore & rec, size_t from, size_t to, size_t end_sample,
+                             std::vector<float> & out) {
+        const size_t base = from * VAD_FRAME_SAMPLES;
+        std::vector<float> probs(vad.probs().begin() + from, vad.probs().begin() + to);
+        auto segments = vad_segments_from_probs(probs, end_sample - base, vad_dp);
+        for (auto & seg : segments) {
+            seg.start += base;
+            seg.end   += base;
+        }
+        rec.gather(segments, WHISPER_SAMPLE_RATE / 10, out);
+    };
+
+    // The utterance's end, after the profile and the pipeline had their say
+    auto postprocess_end = [&](const std::string & text) {
+        std::string out = profile ? profile_postprocess(*profile, text) : text;
+        if (pipeline.submit) out = strip_final_punct(out);
+        return out;
+    };
+
+    // Type the utterance's held-back end: after streamed segments, or when
+    // the last piece brought no text of its own
+    auto finish_text = [&]() {
+        const std::string tail = postprocess_end(held_tail);
+        held_tail.clear();
+        if (tail.empty()) return;
+        fprintf(stderr, "[result: \"%s\"]\n", tail.c_str());
+        output.type(tail);
+        session_text += tail;
+    };
+
+    // Type a piece of the transcript; long-form chunks and progressive
+    // segments continue the same text. While more pieces can follow, its
+    // final punctuation is held back: only the utterance's end is
+    // post-processed. The last piece is post-processed and typed at once.
+    auto type_piece = [&](const std::string & piece, bool last) {
+        // Trim whitespace (whisper often prepends a space)
+        const std::string whole = ::trim(piece);
+        std::string text = ::trim(last ? postprocess_end(whole) : strip_final_punct(whole));
+        if (text.empty()) {
+            held_tail += whole;
+            if (last) finish_text();
+            return;
+        }
+        const std::string tail = last ? "" : whole.substr(text.size());
+        if (!session_text.empty() || !held_tail.empty()) text = held_tail + " " + text;
+        held_tail = tail;
+        fprintf(stderr, "[result: \"%s\"]\n", text.c_str());
+        // Long-form chunks are typed while still recording, and paced
+        // typing can outlast the rings: keep moving audio out meanwhile
+        const bool recording = state == State::RECORDING;
+        if (recording) mics.begin_background_drain();
+        output.type(text);
+        if (recording) mics.end_background_drain();
+        session_text += text;
+    };
+
+    // Type finished transcriptions as they arrive, in order. Progressive
+    // jobs hand out their segments while later ones are still decoding.
+    // A whole result is the last piece once the final job is in and
+    // nothing else is pending.
+    auto take_results = [&]() {
+        std::string segment;
+        while (inference.poll_segment(segment)) type_piece(segment, false);
+
+        InferenceResult r;
+        while (inference.poll(r)) {
+            if (r.failed || r.streamed) continue;
+            if (r.cancelled && !params.keep_partial) continue;
+            type_piece(r.text, final_submitted && !inference.busy());
+        }
+    };
+
+    // Re-read the config file when it is saved. Applied while idle, between
+    // utterances: the main loop is the only reader of params, so replacing
+    // the hot keys' values there is the whole swap.
+    ConfigWatch config_watch;
+    const bool config_watched = have_config && config_watch.init(config_path);
+
+    auto reload_config = [&]() {
+        typer_params fresh;
+        if (!load_config_file(config_path, fresh)) return;
+        if (!typer_params_parse(argc, argv, fresh)) return;  // CLI flags still win
+
+        typer_params next = params;
+        for (const auto & k : CONFIG_KEYS) {
+            if (config_equal(params_read, fresh, k)) continue;
+            if (k.reload == ConfigReload::RESTART) {
+                fprintf(stderr, "config: %s changed, takes effect after a restart\n", k.name);
+                continue;
+            }
+            fprintf(stderr, "config: %s = %s\n", k.name, config_value(fresh, k).c_str());
+            config_copy(next, fresh, k);
+        }
+        params_read = fresh;
+        normalize_params(next, params);
+        if (next.language != "auto" && whisper_lang_id(next.language.c_str()) == -1) {
+            fprintf(stderr, "warning: unknown language '%s', keeping '%s'\n",
+                    next.language.c_str(), params.language.c_str());
+            next.language = params.language;
+        }
+
+        // Profiles are looked up per utterance and always apply
+        next.profiles = fresh.profiles;
+        if (!next.profiles.empty()) {
+            fprintf(stderr, "config: %zu app profiles\n", next.profiles.size());
+        }
+
+        // Rebind when a key changed; a table that does not bind keeps the old keys
+        const auto bindings = hotkey_bindings(next);
+        const bool same_keys = std::equal(bindings.begin(), bindings.end(),
+                                          hotkey.bindings().begin(), hotkey.bindings().end(),
+                                          [](const HotkeyBinding & a, const HotkeyBinding & b) {
+                                              return a.keys == b.keys && a.action == b.action;
+                                          });
+        if (hotkey_ok && !same_keys && !hotkey.bind(bindings)) {
+            fprintf(stderr, "config: cannot bind the new hotkeys, keeping '%s'\n", params.hotkey.c_str());
+            next.hotkey        = params.hotkey;
+            next.cancel_key    = params.cancel_key;
+            next.translate_key = params.translate_key;
+            next.command_key   = params.command_key;
+            next.retype_key    = params.retype_key;
+        }
+        params = next;
+
+        output.set_type_delay_ms(params.type_delay_ms);
+        mics.set_freq_thold(params.freq_thold);
+#ifdef HAS_GUI
+        if (window_ok) window.set_hotkey(params.hotkey);
+#endif
+    };
 
     if (hotkey_ok) {
         fprintf(stderr, "[ready] press %s to record (or kill -USR1 %d)\n", params.hotkey.c_str(), (int)getpid());
@@ -748,77 +1314,163 @@ int main(int argc, char ** argv) {
     }
 
     while (g_running) {
-        // Process GUI events before sdl_poll_events() — the upstream function
-        // drains all SDL events but only acts on SDL_QUIT. Our window.poll()
-        // must run first so ImGui receives mouse/keyboard/window events.
-        // SDL_QUIT is pushed back for sdl_poll_events() to catch.
+        // The window draws on its own thread and owns the SDL event queue
+        bool gui_events = false;
 #ifdef HAS_GUI
         if (window_ok) {
             // SIGUSR2: show window (sent by second instance or desktop launcher)
             if (g_sigusr2.exchange(false)) {
                 window.show();
             }
-            window.poll();
+            gui_events = true;
         }
 #endif
 
-#ifdef HAS_TRAY
-        if (tray_ok) tray.poll();
-#endif
+        if (osd_ok) {
+            LevelColumn col;
+            osd.tick(mics.meter().latest(&col, 1) ? col.level_db : -INFINITY);
+        }
 
-        // Handle SDL events (for Ctrl+C via SDL)
-        if (!sdl_poll_events()) {
+        // Handle SDL events (for Ctrl+C via SDL). With a window, its thread
+        // handles them and turns SDL_QUIT into on_quit.
+        if (!gui_events && !sdl_poll_events()) {
             break;
         }
 
         switch (state) {
             case State::IDLE: {
-                // Check for hotkey or SIGUSR1 toggle
-                bool triggered = hotkey.poll_pressed() || g_sigusr1.exchange(false);
+                // Nothing to cancel while idle
+                g_cancel = false;
+
+                if (config_watched && config_watch.changed()) reload_config();
+
+                // Check for a recording binding or SIGUSR1 toggle. Events
+                // after the one that starts a recording stay queued for it.
+                HotkeyEvent start = next_start;
+                next_start = HotkeyEvent();
+                if (start.binding < 0) {
+                    start = take_recording_start(hotkey.bindings(),
+                        [&](HotkeyEvent & ev) { return hotkey.poll(ev); },
+                        [&](const HotkeyEvent & ev) {
+                            if (hotkey.bindings()[ev.binding].action != HotkeyAction::RETYPE) return;
+                            if (last_transcript.empty()) return;
+                            fprintf(stderr, "[retype: \"%s\"]\n", last_transcript.c_str());
+                            output.type(last_transcript);
+                        });
+                }
+                bool key_pressed = start.binding >= 0;
+                bool triggered   = key_pressed || g_sigusr1.exchange(false);
 
                 if (triggered) {
-                    // Start recording (audio is already running, just clear buffer)
-                    audio.clear();
-                    pcmf32.clear();
-                    speech_detected = false;
-                    record_start  = std::chrono::steady_clock::now();
-                    silence_start = std::chrono::steady_clock::now();
+                    // The recording starts at the actual key-down, not at this
+                    // loop tick (up to ~70 ms later). A press queued while the
+                    // last utterance was transcribed is older than the capture
+                    // ring and starts now.
+                    auto now      = std::chrono::steady_clock::now();
+                    auto key_time = now;
+                    if (key_pressed && start.time <= now && now - start.time < std::chrono::seconds(1)) {
+                        key_time = start.time;
+                    }
 
-                    // Drain any pending hotkey events from the triggering keypress
-                    hotkey.poll_pressed();
-                    hotkey.poll_released();
+                    // The recording is the ring from pre-roll before key-down onwards
+                    mics.start_recording(key_time, params.pre_roll_ms);
+                    rec_binding = start.binding;
+                    pipeline    = pipeline_for(key_pressed ? hotkey.bindings()[start.binding].action : HotkeyAction::DICTATE);
+                    select_profile();
+                    chunk_frame     = 0;
+                    n_chunks        = 0;
+                    final_submitted = false;
+                    cancelling      = false;
+                    inference.reset_context();
+                    speech_detected = false;
+                    record_start  = key_time;
+                    silence_start = key_time;
+                    if (vad.ok()) vad.reset();
 
                     state = State::RECORDING;
+                    if (osd_ok) osd.set_state(OsdState::RECORDING);
 #ifdef HAS_GUI
                     if (window_ok) window.set_state(AppState::RECORDING);
 #endif
 #ifdef HAS_TRAY
                     if (tray_ok) tray.set_state(TrayState::RECORDING);
 #endif
-                    fprintf(stderr, "[recording...]\n");
+                    fprintf(stderr, "[recording%s...]\n", pipeline.translate ? ", translating" :
+                                                           pipeline.submit ? ", command" : "");
                     if (has_notify) notify("Recording...", 1000);
                 } else {
+                    // Track the noise floors on the audio captured since the
+                    // last tick and pick up hotplugged mics
+                    auto now = std::chrono::steady_clock::now();
+                    mics.idle_tick();
+
+                    auto & noise = mics.lead_noise();
+                    mics.meter().set_vad(noise.ready() ? noise.threshold_db() : NAN, false);
+                    if (now - noise_report >= std::chrono::seconds(5) && noise.ready()) {
+                        noise_report = now;
+#ifdef HAS_GUI
+                        if (window_ok) window.set_noise_stats(noise.floor_db(), noise.threshold_db());
+#endif
+                        if (params.print_energy) {
+                            auto r = noise.report();
+                            fprintf(stderr, "[calibration] floor = %.1f dBFS, threshold = %.1f dBFS, "
+                                    "idle p10/p50/p90 = %.1f/%.1f/%.1f dBFS (%zu frames)\n",
+                                    r.floor_db, r.threshold_db, r.p10_db, r.p50_db, r.p90_db, r.n_frames);
+                        }
+                    }
+
                     std::this_thread::sleep_for(std::chrono::milliseconds(50));
                 }
                 break;
             }
 
             case State::RECORDING: {
-                // Check for manual stop
+                // Hotkey events: cancel, or stop (release of the binding that
+                // started a push-to-talk recording, press of any recording
+                // binding in toggle mode)
+                bool cancel_pressed = g_cancel;
                 bool stop_triggered = false;
-
-                if (params.push_to_talk) {
-                    stop_triggered = hotkey.poll_released();
-                } else {
-                    stop_triggered = hotkey.poll_pressed() || g_sigusr1.exchange(false);
+                HotkeyEvent ev;
+                while (!cancel_pressed && !stop_triggered && hotkey.poll(ev)) {
+                    const HotkeyAction action = hotkey.bindings()[ev.binding].action;
+                    if (action == HotkeyAction::CANCEL) {
+                        cancel_pressed = ev.down;
+                    } else if (action == HotkeyAction::RETYPE) {
+                        continue;
+                    } else if (params.push_to_talk) {
+                        stop_triggered = !ev.down && (rec_binding < 0 || ev.binding == rec_binding);
+                    } else {
+                        stop_triggered = ev.down;
+                    }
+                    if (stop_triggered) stop_time = ev.time;
+                }
+                if (!params.push_to_talk && g_sigusr1.exchange(false)) stop_triggered = true;
+
+                // Cancel: discard the recording (and long-form chunks still
+                // being transcribed; text already typed stays)
+                if (cancel_pressed) {
+                    fprintf(stderr, "[recording cancelled]\n");
+                    if (has_notify) notify("Cancelled", 1000);
+                    if (n_chunks > 0) {
+                        n_recorded = mics.lead_recording().size();
+                        inference.cancel(params.keep_partial);
+                        cancelling      = true;
+                        final_submitted = true;
+                        state = State::TRANSCRIBING;
+                    } else {
+                        go_idle();
+                    }
+                    break;
                 }
 
+                // Manual stop
                 if (stop_triggered) {
                     // Debounce: ignore stop events within 300ms of recording start
                     // to prevent the triggering keypress from immediately stopping
                     auto since_start = std::chrono::duration_cast<std::chrono::milliseconds>(
-                        std::chrono::steady_clock::now() - record_start).count();
+                        stop_time.value_or(std::chrono::steady_clock::now()) - record_start).count();
                     if (since_start < 300) {
+                        stop_time.reset();
                         break;
                     }
 
@@ -833,24 +1485,95 @@ int main(int argc, char ** argv) {
                 auto elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
                     now - record_start).count();
 
-                if (elapsed_ms >= params.max_record_ms) {
+                const bool unlimited = params.long_form && vad.ok();
+                if (!unlimited && elapsed_ms >= params.max_record_ms) {
                     fprintf(stderr, "[max recording time reached]\n");
                     state = State::TRANSCRIBING;
                     break;
                 }
 
-                // VAD check: get last 2 seconds for energy analysis
-                {
+                // Move new audio into the recordings. The lead mic (last
+                // utterance's best) drives auto-stop.
+                mics.record_tick();
+                const RecordingStore & rec = mics.lead_recording();
+                auto &                 noise = mics.lead_noise();
+
+                // Silero VAD: classify the audio recorded since the last check
+                if (vad.ok() && vad.n_samples() < rec.size()) {
+                    rec.read(vad.n_samples(), rec.size(), pcm_live);
+                    if (!vad.push(pcm_live.data(), pcm_live.size())) {
+                        fprintf(stderr, "warning: falling back to energy VAD for auto-stop\n");
+                        vad.free();
+                    }
+                }
+                if (vad.ok()) {
+                    const auto & probs = vad.probs();
+                    if (!speech_detected) speech_detected = vad_has_speech(probs, vad_dp);
+                    mics.meter().set_vad(noise.ready() ? noise.threshold_db() : NAN,
+                                         !probs.empty() && probs.back() >= vad_dp.threshold);
+
+                    if (params.print_energy && !probs.empty()) {
+                        fprintf(stderr, "vad: p = %.2f, frames = %zu, %.2f ms\n",
+                                probs.back(), probs.size(), vad.last_push_ms());
+                    }
+
+                    // Long-form: close a chunk at a pause and transcribe it
+                    // while the recording goes on
+                    if (params.long_form) {
+                        size_t cut = vad_find_chunk_cut(probs, chunk_frame, vad_chunk, vad_dp);
+                        if (cut > 0) {
+                            InferenceJob job;
+                            setup_job(job);
+                            gather_speech(rec, chunk_frame, cut, cut * VAD_FRAME_SAMPLES, job.pcm);
+                            if (!job.pcm.empty()) {
+                                fprintf(stderr, "[transcribing chunk %d, %d ms]\n", n_chunks + 1,
+                                        (int)(job.pcm.size() * 1000.0f / WHISPER_SAMPLE_RATE));
+                                job.speech_only      = true;
+                                job.continue_context = true;
+                                job.stream           = params.progressive;
+                                inference.submit(std::move(job));
+                                n_chunks++;
+                            }
+                            chunk_frame = cut;
+                            mics.release_recording_before(cut * VAD_FRAME_SAMPLES);
+                        }
+                        take_results();
+                    }
+
+                    // Auto-stop: speech was detected, now silence for N ms
+                    if (speech_detected &&
+                        vad_trailing_silence_frames(probs, vad_dp) * VAD_FRAME_MS >= params.silence_ms) {
+                        fprintf(stderr, "[auto-stop: silence detected]\n");
+                        state = State::TRANSCRIBING;
+                        break;
+                    }
+                } else {
+                    // VAD check: get last 2 seconds for energy analysis
                     std::vector<float> vad_buf;
-                    audio.get(2000, vad_buf);
+                    const size_t span = (size_t) WHISPER_SAMPLE_RATE * 2;
+                    rec.read(rec.size() - std::min(rec.size(), span), rec.size(), vad_buf);
 
                     // Only run VAD when we have enough samples for vad_simple to work correctly.
                     // vad_simple returns false ("speech") when buffer is too small, which would
                     // cause a false positive.
                     if (vad_buf.size() >= vad_min_samples) {
-                        // vad_simple returns true when the last portion is silent
-                        bool is_silent = ::vad_simple(vad_buf, WHISPER_SAMPLE_RATE,
-                            1000, params.vad_thold, params.freq_thold, params.print_energy);
+                        bool is_silent;
+                        if (params.vad_adapt && noise.ready()) {
+                            // Compare the last second against the idle noise floor
+                            std::vector<float> last(vad_buf.end() - WHISPER_SAMPLE_RATE, vad_buf.end());
+                            ::high_pass_filter(last, params.freq_thold, WHISPER_SAMPLE_RATE);
+                            float db = energy_to_dbfs(vad_energy(last.data(), last.size()));
+                            is_silent = db < noise.threshold_db();
+                            if (params.print_energy) {
+                                fprintf(stderr, "energy: %.1f dBFS, threshold = %.1f dBFS\n", db, noise.threshold_db());
+                            }
+                        } else {
+                            // vad_simple returns true when the last portion is silent
+                            is_silent = ::vad_simple(vad_buf, WHISPER_SAMPLE_RATE,
+                                1000, params.vad_thold, params.freq_thold, params.print_energy);
+                        }
+
+                        mics.meter().set_vad(noise.ready() ? noise.threshold_db() : NAN, !is_silent);
 
                         if (!is_silent) {
                             // Speech is active
@@ -872,98 +1595,191 @@ int main(int argc, char ** argv) {
                     }
                 }
 
+                // Live preview: decode the last few seconds in the gaps
+                // between real jobs; the final decode aborts it
+                if (params.partial_ms > 0 && speech_detected &&
+                    now - last_partial >= std::chrono::milliseconds(params.partial_ms)) {
+                    last_partial = now;
+                    size_t from = rec.size() - std::min(rec.size(), partial_window);
+                    from = std::max(from, chunk_frame * VAD_FRAME_SAMPLES);
+                    PartialJob job;
+                    setup_job(job);
+                    rec.read(from, rec.size(), job.pcm);
+                    if (!job.pcm.empty()) inference.submit_partial(std::move(job));
+                }
+                {
+                    std::string partial;
+                    if (inference.poll_partial(partial)) show_live(::trim(partial));
+                }
+
                 std::this_thread::sleep_for(std::chrono::milliseconds(100));
                 break;
             }
 
             case State::TRANSCRIBING: {
-                // Get all recorded audio from the buffer before pausing
-                auto elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-                    std::chrono::steady_clock::now() - record_start).count();
+                if (!final_submitted) {
+                    final_submitted = true;
+
+                    // The rest of the recording, pre-roll included
+                    mics.record_tick();
+                    const RecordingStore * rec = &mics.lead_recording();
+                    n_recorded = rec->size();
+
+                    // Stopped by a key: the recording ends at the key event,
+                    // not at the tick that handled it
+                    if (stop_time) {
+                        n_recorded = std::max(std::min(n_recorded, mics.lead_length_at(*stop_time)),
+                                              chunk_frame * VAD_FRAME_SAMPLES);
+                    }
 
-                int get_ms = std::min((int)elapsed_ms, params.max_record_ms);
-                audio.get(get_ms, pcmf32);
+                    if (n_recorded == 0 && n_chunks == 0) {
+                        fprintf(stderr, "[no audio captured]\n");
+                        go_idle();
+                        break;
+                    }
 
-                if (pcmf32.empty()) {
-                    fprintf(stderr, "[no audio captured]\n");
-                    state = State::IDLE;
-#ifdef HAS_GUI
-                    if (window_ok) window.set_state(AppState::IDLE);
-#endif
-#ifdef HAS_TRAY
-                    if (tray_ok) tray.set_state(TrayState::IDLE);
-#endif
-                    fprintf(stderr, "[ready]\n");
-                    break;
-                }
+                    // Classify the tail, then keep only speech for whisper using the
+                    // probabilities already computed while recording
+                    if (vad.ok() && vad.n_samples() < n_recorded) {
+                        rec->read(vad.n_samples(), n_recorded, pcm_live);
+                        if (!vad.push(pcm_live.data(), pcm_live.size())) vad.free();
+                    }
+                    bool speech_only = vad.ok() && vad.n_samples() >= n_recorded;
+
+                    // Several mics heard the utterance: keep the cleanest.
+                    // Long-form sessions stay on one mic.
+                    if (mics.multi() && n_chunks == 0) {
+                        const size_t vad_source = mics.lead_index();
+                        const size_t best       = mics.select_best();
+                        if (params.print_energy) {
+                            for (size_t i = 0; i < mics.size(); i++) {
+                                fprintf(stderr, "mic: %s, SNR = %.1f dB%s\n", mics.source(i).name.c_str(),
+                                        mics.source(i).last_snr_db, i == best ? " (selected)" : "");
+                            }
+                        }
+                        // The VAD ran on the previous lead; its segments do
+                        // not carry over to another mic's stream, so whisper
+                        // gets the winner's whole recording
+                        if (best != vad_source) {
+                            rec        = &mics.lead_recording();
+                            n_recorded = rec->size();
+                            if (stop_time) {
+                                n_recorded = std::max(mics.lead_length_at(*stop_time),
+                                                      chunk_frame * VAD_FRAME_SAMPLES);
+                            }
+                            speech_only = false;
+                        }
+                    }
+
+                    // Speech is gathered straight from the recording's blocks;
+                    // otherwise whisper_full() gets the whole contiguous recording
+                    InferenceJob job;
+                    setup_job(job);
+                    job.speech_only      = speech_only;
+                    job.continue_context = n_chunks > 0;
+                    job.stream           = params.progressive;
+                    if (speech_only) {
+                        const size_t end_frame = std::min(vad.probs().size(),
+                                                          (n_recorded + VAD_FRAME_SAMPLES - 1) / VAD_FRAME_SAMPLES);
+                        gather_speech(*rec, chunk_frame, end_frame, n_recorded, job.pcm);
+                        speech_detected = !job.pcm.empty();
+                    } else if (speech_detected) {
+                        rec->read(chunk_frame * VAD_FRAME_SAMPLES, n_recorded, job.pcm);
+                    }
 
-                // Skip transcription if no speech was detected (prevent hallucinations)
-                if (!speech_detected) {
-                    fprintf(stderr, "[no speech detected, skipping]\n");
-                    state = State::IDLE;
+                    // Skip transcription if no speech was detected (prevent hallucinations)
+                    if (!speech_detected || job.pcm.empty()) {
+                        if (n_chunks == 0) {
+                            fprintf(stderr, "[no speech detected, skipping]\n");
+                            go_idle();
+                            break;
+                        }
+                    } else {
+                        fprintf(stderr, "[transcribing %d ms of audio...]\n",
+                                (int)(job.pcm.size() * 1000.0f / WHISPER_SAMPLE_RATE));
+                        inference.submit(std::move(job));
+                        n_chunks++;
+                    }
+
+                    if (osd_ok) osd.set_state(OsdState::TRANSCRIBING);
 #ifdef HAS_GUI
-                    if (window_ok) window.set_state(AppState::IDLE);
+                    if (window_ok) window.set_state(AppState::TRANSCRIBING);
 #endif
 #ifdef HAS_TRAY
-                    if (tray_ok) tray.set_state(TrayState::IDLE);
+                    if (tray_ok) tray.set_state(TrayState::TRANSCRIBING);
 #endif
-                    fprintf(stderr, "[ready]\n");
-                    break;
+                    if (has_notify) notify("Transcribing...", 2000);
                 }
 
-#ifdef HAS_GUI
-                if (window_ok) window.set_state(AppState::TRANSCRIBING);
-#endif
-#ifdef HAS_TRAY
-                if (tray_ok) tray.set_state(TrayState::TRANSCRIBING);
-#endif
-                fprintf(stderr, "[transcribing %d ms of audio...]\n", (int)(pcmf32.size() * 1000.0f / WHISPER_SAMPLE_RATE));
-                if (has_notify) notify("Transcribing...", 2000);
+                // Cancel: abort whisper; finished segments are kept with
+                // keep_partial. A recording binding pressed meanwhile starts
+                // the next recording once this one is typed; the events
+                // after it (a push-to-talk release) stay queued for it.
+                bool cancel_pressed = g_cancel;
+                if (next_start.binding < 0) {
+                    next_start = take_recording_start(hotkey.bindings(),
+                        [&](HotkeyEvent & ev) { return hotkey.poll(ev); },
+                        [&](const HotkeyEvent & ev) {
+                            if (hotkey.bindings()[ev.binding].action == HotkeyAction::CANCEL) cancel_pressed = true;
+                        });
+                }
+                if (!cancelling && cancel_pressed) {
+                    inference.cancel(params.keep_partial);
+                    cancelling = true;
+                }
 
-                std::string text = transcribe(ctx, params, pcmf32);
+                take_results();
+                if (inference.busy()) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                    break;
+                }
 
-                // Trim whitespace (whisper often prepends a space)
-                text = ::trim(text);
+                // All chunks are done
+                finish_text();
+                if (cancelling) {
+                    if (session_text.empty()) {
+                        fprintf(stderr, "[transcription cancelled]\n");
+                        if (has_notify) notify("Cancelled", 1000);
+                        go_idle();
+                        break;
+                    }
+                    fprintf(stderr, "[transcription cancelled, keeping finished segments]\n");
+                }
 
-                if (!text.empty()) {
-                    fprintf(stderr, "[result: \"%s\"]\n", text.c_str());
-                    output.type(text);
+                if (!session_text.empty()) {
+                    if (pipeline.submit && !cancelling) output.press_enter();
+                    last_transcript = session_text;
                     if (!history_path.empty()) {
-                        int dur = (int)(pcmf32.size() * 1000.0f / WHISPER_SAMPLE_RATE);
-                        history_append(history_path, text, dur, params.max_history_mb);
+                        int dur = (int)(n_recorded * 1000.0f / WHISPER_SAMPLE_RATE);
+                        history_append(history_path, session_text, dur, params.max_history_mb);
                     }
 #ifdef HAS_GUI
-                    if (window_ok) {
-                        last_transcript = text;
-                        window.set_last_transcript(text);
-                    }
+                    if (window_ok) window.set_last_transcript(session_text);
 #endif
                 } else {
                     fprintf(stderr, "[empty transcription]\n");
                 }
 
-                state = State::IDLE;
-#ifdef HAS_GUI
-                if (window_ok) window.set_state(AppState::IDLE);
-#endif
-#ifdef HAS_TRAY
-                if (tray_ok) tray.set_state(TrayState::IDLE);
-#endif
-                fprintf(stderr, "[ready]\n");
+                go_idle();
                 break;
             }
         }
     }
 
     // Cleanup
+    if (osd_ok) osd.shutdown();
 #ifdef HAS_TRAY
     if (tray_ok) tray.shutdown();
 #endif
 #ifdef HAS_GUI
     if (window_ok) window.shutdown();
+#endif
+#ifdef HAS_DBUS
+    notifier.shutdown();
 #endif
     hotkey.stop();
-    audio.pause();
+    inference.stop();
+    mics.shutdown();
     whisper_print_timings(ctx);
     whisper_free(ctx);
 
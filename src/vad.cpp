@@ -0,0 +1,75 @@
+#include "vad.h"
+
+#include "whisper.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+
+// Already classified frames replayed ahead of new audio on every push()
+// so the recurrent state has settled by the time it reaches them (256 ms)
+static constexpr size_t VAD_WARMUP_FRAMES = 8;
+
+StreamingVad::~StreamingVad() { free(); }
+
+bool StreamingVad::init(const std::string & model_path, int n_threads) {
+    free();
+
+    // The model is tiny: a GPU round trip per 32 ms frame costs more than it saves
+    whisper_vad_context_params cparams = whisper_vad_default_context_params();
+    cparams.n_threads = std::max(1, std::min(n_threads, 2));
+    cparams.use_gpu   = false;
+
+    m_ctx = whisper_vad_init_from_file_with_params(model_path.c_str(), cparams);
+    if (!m_ctx) {
+        fprintf(stderr, "vad: failed to load VAD model '%s'\n", model_path.c_str());
+        return false;
+    }
+    reset();
+    return true;
+}
+
+void StreamingVad::free() {
+    if (m_ctx) {
+        whisper_vad_free(m_ctx);
+        m_ctx = nullptr;
+    }
+}
+
+void StreamingVad::reset() {
+    m_buf.clear();
+    m_probs.clear();
+    m_n_warm       = 0;
+    m_n_samples    = 0;
+    m_last_push_ms = 0.0;
+}
+
+bool StreamingVad::push(const float * samples, size_t n) {
+    if (!m_ctx) return false;
+
+    m_buf.insert(m_buf.end(), samples, samples + n);
+    m_n_samples += n;
+
+    const size_t n_frames = m_buf.size() / VAD_FRAME_SAMPLES;
+    const size_t n_warm   = m_n_warm / VAD_FRAME_SAMPLES;
+    if (n_frames <= n_warm) return true;  // no new complete frame yet
+
+    auto t0 = std::chrono::steady_clock::now();
+    if (!whisper_vad_detect_speech(m_ctx, m_buf.data(), (int) (n_frames * VAD_FRAME_SAMPLES))) {
+        fprintf(stderr, "vad: speech detection failed\n");
+        return false;
+    }
+    m_last_push_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+
+    const int     n_probs = whisper_vad_n_probs(m_ctx);
+    const float * probs   = whisper_vad_probs(m_ctx);
+    for (size_t i = n_warm; i < n_frames && i < (size_t) n_probs; i++) {
+        m_probs.push_back(probs[i]);
+    }
+
+    // Keep the last frames as the next warm-up, plus any partial frame
+    const size_t keep = std::min(n_frames, VAD_WARMUP_FRAMES);
+    m_buf.erase(m_buf.begin(), m_buf.begin() + (n_frames - keep) * VAD_FRAME_SAMPLES);
+    m_n_warm = keep * VAD_FRAME_SAMPLES;
+    return true;
+}
@@ -0,0 +1,215 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct whisper_vad_context;
+
+// Silero VAD classifies fixed 512-sample windows (32 ms at 16 kHz)
+constexpr int VAD_FRAME_SAMPLES = 512;
+constexpr int VAD_FRAME_MS      = 32;
+
+// Speech region in samples: [start, end)
+struct VadSegment {
+    size_t start;
+    size_t end;
+};
+
+// Thresholds for turning per-frame speech probabilities into decisions.
+// Defaults follow Silero's get_speech_timestamps().
+struct VadDecisionParams {
+    float threshold          = 0.5f;   // frame is speech at or above this
+    float neg_threshold      = 0.35f;  // frame is silence below this (hysteresis)
+    int   min_speech_frames  = 8;      // 256 ms
+    int   min_silence_frames = 3;      // ~100 ms gap needed to split segments
+    int   pad_frames         = 1;      // ~30 ms padding around each segment
+};
+
+// ---- Pure logic (vad_logic.cpp), no whisper dependency ----
+
+// True if probs contain a run of at least min_speech_frames frames at or
+// above threshold.
+bool vad_has_speech(const std::vector<float> & probs, const VadDecisionParams & dp);
+
+// Number of frames at the end of probs that are below neg_threshold.
+int vad_trailing_silence_frames(const std::vector<float> & probs, const VadDecisionParams & dp);
+
+// Speech segments (in samples) from per-frame probs of a stream of
+// n_samples samples. A segment still open at the last frame extends to
+// n_samples, so a trailing partial frame is kept.
+std::vector<VadSegment> vad_segments_from_probs(const std::vector<float> & probs, size_t n_samples,
+                                                const VadDecisionParams & dp);
+
+// Long-form chunking: a chunk closes in the middle of a pause once it is
+// long enough, or at its quietest frame when no pause comes before the
+// maximum length (kept under whisper's 30 s window).
+struct VadChunkParams {
+    int min_frames   = 157;  // ~5 s
+    int max_frames   = 875;  // 28 s
+    int pause_frames = 10;   // 320 ms below neg_threshold
+};
+
+// Frame at which to close the chunk that starts at frame `from`, or 0 if it
+// stays open for now.
+size_t vad_find_chunk_cut(const std::vector<float> & probs, size_t from, const VadChunkParams & cp,
+                          const VadDecisionParams & dp);
+
+// Concatenate the speech segments of pcm into out, separated by
+// gap_samples of silence.
+void vad_gather_speech(const float * pcm, size_t n_samples, const std::vector<VadSegment> & segments,
+                       size_t gap_samples, std::vector<float> & out);
+
+// Mean absolute amplitude (the energy measure vad_simple uses)
+float vad_energy(const float * pcm, size_t n);
+
+// Energy in dB relative to full scale; silence is clamped to -120 dBFS
+float energy_to_dbfs(float energy);
+
+// One-pole high-pass, the same filter as whisper's high_pass_filter() but
+// with its state kept between calls, so a stream filtered in blocks has no
+// step at each block boundary
+class HighPassFilter {
+public:
+    void set_cutoff(float cutoff_hz, float sample_rate);
+
+    // Filter consecutive samples in place
+    void process(float * pcm, size_t n);
+
+    // Start over: the next sample passes unchanged, as for a new stream
+    void reset() { m_primed = false; }
+
+private:
+    float m_alpha  = 1.0f;
+    float m_prev_x = 0.0f;
+    float m_prev_y = 0.0f;
+    bool  m_primed = false;
+};
+
+// ---- Noise floor (vad_logic.cpp) ----
+
+// Frames the noise floor is tracked on (20 ms at 16 kHz)
+constexpr int NOISE_FRAME_SAMPLES = 320;
+
+// Tracks the background level of the idle microphone signal, per 20 ms
+// frame in dBFS. The floor follows quieter frames quickly but rises by at
+// most 1 dB/s, so keystrokes, speech and other bursts barely move it. The
+// price is a slow climb when the room really gets louder: a 20 dB step
+// takes about 20 s of idle audio.
+class NoiseFloorEstimator {
+public:
+    // Calibration summary of the frames seen since the previous report
+    struct Report {
+        float  floor_db     = 0.0f;
+        float  threshold_db = 0.0f;
+        float  p10_db       = 0.0f;
+        float  p50_db       = 0.0f;
+        float  p90_db       = 0.0f;
+        size_t n_frames     = 0;
+    };
+
+    // Feed consecutive (high-pass filtered) samples
+    void feed(const float * pcm, size_t n);
+
+    // At least one second of audio has been seen
+    bool ready() const { return m_n_frames >= 50; }
+
+    float floor_db() const { return m_floor_db; }
+
+    // Speech threshold: a fixed margin above the floor, never below a
+    // minimum so a digitally silent input does not trigger on hiss
+    float threshold_db() const;
+
+    // Keep per-frame energies for report() (off by default)
+    void set_collect(bool collect) { m_collect = collect; }
+    Report report();
+
+private:
+    bool   m_init     = false;
+    float  m_floor_db = -120.0f;
+    size_t m_n_frames = 0;
+
+    // Partial frame carried over between feed() calls
+    double m_partial_sum = 0.0;
+    int    m_partial_n   = 0;
+
+    bool               m_collect = false;
+    std::vector<float> m_frames_db;
+
+    void add_frame(float energy);
+};
+
+// Loudness of an utterance, measured while it is recorded: the 20 ms frame
+// energies the noise floor also uses, counted in a 0.1 dB histogram. Ranks
+// microphones that heard the same utterance without keeping or rereading
+// their audio.
+class UtteranceLevel {
+public:
+    // Feed consecutive (high-pass filtered) samples
+    void feed(const float * pcm, size_t n);
+
+    // Forget the previous utterance
+    void reset();
+
+    size_t n_frames() const { return m_n_frames; }
+
+    // Signal-to-noise ratio in dB: the 90th percentile of the frame
+    // energies (the loud, voiced part) above floor_db. 0 before the first
+    // whole frame.
+    float snr_db(float floor_db) const;
+
+private:
+    static constexpr int BINS = 1200;  // -120 to 0 dBFS
+
+    uint32_t m_bins[BINS] = {};
+    size_t   m_n_frames   = 0;
+
+    // Partial frame carried over between feed() calls
+    double m_partial_sum = 0.0;
+    int    m_partial_n   = 0;
+};
+
+// ---- Streaming Silero VAD (vad.cpp) ----
+
+// Runs the Silero model incrementally on audio as it arrives, keeping one
+// speech probability per 32 ms frame since reset().
+//
+// whisper_vad_detect_speech() starts every call from a zeroed LSTM state and
+// the state is not exposed. Instead of re-running the whole recording, each
+// push() replays a short warm-up window of already classified frames ahead
+// of the new ones, so the cost per call is bounded by warm-up + new frames.
+class StreamingVad {
+public:
+    StreamingVad() = default;
+    ~StreamingVad();
+
+    StreamingVad(const StreamingVad &) = delete;
+    StreamingVad & operator=(const StreamingVad &) = delete;
+
+    bool init(const std::string & model_path, int n_threads);
+    bool ok() const { return m_ctx != nullptr; }
+    void free();
+
+    // Start a new stream.
+    void reset();
+
+    // Append samples to the stream (must be contiguous since reset()) and
+    // classify every complete frame. Returns false if the model fails.
+    bool push(const float * samples, size_t n);
+
+    const std::vector<float> & probs() const { return m_probs; }
+    size_t n_samples() const { return m_n_samples; }
+
+    // Wall time of the last push() that ran the model (ms)
+    double last_push_ms() const { return m_last_push_ms; }
+
+private:
+    whisper_vad_context * m_ctx = nullptr;
+
+    std::vector<float> m_buf;          // warm-up frames, then unclassified samples
+    size_t             m_n_warm = 0;   // samples of m_buf that are warm-up
+    size_t             m_n_samples = 0;
+    std::vector<float> m_probs;
+    double             m_last_push_ms = 0.0;
+};
@@ -0,0 +1,236 @@
+// Pure logic functions for the VAD module.
+// Separated from vad.cpp so tests can link without whisper.
+
+#include "vad.h"
+
+#include <algorithm>
+#include <cmath>
+
+// Noise floor tracking (dB per 20 ms frame)
+static constexpr float NOISE_FALL_ALPHA     = 0.1f;   // toward quieter frames: ~200 ms
+static constexpr float NOISE_RISE_ALPHA     = 0.05f;  // toward louder frames ...
+static constexpr float NOISE_RISE_MAX_DB    = 0.02f;  // ... but at most 1 dB/s
+static constexpr float NOISE_MARGIN_DB      = 10.0f;  // speech threshold above the floor
+static constexpr float NOISE_MIN_THOLD_DB   = -55.0f;
+
+bool vad_has_speech(const std::vector<float> & probs, const VadDecisionParams & dp) {
+    int run = 0;
+    for (float p : probs) {
+        run = (p >= dp.threshold) ? run + 1 : 0;
+        if (run >= dp.min_speech_frames) return true;
+    }
+    return false;
+}
+
+int vad_trailing_silence_frames(const std::vector<float> & probs, const VadDecisionParams & dp) {
+    int n = 0;
+    for (auto it = probs.rbegin(); it != probs.rend() && *it < dp.neg_threshold; ++it) {
+        n++;
+    }
+    return n;
+}
+
+std::vector<VadSegment> vad_segments_from_probs(const std::vector<float> & probs, size_t n_samples,
+                                                const VadDecisionParams & dp) {
+    // Frame ranges [start, end) first, with hysteresis between the thresholds
+    std::vector<std::pair<int, int>> frames;
+    const int n_frames = (int) probs.size();
+    bool in_speech = false;
+    int  start     = 0;
+    int  temp_end  = -1;  // first silent frame of the current gap, -1 = none
+
+    for (int i = 0; i < n_frames; i++) {
+        float p = probs[i];
+        if (p >= dp.threshold) {
+            temp_end = -1;
+            if (!in_speech) {
+                in_speech = true;
+                start     = i;
+            }
+        } else if (in_speech && p < dp.neg_threshold) {
+            if (temp_end < 0) temp_end = i;
+            if (i + 1 - temp_end >= dp.min_silence_frames) {
+                if (temp_end - start >= dp.min_speech_frames) frames.push_back({start, temp_end});
+                in_speech = false;
+                temp_end  = -1;
+            }
+        }
+    }
+    if (in_speech && n_frames - start >= dp.min_speech_frames) {
+        frames.push_back({start, n_frames});
+    }
+
+    // Pad, merge overlaps, convert to samples
+    std::vector<VadSegment> segments;
+    for (const auto & f : frames) {
+        int    s     = std::max(0, f.first - dp.pad_frames);
+        int    e     = std::min(n_frames, f.second + dp.pad_frames);
+        size_t s_smp = (size_t) s * VAD_FRAME_SAMPLES;
+        size_t e_smp = (e == n_frames) ? n_samples : (size_t) e * VAD_FRAME_SAMPLES;
+        e_smp = std::min(e_smp, n_samples);
+        if (s_smp >= e_smp) continue;
+
+        if (!segments.empty() && s_smp <= segments.back().end) {
+            segments.back().end = std::max(segments.back().end, e_smp);
+        } else {
+            segments.push_back({s_smp, e_smp});
+        }
+    }
+    return segments;
+}
+
+size_t vad_find_chunk_cut(const std::vector<float> & probs, size_t from, const VadChunkParams & cp,
+                          const VadDecisionParams & dp) {
+    const size_t n = probs.size();
+    const size_t lo = from + (size_t) cp.min_frames;
+    const size_t hi = from + (size_t) cp.max_frames;
+    if (n < lo) return 0;
+
+    // First pause long enough, cut in its middle
+    int run = 0;
+    for (size_t i = from; i < std::min(n, hi); i++) {
+        run = (probs[i] < dp.neg_threshold) ? run + 1 : 0;
+        if (run >= cp.pause_frames) {
+            size_t cut = i + 1 - (size_t) cp.pause_frames / 2;
+            if (cut >= lo) return cut;
+        }
+    }
+    if (n < hi) return 0;
+
+    // No pause in time: the least speech-like frame
+    size_t best = lo;
+    for (size_t i = lo; i < hi; i++) {
+        if (probs[i] < probs[best]) best = i;
+    }
+    return best;
+}
+
+void vad_gather_speech(const float * pcm, size_t n_samples, const std::vector<VadSegment> & segments,
+                       size_t gap_samples, std::vector<float> & out) {
+    out.clear();
+    size_t total = 0;
+    for (const auto & seg : segments) total += seg.end - seg.start + gap_samples;
+    out.reserve(total);
+
+    for (size_t i = 0; i < segments.size(); i++) {
+        size_t s = std::min(segments[i].start, n_samples);
+        size_t e = std::min(segments[i].end, n_samples);
+        if (i > 0) out.insert(out.end(), gap_samples, 0.0f);
+        out.insert(out.end(), pcm + s, pcm + e);
+    }
+}
+
+float vad_energy(const float * pcm, size_t n) {
+    if (n == 0) return 0.0f;
+    double sum = 0.0;
+    for (size_t i = 0; i < n; i++) sum += std::fabs(pcm[i]);
+    return (float) (sum / n);
+}
+
+float energy_to_dbfs(float energy) {
+    return 20.0f * std::log10(std::max(energy, 1e-6f));
+}
+
+void HighPassFilter::set_cutoff(float cutoff_hz, float sample_rate) {
+    const float rc = 1.0f / (2.0f * (float) M_PI * cutoff_hz);
+    const float dt = 1.0f / sample_rate;
+    m_alpha = dt / (rc + dt);
+}
+
+void HighPassFilter::process(float * pcm, size_t n) {
+    if (n == 0) return;
+    size_t i = 0;
+    if (!m_primed) {
+        m_prev_x = m_prev_y = pcm[0];
+        m_primed = true;
+        i = 1;
+    }
+    for (; i < n; i++) {
+        const float x = pcm[i];
+        m_prev_y = m_alpha * (m_prev_y + x - m_prev_x);
+        m_prev_x = x;
+        pcm[i]   = m_prev_y;
+    }
+}
+
+void NoiseFloorEstimator::feed(const float * pcm, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        m_partial_sum += std::fabs(pcm[i]);
+        if (++m_partial_n == NOISE_FRAME_SAMPLES) {
+            add_frame((float) (m_partial_sum / NOISE_FRAME_SAMPLES));
+            m_partial_sum = 0.0;
+            m_partial_n   = 0;
+        }
+    }
+}
+
+void NoiseFloorEstimator::add_frame(float energy) {
+    float db = energy_to_dbfs(energy);
+    if (!m_init) {
+        m_floor_db = db;
+        m_init     = true;
+    } else if (db < m_floor_db) {
+        m_floor_db += (db - m_floor_db) * NOISE_FALL_ALPHA;
+    } else {
+        m_floor_db += std::min((db - m_floor_db) * NOISE_RISE_ALPHA, NOISE_RISE_MAX_DB);
+    }
+    m_n_frames++;
+    if (m_collect) m_frames_db.push_back(db);
+}
+
+float NoiseFloorEstimator::threshold_db() const {
+    return std::max(m_floor_db + NOISE_MARGIN_DB, NOISE_MIN_THOLD_DB);
+}
+
+NoiseFloorEstimator::Report NoiseFloorEstimator::report() {
+    Report r;
+    r.floor_db     = m_floor_db;
+    r.threshold_db = threshold_db();
+    r.n_frames     = m_frames_db.size();
+    if (!m_frames_db.empty()) {
+        auto pct = [this](float q) {
+            size_t k = (size_t) (q * (m_frames_db.size() - 1));
+            std::nth_element(m_frames_db.begin(), m_frames_db.begin() + k, m_frames_db.end());
+            return m_frames_db[k];
+        };
+        r.p10_db = pct(0.1f);
+        r.p50_db = pct(0.5f);
+        r.p90_db = pct(0.9f);
+    }
+    m_frames_db.clear();
+    return r;
+}
+
+void UtteranceLevel::feed(const float * pcm, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        m_partial_sum += std::fabs(pcm[i]);
+        if (++m_partial_n == NOISE_FRAME_SAMPLES) {
+            const float db  = energy_to_dbfs((float) (m_partial_sum / NOISE_FRAME_SAMPLES));
+            const int   bin = (int) ((db + 120.0f) * 10.0f);
+            m_bins[std::max(0, std::min(bin, BINS - 1))]++;
+            m_n_frames++;
+            m_partial_sum = 0.0;
+            m_partial_n   = 0;
+        }
+    }
+}
+
+void UtteranceLevel::reset() {
+    std::fill(std::begin(m_bins), std::end(m_bins), 0u);
+    m_n_frames    = 0;
+    m_partial_sum = 0.0;
+    m_partial_n   = 0;
+}
+
+float UtteranceLevel::snr_db(float floor_db) const {
+    if (m_n_frames == 0) return 0.0f;
+    // Same rank as nth_element at 0.9 * (n - 1) over the sorted frames
+    const size_t k = (size_t) (0.9f * (m_n_frames - 1));
+    size_t seen = 0;
+    int    bin  = 0;
+    for (; bin < BINS - 1; bin++) {
+        seen += m_bins[bin];
+        if (seen > k) break;
+    }
+    return (bin + 0.5f) / 10.0f - 120.0f - floor_db;
+}
@@ -1,12 +1,19 @@
 #include "window.h"
+#include "level_meter.h"
+#include "subprocess.h"
 
-#include <cerrno>
 #include <cstdio>
 #include <cstdlib>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
 #include <cstring>
 #include <fstream>
+#include <mutex>
 #include <sstream>
 #include <string>
+#include <thread>
 
 #include <SDL.h>
 #include <imgui.h>
@@ -20,30 +27,87 @@
 #endif
 
 #ifdef __linux__
-#include <fcntl.h>
 #include <sys/stat.h>
-#include <sys/wait.h>
 #include <unistd.h>
 #endif
 
+// Frames drawn after the last event, so ImGui can settle hover and
+// active states that take a frame to resolve
+static constexpr int SETTLE_FRAMES = 3;
+
+// Frame interval when vsync is unavailable
+static constexpr int FALLBACK_FRAME_MS = 16;
+
+// Level meter refresh while recording. Idle, the meter is drawn with the
+// other redraws only, so an idle window costs no wakeups.
+static constexpr int METER_RECORDING_MS = 33;
+
+// Level strip range (dBFS)
+static constexpr float METER_MIN_DB = -80.0f;
+static constexpr float METER_MAX_DB = 0.0f;
+
 struct AppWindowImpl {
     SDL_Window   * sdl_window = nullptr;
     SDL_GLContext   gl_context = nullptr;
     Uint32         window_id  = 0;
+    Uint32         wake_event = 0;  // pushed by setters from other threads
+    bool           vsync      = false;
+
+    // GUI thread; everything SDL and ImGui happens on it
+    std::thread             thread;
+    std::condition_variable init_cv;
+    bool                    init_done = false;
+    bool                    init_ok   = false;
+
+    // Guards everything below against the setters on the main thread
+    std::mutex      mutex;
+    bool            running = true;
+    bool            want_visible = false;  // requested by show()/hide()
+    bool            title_dirty  = false;
 
     WindowCallbacks callbacks;
     AppState        state = AppState::IDLE;
     std::string     last_transcript;
+    std::string     live_transcript;
     bool            visible = false;
     bool            initialized = false;
     std::string     ini_path;
     std::string     hotkey_display;
 
-    // History cache — reloaded when window becomes visible
+    // Live input levels, written by the capture callback; copied into
+    // meter_cols each frame (no per-frame allocation)
+    const LevelMeter * meter = nullptr;
+    LevelColumn        meter_cols[LevelMeter::CAPACITY];
+
+    // Microphone noise floor and derived VAD threshold (dBFS)
+    bool            has_noise_stats = false;
+    float           noise_floor_db  = 0.0f;
+    float           noise_thold_db  = 0.0f;
+
+    // History cache — reloaded when window becomes visible. The list
+    // itself is only touched by the GUI thread.
     std::vector<HistoryEntry> history;
     bool history_dirty = true;
 };
 
+// What a frame shows of the shared state, copied under the mutex so the
+// UI is built without holding it
+struct UiSnapshot {
+    AppState           state = AppState::IDLE;
+    std::string        live_transcript;
+    std::string        hotkey_display;
+    const LevelMeter * meter = nullptr;
+    bool               has_noise_stats = false;
+    float              noise_floor_db  = 0.0f;
+    float              noise_thold_db  = 0.0f;
+};
+
+// Mark the history for reloading on the next frame
+static void invalidate_history(AppWindowImpl * impl) {
+    std::lock_guard<std::mutex> lock(impl->mutex);
+    impl->history_dirty = true;
+}
+
 // Read an entire file into a string
 static std::string read_file(const std::string & path) {
     std::ifstream f(path);
@@ -67,57 +131,17 @@ static void mkdir_p(const std::string & path) {
 #endif
 }
 
-// Copy text to clipboard using xclip or wl-copy (double-fork, no zombies)
+// Copy text to clipboard using xclip or wl-copy (fire-and-forget, no zombies)
 static void copy_to_clipboard(const std::string & text) {
 #ifdef __linux__
-    int pipefd[2];
-    if (pipe(pipefd) != 0) return;
-
     const char * wayland = getenv("WAYLAND_DISPLAY");
-
-    pid_t pid = fork();
-    if (pid < 0) {
-        close(pipefd[0]);
-        close(pipefd[1]);
-        return;
-    }
-    if (pid == 0) {
-        close(pipefd[1]);
-        if (fork() != 0) {
-            close(pipefd[0]);
-            _exit(0);
-        }
-        dup2(pipefd[0], STDIN_FILENO);
-        close(pipefd[0]);
-
-        int devnull = open("/dev/null", O_WRONLY);
-        if (devnull >= 0) {
-            dup2(devnull, STDOUT_FILENO);
-            dup2(devnull, STDERR_FILENO);
-            close(devnull);
-        }
-
-        if (wayland && wayland[0] != '\0') {
-            execlp("wl-copy", "wl-copy", nullptr);
-        } else {
-            execlp("xclip", "xclip", "-selection", "clipboard", nullptr);
-        }
-        _exit(127);
-    }
-
-    close(pipefd[0]);
-    const char * data = text.c_str();
-    size_t remaining = text.size();
-    while (remaining > 0) {
-        ssize_t n = write(pipefd[1], data, remaining);
-        if (n > 0) { data += n; remaining -= n; }
-        else if (n < 0 && errno == EINTR) continue;
-        else break;
+    if (wayland && wayland[0] != '\0') {
+        const char * argv[] = {"wl-copy", nullptr};
+        spawn_detached(argv, &text);
+    } else {
+        const char * argv[] = {"xclip", "-selection", "clipboard", nullptr};
+        spawn_detached(argv, &text);
     }
-    close(pipefd[1]);
-
-    int status;
-    waitpid(pid, &status, 0);
 #else
     (void)text;
 #endif
@@ -191,8 +215,65 @@ static void delete_history_entry(const std::string & path, const HistoryEntry &
     }
 }
 
+// Map a level in dBFS to a y coordinate in a strip [top, bottom]
+static float meter_y(float db, float top, float bottom) {
+    float t = (std::clamp(db, METER_MIN_DB, METER_MAX_DB) - METER_MIN_DB) / (METER_MAX_DB - METER_MIN_DB);
+    return bottom - t * (bottom - top);
+}
+
+// Scrolling waveform (min/max per column) above a level history with the
+// VAD threshold, newest at the right
+static void render_meter(AppWindowImpl * impl, const LevelMeter & meter) {
+    ImDrawList * dl    = ImGui::GetWindowDrawList();
+    const ImVec2 p0    = ImGui::GetCursorScreenPos();
+    const float  width = std::max(1.0f, ImGui::GetContentRegionAvail().x);
+    const float  wave_h  = 48.0f;
+    const float  level_h = 32.0f;
+
+    const size_t want = std::min((size_t) width, LevelMeter::CAPACITY);
+    const size_t n    = meter.latest(impl->meter_cols, want);
+    const float  x0   = p0.x + width - (float) n;
+
+    const bool  speech    = meter.speech();
+    const float thold_db  = meter.threshold_db();
+    const ImU32 wave_col  = speech ? IM_COL32(90, 220, 90, 255) : IM_COL32(150, 150, 150, 255);
+
+    // Waveform
+    const float mid = p0.y + wave_h * 0.5f;
+    dl->AddRectFilled(p0, ImVec2(p0.x + width, p0.y + wave_h), IM_COL32(20, 20, 20, 255));
+    for (size_t i = 0; i < n; i++) {
+        const LevelColumn & c = impl->meter_cols[i];
+        const float x = x0 + (float) i;
+        dl->AddLine(ImVec2(x, mid - std::clamp(c.max, -1.0f, 1.0f) * wave_h * 0.5f),
+                    ImVec2(x, mid - std::clamp(c.min, -1.0f, 1.0f) * wave_h * 0.5f + 1.0f), wave_col);
+    }
+
+    // Level history in dB, with the threshold the energy VAD compares against
+    const float top    = p0.y + wave_h + 2.0f;
+    const float bottom = top + level_h;
+    dl->AddRectFilled(ImVec2(p0.x, top), ImVec2(p0.x + width, bottom), IM_COL32(20, 20, 20, 255));
+    for (size_t i = 0; i < n; i++) {
+        const LevelColumn & c = impl->meter_cols[i];
+        const float x = x0 + (float) i;
+        const bool above = !std::isnan(thold_db) && c.level_db >= thold_db;
+        dl->AddLine(ImVec2(x, bottom), ImVec2(x, meter_y(c.level_db, top, bottom)),
+                    above ? IM_COL32(90, 180, 255, 255) : IM_COL32(70, 110, 150, 255));
+    }
+    if (!std::isnan(thold_db)) {
+        const float y = meter_y(thold_db, top, bottom);
+        dl->AddLine(ImVec2(p0.x, y), ImVec2(p0.x + width, y), IM_COL32(255, 200, 60, 255));
+    }
+
+    ImGui::Dummy(ImVec2(width, wave_h + 2.0f + level_h));
+    const float level_db = n > 0 ? impl->meter_cols[n - 1].level_db : METER_MIN_DB;
+    ImGui::TextColored(speech ? ImVec4(0.35f, 0.9f, 0.35f, 1.0f) : ImVec4(0.6f, 0.6f, 0.6f, 1.0f),
+                       "%s", speech ? "Speech" : "Silence");
+    ImGui::SameLine();
+    ImGui::TextDisabled("  |  Input: %.0f dBFS", level_db);
+}
+
 // Render the full UI content within an ImGui frame
-static void render_ui(AppWindowImpl * impl) {
+static void render_ui(AppWindowImpl * impl, const UiSnapshot & ui) {
     ImGui::SetNextWindowPos(ImVec2(0, 0));
     ImGui::SetNextWindowSize(ImGui::GetIO().DisplaySize);
     ImGui::Begin("##main", nullptr,
@@ -203,7 +284,7 @@ static void render_ui(AppWindowImpl * impl) {
     {
         ImVec4 color;
         const char * label;
-        switch (impl->state) {
+        switch (ui.state) {
             case AppState::RECORDING:
                 color = ImVec4(1.0f, 0.3f, 0.3f, 1.0f);
                 label = "Recording...";
@@ -218,12 +299,36 @@ static void render_ui(AppWindowImpl * impl) {
                 break;
         }
         ImGui::TextColored(color, "%s", label);
+
+        if (ui.state != AppState::IDLE) {
+            ImGui::SameLine();
+            if (ImGui::SmallButton("Cancel")) {
+                if (impl->callbacks.on_cancel) impl->callbacks.on_cancel();
+            }
+        }
     }
 
     // --- Hotkey display and help ---
-    if (!impl->hotkey_display.empty()) {
+    if (!ui.hotkey_display.empty()) {
         ImGui::SameLine();
-        ImGui::TextDisabled("  |  Hotkey: %s", impl->hotkey_display.c_str());
+        ImGui::TextDisabled("  |  Hotkey: %s", ui.hotkey_display.c_str());
+    }
+
+    if (ui.has_noise_stats) {
+        ImGui::TextDisabled("Noise floor: %.0f dBFS  |  VAD threshold: %.0f dBFS",
+                            ui.noise_floor_db, ui.noise_thold_db);
+    }
+
+    if (ui.meter) {
+        ImGui::Spacing();
+        render_meter(impl, *ui.meter);
+    }
+
+    if (ui.state != AppState::IDLE && !ui.live_transcript.empty()) {
+        ImGui::Spacing();
+        ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(0.75f, 0.75f, 0.85f, 1.0f));
+        ImGui::TextWrapped("%s", ui.live_transcript.c_str());
+        ImGui::PopStyleColor();
     }
 
     ImGui::Spacing();
@@ -258,7 +363,7 @@ static void render_ui(AppWindowImpl * impl) {
                     std::ofstream out(path, std::ios::trunc);
                     // truncate to empty
                 }
-                impl->history_dirty = true;
+                invalidate_history(impl);
             }
         }
     }
@@ -301,7 +406,7 @@ static void render_ui(AppWindowImpl * impl) {
                 if (impl->callbacks.get_history_path) {
                     std::string path = impl->callbacks.get_history_path();
                     delete_history_entry(path, entry);
-                    impl->history_dirty = true;
+                    invalidate_history(impl);
                 }
             }
 
@@ -326,13 +431,8 @@ static void render_ui(AppWindowImpl * impl) {
     ImGui::End();
 }
 
-AppWindow::AppWindow() = default;
-AppWindow::~AppWindow() { shutdown(); }
-
-bool AppWindow::init(const WindowCallbacks & cb) {
-    m_impl = std::make_unique<AppWindowImpl>();
-    m_impl->callbacks = cb;
-
+// Create the window, GL context and ImGui on the calling (GUI) thread
+static bool create_window(AppWindowImpl * impl) {
     // Init SDL video subsystem (additive — audio is already init'd)
     if (SDL_InitSubSystem(SDL_INIT_VIDEO) != 0) {
         fprintf(stderr, "warning: SDL_InitSubSystem(VIDEO) failed: %s\n", SDL_GetError());
@@ -352,27 +452,30 @@ bool AppWindow::init(const WindowCallbacks & cb) {
     SDL_SetHint(SDL_HINT_IME_SHOW_UI, "1");
 #endif
 
-    m_impl->sdl_window = SDL_CreateWindow(
+    impl->sdl_window = SDL_CreateWindow(
         window_title(AppState::IDLE),
         SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED,
         520, 600,
         SDL_WINDOW_OPENGL | SDL_WINDOW_RESIZABLE | SDL_WINDOW_ALLOW_HIGHDPI | SDL_WINDOW_HIDDEN
     );
-    if (!m_impl->sdl_window) {
+    if (!impl->sdl_window) {
         fprintf(stderr, "warning: SDL_CreateWindow failed: %s\n", SDL_GetError());
         return false;
     }
-    m_impl->window_id = SDL_GetWindowID(m_impl->sdl_window);
+    impl->window_id = SDL_GetWindowID(impl->sdl_window);
 
-    m_impl->gl_context = SDL_GL_CreateContext(m_impl->sdl_window);
-    if (!m_impl->gl_context) {
+    impl->gl_context = SDL_GL_CreateContext(impl->sdl_window);
+    if (!impl->gl_context) {
         fprintf(stderr, "warning: SDL_GL_CreateContext failed: %s\n", SDL_GetError());
-        SDL_DestroyWindow(m_impl->sdl_window);
-        m_impl->sdl_window = nullptr;
+        SDL_DestroyWindow(impl->sdl_window);
+        impl->sdl_window = nullptr;
         return false;
     }
-    SDL_GL_MakeCurrent(m_impl->sdl_window, m_impl->gl_context);
-    SDL_GL_SetSwapInterval(1);  // vsync
+    SDL_GL_MakeCurrent(impl->sdl_window, impl->gl_context);
+    impl->vsync = SDL_GL_SetSwapInterval(1) == 0;
+
+    impl->wake_event = SDL_RegisterEvents(1);
+    if (impl->wake_event == (Uint32) -1) impl->wake_event = SDL_USEREVENT;
 
     // ImGui context
     IMGUI_CHECKVERSION();
@@ -382,15 +485,15 @@ bool AppWindow::init(const WindowCallbacks & cb) {
     // Set ini file path to ~/.config/whisper-typer/imgui.ini
     const char * xdg_config = getenv("XDG_CONFIG_HOME");
     if (xdg_config && xdg_config[0] != '\0') {
-        m_impl->ini_path = std::string(xdg_config) + "/whisper-typer/imgui.ini";
+        impl->ini_path = std::string(xdg_config) + "/whisper-typer/imgui.ini";
     } else {
         const char * home = getenv("HOME");
         if (home) {
-            m_impl->ini_path = std::string(home) + "/.config/whisper-typer/imgui.ini";
+            impl->ini_path = std::string(home) + "/.config/whisper-typer/imgui.ini";
         }
     }
-    if (!m_impl->ini_path.empty()) {
-        io.IniFilename = m_impl->ini_path.c_str();
+    if (!impl->ini_path.empty()) {
+        io.IniFilename = impl->ini_path.c_str();
     }
 
     io.ConfigFlags |= ImGuiConfigFlags_NavEnableKeyboard;
@@ -398,68 +501,113 @@ bool AppWindow::init(const WindowCallbacks & cb) {
     ImGui::StyleColorsDark();
 
     // Init backends
-    ImGui_ImplSDL2_InitForOpenGL(m_impl->sdl_window, m_impl->gl_context);
+    ImGui_ImplSDL2_InitForOpenGL(impl->sdl_window, impl->gl_context);
     ImGui_ImplOpenGL3_Init("#version 130");
+    return true;
+}
 
-    m_impl->initialized = true;
-
-    // Show the window
-    show();
+static void destroy_window(AppWindowImpl * impl) {
+    ImGui_ImplOpenGL3_Shutdown();
+    ImGui_ImplSDL2_Shutdown();
+    ImGui::DestroyContext();
 
-    return true;
+    if (impl->gl_context) {
+        SDL_GL_DeleteContext(impl->gl_context);
+        impl->gl_context = nullptr;
+    }
+    if (impl->sdl_window) {
+        SDL_DestroyWindow(impl->sdl_window);
+        impl->sdl_window = nullptr;
+    }
 }
 
-void AppWindow::poll() {
-    if (!m_impl || !m_impl->initialized) return;
+// Handle one SDL event. Returns true if it can change what is drawn.
+static bool handle_event(AppWindowImpl * impl, const SDL_Event & event) {
+    if (event.type == impl->wake_event) return true;
 
-    // SDL_PollEvent calls SDL_PumpEvents internally, which gathers OS-level
-    // input events. Without pumping, the window manager gets no response to
-    // its pings and declares the app "not responding."
-    SDL_Event event;
-    while (SDL_PollEvent(&event)) {
-        if (event.type == SDL_QUIT) {
-            // Re-push SDL_QUIT so the main loop's sdl_poll_events() can catch it
-            SDL_PushEvent(&event);
-            return;
-        }
+    if (event.type == SDL_QUIT) {
+        if (impl->callbacks.on_quit) impl->callbacks.on_quit();
+        return false;
+    }
 
-        // Let ImGui process all events (keyboard, mouse, window resize, etc.)
-        ImGui_ImplSDL2_ProcessEvent(&event);
+    // Let ImGui process all events (keyboard, mouse, window resize, etc.)
+    ImGui_ImplSDL2_ProcessEvent(&event);
 
-        // Handle our window's close button → hide, don't quit
-        if (event.type == SDL_WINDOWEVENT &&
-            event.window.windowID == m_impl->window_id &&
-            event.window.event == SDL_WINDOWEVENT_CLOSE) {
-            hide();
-        }
+    // Handle our window's close button → hide, don't quit
+    if (event.type == SDL_WINDOWEVENT &&
+        event.window.windowID == impl->window_id &&
+        event.window.event == SDL_WINDOWEVENT_CLOSE) {
+        std::lock_guard<std::mutex> lock(impl->mutex);
+        impl->want_visible = false;
     }
+    return true;
+}
 
-    if (!m_impl->visible) return;
+// Apply show/hide and title changes requested from other threads
+static void apply_requests(AppWindowImpl * impl) {
+    bool want_visible, title_dirty;
+    AppState state;
+    {
+        std::lock_guard<std::mutex> lock(impl->mutex);
+        want_visible = impl->want_visible;
+        title_dirty  = impl->title_dirty;
+        state        = impl->state;
+        impl->title_dirty = false;
+    }
+    if (title_dirty) {
+        SDL_SetWindowTitle(impl->sdl_window, window_title(state));
+    }
+    if (want_visible && !impl->visible) {
+        SDL_ShowWindow(impl->sdl_window);
+        SDL_RaiseWindow(impl->sdl_window);
+        // Re-activate GL context — required after SDL_ShowWindow on some compositors
+        SDL_GL_MakeCurrent(impl->sdl_window, impl->gl_context);
+        impl->visible = true;
+        std::lock_guard<std::mutex> lock(impl->mutex);
+        impl->history_dirty = true;  // reload history when shown
+    } else if (!want_visible && impl->visible) {
+        SDL_HideWindow(impl->sdl_window);
+        impl->visible = false;
+    }
+}
 
+static void draw_frame(AppWindowImpl * impl) {
     // Reload history when window becomes visible (marked dirty on show())
-    if (m_impl->history_dirty) {
-        m_impl->history_dirty = false;
-        if (m_impl->callbacks.get_history_path) {
-            std::string path = m_impl->callbacks.get_history_path();
-            if (!path.empty()) {
-                m_impl->history = parse_history(read_file(path));
-            }
+    bool reload;
+    {
+        std::lock_guard<std::mutex> lock(impl->mutex);
+        reload = impl->history_dirty;
+        impl->history_dirty = false;
+    }
+    if (reload && impl->callbacks.get_history_path) {
+        std::string path = impl->callbacks.get_history_path();
+        if (!path.empty()) {
+            impl->history = parse_history(read_file(path));
         }
     }
 
-    // Check if minimized
-    Uint32 flags = SDL_GetWindowFlags(m_impl->sdl_window);
-    if (flags & SDL_WINDOW_MINIMIZED) return;
-
     // Ensure GL context is current (can be lost after hide/show cycles)
-    SDL_GL_MakeCurrent(m_impl->sdl_window, m_impl->gl_context);
+    SDL_GL_MakeCurrent(impl->sdl_window, impl->gl_context);
 
     // Start ImGui frame
     ImGui_ImplOpenGL3_NewFrame();
     ImGui_ImplSDL2_NewFrame();
     ImGui::NewFrame();
 
-    render_ui(m_impl.get());
+    // Copy what the setters write, then build the UI unlocked: it stats,
+    // rewrites files and spawns processes, and the main loop must not wait
+    UiSnapshot ui;
+    {
+        std::lock_guard<std::mutex> lock(impl->mutex);
+        ui.state           = impl->state;
+        ui.live_transcript = impl->live_transcript;
+        ui.hotkey_display  = impl->hotkey_display;
+        ui.meter           = impl->meter;
+        ui.has_noise_stats = impl->has_noise_stats;
+        ui.noise_floor_db  = impl->noise_floor_db;
+        ui.noise_thold_db  = impl->noise_thold_db;
+    }
+    render_ui(impl, ui);
 
     // Render
     ImGui::Render();
@@ -468,63 +616,219 @@ void AppWindow::poll() {
     glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT);
     ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
-    SDL_GL_SwapWindow(m_impl->sdl_window);
+    SDL_GL_SwapWindow(impl->sdl_window);  // blocks until vblank with vsync
+}
+
+// Redraw interval for the level meter, 0 when nothing animates
+static int animation_interval(AppWindowImpl * impl) {
+    std::lock_guard<std::mutex> lock(impl->mutex);
+    if (!impl->visible || !impl->meter) return 0;
+    return impl->state == AppState::RECORDING ? METER_RECORDING_MS : 0;
+}
+
+// Columns the level meter has published, 0 without one
+static uint64_t meter_columns(AppWindowImpl * impl) {
+    std::lock_guard<std::mutex> lock(impl->mutex);
+    return impl->meter ? impl->meter->count() : 0;
+}
+
+// Sleeps in SDL_WaitEvent until something happens; draws only after
+// input, a state change pushed by a setter, while ImGui still has settle
+// frames to go, or, while recording, when the level meter has new
+// columns. Hidden or minimized windows draw nothing.
+static void gui_thread(AppWindowImpl * impl) {
+    bool ok = create_window(impl);
+    {
+        std::lock_guard<std::mutex> lock(impl->mutex);
+        impl->init_done = true;
+        impl->init_ok   = ok;
+    }
+    impl->init_cv.notify_one();
+    if (!ok) return;
+
+    int      settle = SETTLE_FRAMES;
+    uint64_t meter_drawn = 0;  // meter columns published at the last frame
+    auto     last_frame  = std::chrono::steady_clock::now();
+    while (true) {
+        {
+            std::lock_guard<std::mutex> lock(impl->mutex);
+            if (!impl->running) break;
+        }
+
+        // Idle: block until an event. Recording: until an event or the next
+        // meter frame, drawn if columns came in (a stalled stream shows
+        // nothing new, so nothing is drawn). Settling:
+        // just collect what is pending; the swap (or the fallback sleep)
+        // paces the frames.
+        SDL_Event event;
+        bool got;
+        const int anim_ms = animation_interval(impl);
+        if (settle > 0) {
+            got = SDL_PollEvent(&event) != 0;
+        } else if (anim_ms > 0) {
+            auto since = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - last_frame).count();
+            got = SDL_WaitEventTimeout(&event, (int) std::max<long long>(0, anim_ms - since)) != 0;
+            if (!got && meter_columns(impl) != meter_drawn) settle = 1;
+        } else {
+            got = SDL_WaitEvent(&event) != 0;
+        }
+        if (got) {
+            // SDL_PollEvent pumps OS events too: the window manager's pings
+            // get answered even while nothing is drawn
+            do {
+                if (handle_event(impl, event)) settle = SETTLE_FRAMES;
+            } while (SDL_PollEvent(&event));
+        }
+
+        apply_requests(impl);
+        if (!impl->visible || settle <= 0) continue;
+        if (SDL_GetWindowFlags(impl->sdl_window) & SDL_WINDOW_MINIMIZED) {
+            settle = 0;
+            continue;
+        }
+
+        if (!impl->vsync) {
+            auto next = last_frame + std::chrono::milliseconds(FALLBACK_FRAME_MS);
+            std::this_thread::sleep_until(next);
+        }
+        meter_drawn = meter_columns(impl);
+        draw_frame(impl);
+        last_frame = std::chrono::steady_clock::now();
+        settle--;
+    }
+
+    destroy_window(impl);
+}
+
+// Wake the GUI thread after changing shared state
+static void wake(AppWindowImpl * impl) {
+    SDL_Event event;
+    SDL_zero(event);
+    event.type = impl->wake_event;
+    SDL_PushEvent(&event);
+}
+
+AppWindow::AppWindow() = default;
+AppWindow::~AppWindow() { shutdown(); }
+
+bool AppWindow::init(const WindowCallbacks & cb) {
+    m_impl = std::make_unique<AppWindowImpl>();
+    m_impl->callbacks    = cb;
+    m_impl->want_visible = true;
+
+    // The GUI thread owns the window; SDL allows that on Linux as long as
+    // one thread does all video calls and event pumping
+    m_impl->thread = std::thread(gui_thread, m_impl.get());
+
+    std::unique_lock<std::mutex> lock(m_impl->mutex);
+    m_impl->init_cv.wait(lock, [this]() { return m_impl->init_done; });
+    if (!m_impl->init_ok) {
+        lock.unlock();
+        m_impl->thread.join();
+        return false;
+    }
+    m_impl->initialized = true;
+    return true;
 }
 
 void AppWindow::set_state(AppState state) {
-    if (!m_impl) return;
-    m_impl->state = state;
-    if (m_impl->sdl_window) {
-        SDL_SetWindowTitle(m_impl->sdl_window, window_title(state));
+    if (!m_impl || !m_impl->initialized) return;
+    {
+        std::lock_guard<std::mutex> lock(m_impl->mutex);
+        if (m_impl->state == state) return;
+        m_impl->state       = state;
+        m_impl->title_dirty = true;
     }
+    wake(m_impl.get());
 }
 
 void AppWindow::set_last_transcript(const std::string & text) {
-    if (!m_impl) return;
-    m_impl->last_transcript = text;
-    m_impl->history_dirty = true;  // new transcript → reload history next frame
+    if (!m_impl || !m_impl->initialized) return;
+    {
+        std::lock_guard<std::mutex> lock(m_impl->mutex);
+        m_impl->last_transcript = text;
+        m_impl->history_dirty = true;  // new transcript → reload history next frame
+    }
+    wake(m_impl.get());
+}
+
+void AppWindow::set_live_transcript(const std::string & text) {
+    if (!m_impl || !m_impl->initialized) return;
+    {
+        std::lock_guard<std::mutex> lock(m_impl->mutex);
+        if (m_impl->live_transcript == text) return;
+        m_impl->live_transcript = text;
+    }
+    wake(m_impl.get());
 }
 
 void AppWindow::set_hotkey(const std::string & hotkey) {
-    if (!m_impl) return;
-    m_impl->hotkey_display = hotkey;
+    if (!m_impl || !m_impl->initialized) return;
+    {
+        std::lock_guard<std::mutex> lock(m_impl->mutex);
+        m_impl->hotkey_display = hotkey;
+    }
+    wake(m_impl.get());
+}
+
+void AppWindow::set_level_meter(const LevelMeter * meter) {
+    if (!m_impl || !m_impl->initialized) return;
+    {
+        std::lock_guard<std::mutex> lock(m_impl->mutex);
+        m_impl->meter = meter;
+    }
+    wake(m_impl.get());
+}
+
+void AppWindow::set_noise_stats(float floor_db, float threshold_db) {
+    if (!m_impl || !m_impl->initialized) return;
+    {
+        std::lock_guard<std::mutex> lock(m_impl->mutex);
+        // Noise floors drift by fractions of a dB; only redraw for visible changes
+        const bool changed = !m_impl->has_noise_stats ||
+                             (int) floor_db != (int) m_impl->noise_floor_db ||
+                             (int) threshold_db != (int) m_impl->noise_thold_db;
+        m_impl->has_noise_stats = true;
+        m_impl->noise_floor_db  = floor_db;
+        m_impl->noise_thold_db  = threshold_db;
+        if (!changed) return;
+    }
+    wake(m_impl.get());
 }
 
 void AppWindow::show() {
-    if (!m_impl || !m_impl->sdl_window) return;
-    SDL_ShowWindow(m_impl->sdl_window);
-    SDL_RaiseWindow(m_impl->sdl_window);
-    // Re-activate GL context — required after SDL_ShowWindow on some compositors
-    SDL_GL_MakeCurrent(m_impl->sdl_window, m_impl->gl_context);
-    m_impl->visible = true;
-    m_impl->history_dirty = true;  // reload history when shown
+    if (!m_impl || !m_impl->initialized) return;
+    {
+        std::lock_guard<std::mutex> lock(m_impl->mutex);
+        m_impl->want_visible = true;
+    }
+    wake(m_impl.get());
 }
 
 void AppWindow::hide() {
-    if (!m_impl || !m_impl->sdl_window) return;
-    SDL_HideWindow(m_impl->sdl_window);
-    m_impl->visible = false;
+    if (!m_impl || !m_impl->initialized) return;
+    {
+        std::lock_guard<std::mutex> lock(m_impl->mutex);
+        m_impl->want_visible = false;
+    }
+    wake(m_impl.get());
 }
 
 bool AppWindow::is_visible() const {
-    return m_impl && m_impl->visible;
+    if (!m_impl || !m_impl->initialized) return false;
+    std::lock_guard<std::mutex> lock(m_impl->mutex);
+    return m_impl->want_visible;
 }
 
 void AppWindow::shutdown() {
     if (!m_impl || !m_impl->initialized) return;
-
-    ImGui_ImplOpenGL3_Shutdown();
-    ImGui_ImplSDL2_Shutdown();
-    ImGui::DestroyContext();
-
-    if (m_impl->gl_context) {
-        SDL_GL_DeleteContext(m_impl->gl_context);
-        m_impl->gl_context = nullptr;
-    }
-    if (m_impl->sdl_window) {
-        SDL_DestroyWindow(m_impl->sdl_window);
-        m_impl->sdl_window = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(m_impl->mutex);
+        m_impl->running = false;
     }
+    wake(m_impl.get());
+    if (m_impl->thread.joinable()) m_impl->thread.join();
 
     m_impl->initialized = false;
 }
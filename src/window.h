@@ -6,6 +6,7 @@
 #include <vector>
 
 struct AppWindowImpl;
+class LevelMeter;
 
 // A single parsed history entry
 struct HistoryEntry {
@@ -41,11 +42,15 @@ inline const char * window_title(AppState state) {
 
 struct WindowCallbacks {
     std::function<void()> on_toggle;
+    std::function<void()> on_cancel;
     std::function<void()> on_quit;
     std::function<std::string()> get_last_transcript;
     std::function<std::string()> get_history_path;
 };
 
+// Settings and history window. Runs on its own thread, which owns the SDL
+// window, the GL context and ImGui and redraws only on input or when a
+// setter changes what is shown; the setters can be called from any thread.
 class AppWindow {
 public:
     AppWindow();
@@ -55,10 +60,14 @@ public:
     AppWindow & operator=(const AppWindow &) = delete;
 
     bool init(const WindowCallbacks & cb);
-    void poll();
     void set_state(AppState state);
     void set_last_transcript(const std::string & text);
+    // Preview of what is being said, from partial decodes (empty to clear)
+    void set_live_transcript(const std::string & text);
     void set_hotkey(const std::string & hotkey);
+    void set_noise_stats(float floor_db, float threshold_db);
+    // Live waveform and input level; meter must outlive the window
+    void set_level_meter(const LevelMeter * meter);
     void show();
     void hide();
     bool is_visible() const;
@@ -0,0 +1,129 @@
+// Unit tests for CaptureRing (capture_ring.cpp), no audio device required
+
+#include "capture.h"
+
+#include <cassert>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+static int tests_run = 0;
+static int tests_passed = 0;
+
+static void check(const char * name, bool condition) {
+    tests_run++;
+    printf("  %s ... %s\n", name, condition ? "ok" : "FAILED");
+    if (condition) tests_passed++;
+    assert(condition);
+}
+
+// Sample value for stream position i (exact in float up to 2^20)
+static float value_at(uint64_t i) {
+    return (float) (i & 0xFFFFF);
+}
+
+static void write_range(CaptureRing & ring, uint64_t from, size_t n) {
+    std::vector<float> buf(n);
+    for (size_t i = 0; i < n; i++) buf[i] = value_at(from + i);
+    ring.write(buf.data(), n);
+}
+
+static bool matches(const std::vector<float> & out, uint64_t start) {
+    for (size_t i = 0; i < out.size(); i++) {
+        if (out[i] != value_at(start + i)) return false;
+    }
+    return true;
+}
+
+void test_capacity() {
+    CaptureRing ring(1000);
+    check("capacity_pow2",    ring.capacity() == 1024);
+    check("starts_empty",     ring.position() == 0 && ring.oldest() == 0);
+}
+
+void test_read_positions() {
+    CaptureRing ring(1024);
+    write_range(ring, 0, 300);
+    std::vector<float> out;
+
+    uint64_t start = ring.read(100, 200, out);
+    check("read_range_start", start == 100);
+    check("read_range_data",  out.size() == 100 && matches(out, 100));
+
+    start = ring.read(250, 1000, out);
+    check("read_clamps_to_position", start == 250 && out.size() == 50 && matches(out, 250));
+
+    start = ring.read(400, 500, out);
+    check("read_future_empty", out.empty() && start == 300);
+}
+
+void test_wraparound() {
+    CaptureRing ring(1024);
+    write_range(ring, 0, 1000);
+    write_range(ring, 1000, 500);  // wraps
+    std::vector<float> out;
+
+    check("oldest_after_wrap", ring.oldest() == 1500 - 1024);
+
+    uint64_t start = ring.read(900, 1500, out);
+    check("read_across_wrap", start == 900 && out.size() == 600 && matches(out, 900));
+
+    start = ring.read(0, 1500, out);
+    check("read_clamps_to_oldest", start == ring.oldest() && out.size() == 1024 && matches(out, start));
+}
+
+void test_oversized_write() {
+    CaptureRing ring(256);
+    write_range(ring, 0, 1000);
+    std::vector<float> out;
+    check("oversized_position", ring.position() == 1000);
+    uint64_t start = ring.read(0, 1000, out);
+    check("oversized_keeps_newest", start == 1000 - 256 && out.size() == 256 && matches(out, start));
+}
+
+void test_reset() {
+    CaptureRing ring(256);
+    write_range(ring, 0, 100);
+    ring.reset(512);
+    check("reset_rewinds", ring.position() == 0 && ring.capacity() == 512);
+}
+
+void test_concurrent() {
+    // Small ring, writer far ahead of the reader: whatever read() returns
+    // must be intact and contiguous from the position it reports
+    CaptureRing ring(4096);
+    const uint64_t total = 2000000;
+    std::thread writer([&]() {
+        uint64_t pos = 0;
+        while (pos < total) {
+            size_t n = 64 + (size_t) (pos % 200);
+            write_range(ring, pos, n);
+            pos += n;
+        }
+    });
+
+    bool ok = true;
+    std::vector<float> out;
+    uint64_t next = 0;
+    while (ring.position() < total) {
+        uint64_t start = ring.read(next, ring.position(), out);
+        if (!matches(out, start)) ok = false;
+        next = start + out.size();
+    }
+    writer.join();
+    check("concurrent_reads_intact", ok);
+}
+
+int main() {
+    printf("test_capture_ring:\n");
+
+    test_capacity();
+    test_read_positions();
+    test_wraparound();
+    test_oversized_write();
+    test_reset();
+    test_concurrent();
+
+    printf("\n%d/%d tests passed\n", tests_passed, tests_run);
+    return (tests_passed == tests_run) ? 0 : 1;
+}
@@ -0,0 +1,74 @@
+// Unit tests for ConfigWatch (config_watch.cpp)
+
+#include "config_watch.h"
+
+#include <cassert>
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+#include <unistd.h>
+
+static int tests_run = 0;
+static int tests_passed = 0;
+
+static void check(const char * name, bool condition) {
+    tests_run++;
+    printf("  %s ... %s\n", name, condition ? "ok" : "FAILED");
+    if (condition) tests_passed++;
+    assert(condition);
+}
+
+static void write_file(const std::string & path, const char * text) {
+    std::ofstream out(path, std::ios::trunc);
+    out << text;
+}
+
+void test_watch() {
+    char dir[] = "/tmp/test_config_watch_XXXXXX";
+    check("mkdtemp", mkdtemp(dir) != nullptr);
+    const std::string path  = std::string(dir) + "/config";
+    const std::string other = std::string(dir) + "/other";
+    const std::string tmp   = std::string(dir) + "/config.tmp";
+
+    ConfigWatch w;
+    check("init_without_file", w.init(path));
+    check("quiet_initially",   !w.changed());
+
+    write_file(path, "silence-ms=800\n");
+    check("write_seen",        w.changed());
+    check("consumed",          !w.changed());
+
+    write_file(path, "silence-ms=900\n");
+    write_file(path, "silence-ms=1000\n");
+    check("saves_coalesced",   w.changed() && !w.changed());
+
+    write_file(other, "x\n");
+    check("other_file_ignored", !w.changed());
+
+    // Editors that save by renaming a temporary file into place
+    write_file(tmp, "silence-ms=700\n");
+    check("tmp_ignored",       !w.changed());
+    check("rename",            rename(tmp.c_str(), path.c_str()) == 0);
+    check("rename_seen",       w.changed());
+
+    unlink(path.c_str());
+    unlink(other.c_str());
+    rmdir(dir);
+}
+
+void test_missing_dir() {
+    ConfigWatch w;
+    check("missing_dir_fails",    !w.init("/nonexistent/whisper-typer/config"));
+    check("failed_never_changes", !w.changed());
+}
+
+int main() {
+    printf("test_config_watch:\n");
+
+    test_watch();
+    test_missing_dir();
+
+    printf("\n%d/%d tests passed\n", tests_passed, tests_run);
+    return (tests_passed == tests_run) ? 0 : 1;
+}
@@ -1,6 +1,6 @@
-// Unit tests for name_to_evdev() from hotkey.cpp
+// Unit tests for name_to_evdev(), parse_hotkey() and KeyMatcher from hotkey.cpp
 //
-// Include the source file directly to access the static function.
+// Include the source file directly to access the static functions.
 
 #include "hotkey.h"
 #include "hotkey.cpp"
@@ -8,6 +8,8 @@
 #include <cassert>
 #include <cstdio>
 #include <linux/input.h>
+#include <utility>
+#include <vector>
 
 static int tests_run = 0;
 static int tests_passed = 0;
@@ -62,10 +64,354 @@ void test_name_to_evdev() {
     check("case_insensitive_period", name_to_evdev("Period") == KEY_DOT);
 }
 
+void test_parse_hotkey() {
+    int code = 0;
+    unsigned int mods = 0;
+
+    check("parse_plain_key",       parse_hotkey("escape", code, mods) && code == KEY_ESC && mods == 0);
+    check("parse_ctrl_period",     parse_hotkey("ctrl+period", code, mods) && code == KEY_DOT && mods == MOD_CTRL);
+    check("parse_multi_mods",      parse_hotkey("ctrl+shift+space", code, mods) && code == KEY_SPACE &&
+                                   mods == (MOD_CTRL | MOD_SHIFT));
+    check("parse_whitespace",      parse_hotkey(" super + v ", code, mods) && code == KEY_V && mods == MOD_SUPER);
+    check("parse_unknown_mod",     !parse_hotkey("hyper+a", code, mods));
+    check("parse_unknown_key",     !parse_hotkey("ctrl+notakey", code, mods));
+    check("parse_empty",           !parse_hotkey("", code, mods));
+}
+
+using Transitions = std::vector<std::pair<int, bool>>;
+
+static KeyMatcher::time_point at_ms(int ms) {
+    return KeyMatcher::time_point(std::chrono::milliseconds(ms));
+}
+
+// Transitions emitted by a KeyMatcher, as (binding, down) pairs, and their times
+struct Recorder {
+    KeyMatcher m;
+    Transitions out;
+    std::vector<KeyMatcher::time_point> times;
+
+    void emit(int binding, bool down, KeyMatcher::time_point t) {
+        out.push_back({binding, down});
+        times.push_back(t);
+    }
+    void feed(int code, int value, int ms = 0) {
+        m.feed(code, value, at_ms(ms), [&](int b, bool d, KeyMatcher::time_point t) { emit(b, d, t); });
+    }
+    void tick(int ms) {
+        m.tick(at_ms(ms), [&](int b, bool d, KeyMatcher::time_point t) { emit(b, d, t); });
+    }
+    void clear() {
+        out.clear();
+        times.clear();
+    }
+};
+
+static KeyMatcher::Binding binding(const char * keys) {
+    KeyMatcher::Binding b;
+    bool ok = parse_binding(keys, b);
+    assert(ok);
+    (void) ok;
+    return b;
+}
+
+void test_parse_binding() {
+    KeyMatcher::Binding b;
+    check("binding_plain",         parse_binding("ctrl+period", b) && b.gesture == Gesture::PRESS &&
+                                   b.key_code == KEY_DOT && b.modmask == MOD_CTRL);
+    check("binding_modifier_tap",  parse_binding("rightctrl", b) && b.gesture == Gesture::TAP &&
+                                   b.key_code == KEY_RIGHTCTRL && b.modmask == MOD_CTRL);
+    check("binding_modifier_alias", parse_binding("altgr", b) && b.key_code == KEY_RIGHTALT);
+    check("binding_double",        parse_binding("double+ctrl_r", b) && b.gesture == Gesture::DOUBLE &&
+                                   b.key_code == KEY_RIGHTCTRL);
+    check("binding_double_combo",  parse_binding("Double + ctrl+space", b) && b.gesture == Gesture::DOUBLE &&
+                                   b.key_code == KEY_SPACE && b.modmask == MOD_CTRL);
+    check("binding_hold",          parse_binding("hold+f9", b) && b.gesture == Gesture::HOLD &&
+                                   b.hold == KeyMatcher::HOLD_TIME && b.key_code == KEY_F9);
+    check("binding_hold_ms",       parse_binding("hold800+super_r", b) && b.gesture == Gesture::HOLD &&
+                                   b.hold == std::chrono::milliseconds(800) && b.modmask == MOD_SUPER);
+    check("binding_bad_hold",      !parse_binding("hold8x+f9", b));
+    check("binding_bad_key",       !parse_binding("double+notakey", b));
+
+    check("conflict_same",         bindings_conflict(binding("f9"), binding("f9")));
+    check("conflict_press_gesture", bindings_conflict(binding("f9"), binding("double+f9")));
+    check("no_conflict_gestures",  !bindings_conflict(binding("double+f9"), binding("hold+f9")));
+    check("no_conflict_keys",      !bindings_conflict(binding("f9"), binding("f10")));
+}
+
+void test_matcher() {
+    Recorder r;
+    r.m.set_table({ binding("ctrl+period"), binding("ctrl+t"), binding("escape") });
+
+    check("bitmap_bound",          r.m.bound(KEY_DOT) && r.m.bound(KEY_T) && r.m.bound(KEY_ESC));
+    check("bitmap_unbound",        !r.m.bound(KEY_A) && !r.m.bound(KEY_LEFTCTRL) && !r.m.bound(-1) &&
+                                   !r.m.bound(KEY_CNT));
+
+    // ctrl+. down and up
+    r.feed(KEY_LEFTCTRL, 1);
+    r.feed(KEY_DOT, 1);
+    r.feed(KEY_DOT, 2);  // repeat
+    r.feed(KEY_DOT, 0);
+    check("press_release",         r.out == (Transitions{ {0, true}, {0, false} }));
+
+    // Second binding on the same modifier
+    r.out.clear();
+    r.feed(KEY_T, 1);
+    r.feed(KEY_T, 0);
+    check("second_binding",        r.out == (Transitions{ {1, true}, {1, false} }));
+
+    // Escape needs no modifiers: ignored while ctrl is held
+    r.out.clear();
+    r.feed(KEY_ESC, 1);
+    r.feed(KEY_ESC, 0);
+    check("extra_mod_rejected",    r.out.empty());
+    r.feed(KEY_LEFTCTRL, 0);
+    r.feed(KEY_ESC, 1);
+    check("plain_key",             r.out == (Transitions{ {2, true} }));
+    r.feed(KEY_ESC, 0);
+
+    // Releasing the modifier first ends the binding
+    r.out.clear();
+    r.feed(KEY_RIGHTCTRL, 1);
+    r.feed(KEY_DOT, 1);
+    r.feed(KEY_RIGHTCTRL, 0);
+    r.feed(KEY_DOT, 0);
+    check("modifier_release_ends", r.out == (Transitions{ {0, true}, {0, false} }));
+
+    // Two bindings held at once, released in any order
+    r.out.clear();
+    r.feed(KEY_LEFTCTRL, 1);
+    r.feed(KEY_DOT, 1);
+    r.feed(KEY_T, 1);
+    r.feed(KEY_DOT, 0);
+    r.feed(KEY_T, 0);
+    check("overlapping",           r.out == (Transitions{
+                                       {0, true}, {1, true}, {0, false}, {1, false} }));
+
+    // Unbound keys and a release without a press do nothing
+    r.out.clear();
+    r.feed(KEY_A, 1);
+    r.feed(KEY_A, 0);
+    r.feed(KEY_T, 0);
+    check("unbound_ignored",       r.out.empty());
+
+    // A new table forgets held bindings
+    r.feed(KEY_DOT, 1);
+    r.m.set_table({ binding("ctrl+space") });
+    r.out.clear();
+    r.feed(KEY_DOT, 0);
+    r.feed(KEY_SPACE, 1);
+    check("set_table",             r.out == (Transitions{ {0, true} }) &&
+                                   !r.m.bound(KEY_DOT));
+
+    // release_all() ends held bindings and drops held modifiers
+    r.out.clear();
+    r.m.release_all(at_ms(0), [&](int b, bool d, KeyMatcher::time_point t) { r.emit(b, d, t); });
+    check("release_all",           r.out == (Transitions{ {0, false} }));
+    r.out.clear();
+    r.feed(KEY_SPACE, 0);
+    r.feed(KEY_SPACE, 1);
+    check("release_all_modifiers", r.out.empty());
+}
+
+// Key state bitmap as returned by EVIOCGKEY
+struct KeyState {
+    static constexpr int BITS = 8 * sizeof(unsigned long);
+    unsigned long bits[(KEY_CNT + BITS - 1) / BITS] = {};
+
+    KeyState & down(int code) {
+        bits[code / BITS] |= 1UL << (code % BITS);
+        return *this;
+    }
+};
+
+void test_resync() {
+    Recorder r;
+    r.m.set_table({ binding("ctrl+period"), binding("ctrl+t") });
+    r.feed(KEY_LEFTCTRL, 1);
+    r.feed(KEY_DOT, 1);
+    r.feed(KEY_T, 1);
+    r.out.clear();
+
+    // Events were dropped; ctrl and . are still held, t was released
+    auto resync = [&](const KeyState & k) {
+        r.m.resync(k.bits, at_ms(0), [&](int b, bool d, KeyMatcher::time_point t) { r.emit(b, d, t); });
+    };
+    resync(KeyState().down(KEY_LEFTCTRL).down(KEY_DOT));
+    check("resync_releases_up_key", r.out == (Transitions{ {1, false} }));
+
+    // Ctrl released during the overflow ends the other binding
+    r.out.clear();
+    resync(KeyState().down(KEY_DOT));
+    check("resync_modifier_up",     r.out == (Transitions{ {0, false} }));
+
+    // Modifier state is read back: ctrl held again makes ctrl+t match
+    r.out.clear();
+    resync(KeyState().down(KEY_RIGHTCTRL));
+    r.feed(KEY_T, 1);
+    check("resync_reads_modifiers", r.out == (Transitions{ {1, true} }));
+}
+
+void test_gestures() {
+    // Modifier on its own: a quick tap, alone
+    Recorder r;
+    r.m.set_table({ binding("rightctrl"), binding("double+f9"), binding("hold+f10") });
+    r.feed(KEY_RIGHTCTRL, 1, 1000);
+    r.feed(KEY_RIGHTCTRL, 0, 1100);
+    check("tap",                   r.out == (Transitions{ {0, true}, {0, false} }) &&
+                                   r.times[0] == at_ms(1000) && r.times[1] == at_ms(1100));
+
+    r.clear();
+    r.feed(KEY_RIGHTCTRL, 1, 2000);
+    r.feed(KEY_C, 1, 2050);  // ctrl+c
+    r.feed(KEY_C, 0, 2080);
+    r.feed(KEY_RIGHTCTRL, 0, 2100);
+    check("tap_chord_ignored",     r.out.empty());
+
+    r.feed(KEY_RIGHTCTRL, 1, 3000);
+    r.feed(KEY_RIGHTCTRL, 2, 3300);  // repeats do not interrupt
+    r.feed(KEY_RIGHTCTRL, 0, 3500);
+    check("tap_too_long",          r.out.empty());
+
+    // Double tap: down on the second press, up on its release
+    r.feed(KEY_F9, 1, 4000);
+    r.feed(KEY_F9, 0, 4080);
+    check("double_first_tap",      r.out.empty());
+    r.feed(KEY_F9, 1, 4250);
+    check("double_second_press",   r.out == (Transitions{ {1, true} }) && r.times[0] == at_ms(4250));
+    r.feed(KEY_F9, 0, 6000);
+    check("double_hold_release",   r.out == (Transitions{ {1, true}, {1, false} }));
+
+    r.clear();
+    r.feed(KEY_F9, 1, 7000);
+    r.feed(KEY_F9, 0, 7080);
+    r.feed(KEY_F9, 1, 7500);  // gap too long: a new first tap
+    r.feed(KEY_F9, 0, 7580);
+    check("double_gap_too_long",   r.out.empty());
+    r.feed(KEY_F9, 1, 7700);  // ...completed by this one
+    check("double_restart",        r.out == (Transitions{ {1, true} }));
+    r.feed(KEY_F9, 0, 7750);
+
+    r.clear();
+    r.feed(KEY_F9, 1, 8000);
+    r.feed(KEY_F9, 0, 8080);
+    r.feed(KEY_A, 1, 8100);   // typing in between
+    r.feed(KEY_A, 0, 8120);
+    r.feed(KEY_F9, 1, 8200);
+    check("double_interrupted",    r.out.empty());
+    r.feed(KEY_F9, 0, 8250);
+
+    // Long press: down once the threshold passes, stamped with the press
+    r.feed(KEY_F10, 1, 9000);
+    r.tick(9400);
+    check("hold_not_yet",          r.out.empty());
+    r.tick(9520);
+    check("hold_fires",            r.out == (Transitions{ {2, true} }) && r.times[0] == at_ms(9000));
+    r.tick(9600);
+    check("hold_fires_once",       r.out.size() == 1);
+    r.feed(KEY_F10, 0, 9900);
+    check("hold_release",          r.out == (Transitions{ {2, true}, {2, false} }) && r.times[1] == at_ms(9900));
+
+    r.clear();
+    r.feed(KEY_F10, 1, 10000);
+    r.feed(KEY_F10, 0, 10200);
+    r.tick(10600);
+    check("hold_short_press",      r.out.empty());
+
+    r.feed(KEY_F10, 1, 11000);
+    r.feed(KEY_A, 1, 11100);
+    r.tick(11600);
+    check("hold_interrupted",      r.out.empty());
+    r.feed(KEY_A, 0, 11700);
+    r.feed(KEY_F10, 0, 11800);
+
+    // Other keys do not end an active gesture binding
+    r.feed(KEY_F10, 1, 12000);
+    r.tick(12500);
+    r.feed(KEY_A, 1, 12600);
+    r.feed(KEY_A, 0, 12650);
+    check("active_survives_typing", r.out == (Transitions{ {2, true} }));
+    r.feed(KEY_F10, 0, 13000);
+
+    // Modifier hold: the modifier's own flag does not count as extra
+    Recorder h;
+    h.m.set_table({ binding("hold+rightctrl"), binding("ctrl+period") });
+    h.feed(KEY_RIGHTCTRL, 1, 0);
+    h.tick(600);
+    check("modifier_hold",         h.out == (Transitions{ {0, true} }));
+    h.feed(KEY_RIGHTCTRL, 0, 900);
+    check("modifier_hold_release", h.out == (Transitions{ {0, true}, {0, false} }));
+
+    // ...and ctrl+. still works with the same ctrl key
+    h.clear();
+    h.feed(KEY_RIGHTCTRL, 1, 1000);
+    h.feed(KEY_DOT, 1, 1100);
+    h.tick(1700);
+    check("modifier_hold_chord",   h.out == (Transitions{ {1, true} }));
+    h.feed(KEY_DOT, 0, 1800);
+    h.feed(KEY_RIGHTCTRL, 0, 1900);
+
+    // Held gesture bindings end on release_all
+    h.clear();
+    h.feed(KEY_RIGHTCTRL, 1, 2000);
+    h.tick(2600);
+    h.m.release_all(at_ms(2700), [&](int b, bool d, KeyMatcher::time_point t) { h.emit(b, d, t); });
+    check("gesture_release_all",   h.out == (Transitions{ {0, true}, {0, false} }));
+    h.tick(3500);
+    check("release_all_resets",    h.out.size() == 2);
+}
+
+void test_take_recording_start() {
+    const std::vector<HotkeyBinding> bindings = {
+        { "ctrl+period", HotkeyAction::DICTATE },
+        { "escape",      HotkeyAction::CANCEL  },
+        { "ctrl+r",      HotkeyAction::RETYPE  },
+    };
+    std::vector<HotkeyEvent> queue;
+    size_t head = 0;
+    auto push = [&](int binding, bool down) {
+        HotkeyEvent ev;
+        ev.binding = binding;
+        ev.down    = down;
+        queue.push_back(ev);
+    };
+    auto poll = [&](HotkeyEvent & ev) {
+        if (head == queue.size()) return false;
+        ev = queue[head++];
+        return true;
+    };
+    int presses = 0;
+    auto on_press = [&](const HotkeyEvent &) { presses++; };
+
+    // Push-to-talk press and release made while transcribing: the release
+    // stays queued for the recording the press starts
+    push(0, false);  // release of the previous recording's key
+    push(2, true);
+    push(2, false);
+    push(0, true);
+    push(0, false);
+    HotkeyEvent start = take_recording_start(bindings, poll, on_press);
+    check("start_is_press",        start.binding == 0 && start.down);
+    check("start_other_presses",   presses == 1);
+    HotkeyEvent rest;
+    check("start_release_queued",  poll(rest) && rest.binding == 0 && !rest.down);
+
+    check("start_none_when_empty", take_recording_start(bindings, poll, on_press).binding < 0);
+
+    push(1, true);
+    push(1, false);
+    check("start_cancel_only",     take_recording_start(bindings, poll, on_press).binding < 0 && presses == 2);
+}
+
 int main() {
     printf("test_hotkey:\n");
 
     test_name_to_evdev();
+    test_parse_hotkey();
+    test_matcher();
+    test_resync();
+    test_parse_binding();
+    test_gestures();
+    test_take_recording_start();
 
     printf("\n%d/%d tests passed\n", tests_passed, tests_run);
     return (tests_passed == tests_run) ? 0 : 1;
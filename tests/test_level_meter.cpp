@@ -0,0 +1,84 @@
+// Unit tests for LevelMeter and LevelDecimator (level_meter.cpp)
+
+#include "level_meter.h"
+
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+static int tests_run = 0;
+static int tests_passed = 0;
+
+static void check(const char * name, bool condition) {
+    tests_run++;
+    printf("  %s ... %s\n", name, condition ? "ok" : "FAILED");
+    if (condition) tests_passed++;
+    assert(condition);
+}
+
+void test_publish_latest() {
+    LevelMeter m;
+    LevelColumn out[LevelMeter::CAPACITY];
+    check("empty", m.latest(out, 10) == 0);
+
+    for (int i = 0; i < 5; i++) m.publish({-0.1f * i, 0.1f * i, -60.0f + i});
+    check("count", m.count() == 5);
+    check("fewer_than_asked", m.latest(out, 10) == 5);
+    check("oldest_first", out[0].level_db == -60.0f && out[4].level_db == -56.0f);
+    check("newest_only", m.latest(out, 2) == 2 && out[0].level_db == -57.0f && out[1].level_db == -56.0f);
+
+    // Wraps around: only the newest CAPACITY columns are kept
+    for (size_t i = 0; i < LevelMeter::CAPACITY + 7; i++) m.publish({0.0f, 0.0f, (float) i});
+    size_t n = m.latest(out, LevelMeter::CAPACITY * 2);
+    check("capped_at_capacity", n == LevelMeter::CAPACITY);
+    check("wrapped_order", out[0].level_db == 7.0f && out[n - 1].level_db == (float) (LevelMeter::CAPACITY + 6));
+}
+
+void test_vad_state() {
+    LevelMeter m;
+    check("no_threshold_initially", std::isnan(m.threshold_db()) && !m.speech());
+    m.set_vad(-42.0f, true);
+    check("threshold", m.threshold_db() == -42.0f);
+    check("speech",    m.speech());
+    m.set_vad(NAN, false);
+    check("no_threshold", std::isnan(m.threshold_db()) && !m.speech());
+}
+
+void test_decimator() {
+    LevelMeter     m;
+    LevelDecimator d;
+    LevelColumn    out[4];
+
+    // 2.5 columns of a ramp in odd-sized pushes
+    std::vector<float> pcm(LEVEL_COLUMN_SAMPLES * 5 / 2);
+    for (size_t i = 0; i < pcm.size(); i++) pcm[i] = (i % 2 ? 0.5f : -0.25f);
+    d.push(pcm.data(), 37, m);
+    d.push(pcm.data() + 37, pcm.size() - 37, m);
+    check("whole_columns_only", m.count() == 2);
+
+    m.latest(out, 4);
+    check("min_max", out[0].min == -0.25f && out[0].max == 0.5f);
+    check("level_is_mean_abs", std::fabs(out[0].level_db - 20.0f * std::log10(0.375f)) < 0.01f);
+
+    // The partial column completes with the next push
+    d.push(pcm.data(), LEVEL_COLUMN_SAMPLES / 2, m);
+    check("partial_carried", m.count() == 3);
+
+    // Silence is clamped, not -inf
+    std::vector<float> zeros(LEVEL_COLUMN_SAMPLES, 0.0f);
+    d.push(zeros.data(), zeros.size(), m);
+    m.latest(out, 1);
+    check("silence_finite", std::isfinite(out[0].level_db) && out[0].level_db <= -100.0f);
+}
+
+int main() {
+    printf("test_level_meter:\n");
+
+    test_publish_latest();
+    test_vad_state();
+    test_decimator();
+
+    printf("\n%d/%d tests passed\n", tests_passed, tests_run);
+    return (tests_passed == tests_run) ? 0 : 1;
+}
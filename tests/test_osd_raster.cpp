@@ -0,0 +1,116 @@
+// Unit tests for the OSD software rasterizer (osd_raster.cpp)
+
+#include "osd_raster.h"
+
+#include <cassert>
+#include <cstdio>
+#include <vector>
+
+static int tests_run = 0;
+static int tests_passed = 0;
+
+static void check(const char * name, bool condition) {
+    tests_run++;
+    printf("  %s ... %s\n", name, condition ? "ok" : "FAILED");
+    if (condition) tests_passed++;
+    assert(condition);
+}
+
+static int count(const std::vector<uint32_t> & px, uint32_t color) {
+    int n = 0;
+    for (uint32_t p : px) n += p == color;
+    return n;
+}
+
+void test_fill_rect() {
+    std::vector<uint32_t> px(10 * 8, 0);
+    OsdCanvas c = { px.data(), 10, 8, 10 };
+
+    osd_fill_rect(c, 2, 1, 3, 2, 0xFF);
+    check("rect_area",   count(px, 0xFF) == 6);
+    check("rect_corner", px[1 * 10 + 2] == 0xFF && px[2 * 10 + 4] == 0xFF && px[3 * 10 + 4] == 0);
+
+    osd_fill_rect(c, -5, -5, 100, 100, 0x11);
+    check("rect_clipped", count(px, 0x11) == 80);
+
+    osd_fill_rect(c, 20, 20, 5, 5, 0x22);
+    check("rect_outside", count(px, 0x22) == 0);
+
+    // Stride wider than the visible width: padding untouched
+    std::vector<uint32_t> wide(12 * 4, 0);
+    OsdCanvas w = { wide.data(), 10, 4, 12 };
+    osd_fill_rect(w, 0, 0, 10, 4, 0x33);
+    check("rect_stride", count(wide, 0x33) == 40 && wide[10] == 0 && wide[11] == 0);
+}
+
+void test_fill_circle() {
+    std::vector<uint32_t> px(20 * 20, 0);
+    OsdCanvas c = { px.data(), 20, 20, 20 };
+
+    osd_fill_circle(c, 10.0f, 10.0f, 5.0f, 0xFFFFFF);
+    check("circle_centre", px[10 * 20 + 10] == 0xFFFFFF);
+    check("circle_outside", px[0] == 0 && px[10 * 20 + 17] == 0);
+
+    // Edge pixels are blended, not hard
+    bool partial = false;
+    for (uint32_t p : px) partial |= p != 0 && p != 0xFFFFFF;
+    check("circle_antialiased", partial);
+
+    // Roughly pi r^2 pixels touched
+    int touched = (int) px.size() - count(px, 0);
+    check("circle_area", touched > 70 && touched < 100);
+
+    // Partly off the canvas
+    osd_fill_circle(c, 0.0f, 0.0f, 3.0f, 0x0000FF);
+    check("circle_clipped", px[0] == 0x0000FF);
+}
+
+void test_level() {
+    check("db_floor",  osd_level_from_db(-90.0f) == 0.0f);
+    check("db_ceil",   osd_level_from_db(0.0f) == 1.0f);
+    check("db_mid",    osd_level_from_db(-35.0f) > 0.45f && osd_level_from_db(-35.0f) < 0.55f);
+    check("bars_none", osd_lit_bars(0.0f) == 0);
+    check("bars_all",  osd_lit_bars(1.5f) == OSD_BARS);
+    check("bars_half", osd_lit_bars(0.5f) == OSD_BARS / 2);
+}
+
+void test_draw() {
+    std::vector<uint32_t> quiet(OSD_WIDTH * OSD_HEIGHT, 0);
+    std::vector<uint32_t> loud(OSD_WIDTH * OSD_HEIGHT, 0);
+    OsdCanvas q = { quiet.data(), OSD_WIDTH, OSD_HEIGHT, OSD_WIDTH };
+    OsdCanvas l = { loud.data(),  OSD_WIDTH, OSD_HEIGHT, OSD_WIDTH };
+
+    osd_draw(q, OsdState::RECORDING, 0.0f, 0);
+    osd_draw(l, OsdState::RECORDING, 1.0f, 0);
+    check("draw_covers", count(quiet, 0) == 0);
+    check("draw_level_changes", quiet != loud);
+
+    // Same inputs, same pixels: the caller can skip redundant redraws
+    std::vector<uint32_t> again(OSD_WIDTH * OSD_HEIGHT, 0);
+    OsdCanvas a = { again.data(), OSD_WIDTH, OSD_HEIGHT, OSD_WIDTH };
+    osd_draw(a, OsdState::RECORDING, 0.0f, 0);
+    check("draw_deterministic", again == quiet);
+
+    std::vector<uint32_t> s0(OSD_WIDTH * OSD_HEIGHT, 0), s1(OSD_WIDTH * OSD_HEIGHT, 0);
+    OsdCanvas c0 = { s0.data(), OSD_WIDTH, OSD_HEIGHT, OSD_WIDTH };
+    OsdCanvas c1 = { s1.data(), OSD_WIDTH, OSD_HEIGHT, OSD_WIDTH };
+    osd_draw(c0, OsdState::TRANSCRIBING, 0.0f, 0);
+    osd_draw(c1, OsdState::TRANSCRIBING, 0.0f, 1);
+    check("spinner_moves", s0 != s1);
+    check("spinner_differs_from_meter", s0 != quiet);
+
+    osd_draw(c1, OsdState::TRANSCRIBING, 0.0f, OSD_BARS);
+    check("spinner_wraps", s0 == s1);
+}
+
+int main() {
+    printf("test_osd_raster:\n");
+
+    test_fill_rect();
+    test_fill_circle();
+    test_level();
+    test_draw();
+
+    printf("\n%d/%d tests passed\n", tests_passed, tests_run);
+    return (tests_passed == tests_run) ? 0 : 1;
+}
@@ -0,0 +1,83 @@
+// Unit tests for OutputCostModel (output_cost.cpp)
+
+#include "output_cost.h"
+
+#include <cassert>
+#include <cstdio>
+#include <string>
+
+static int tests_run = 0;
+static int tests_passed = 0;
+
+static void check(const char * name, bool condition) {
+    tests_run++;
+    printf("  %s ... %s\n", name, condition ? "ok" : "FAILED");
+    if (condition) tests_passed++;
+    assert(condition);
+}
+
+using Method = OutputCostModel::Method;
+using Target = OutputCostModel::Target;
+
+void test_crossover() {
+    OutputCostModel m;
+    check("short_is_typed",  m.choose(5,   2,  Target::ANY).method == Method::TYPE);
+    check("long_is_pasted",  m.choose(500, 2,  Target::ANY).method == Method::PASTE);
+    check("slow_keys_paste", m.choose(40,  12, Target::ANY).method == Method::PASTE);
+
+    auto d = m.choose(10, 0, Target::ANY);
+    check("estimates_reported", d.type_ms > 0.0f && d.paste_ms == m.paste_estimate());
+    check("type_grows_with_length", m.type_estimate(100, 2) > m.type_estimate(10, 2));
+}
+
+void test_forced() {
+    OutputCostModel m;
+    check("type_only",  m.choose(5000, 12, Target::TYPE_ONLY).method == Method::TYPE);
+    check("paste_only", m.choose(1,    0,  Target::PASTE_ONLY).method == Method::PASTE);
+}
+
+void test_learning() {
+    // A slow clipboard makes typing win for longer text
+    OutputCostModel m;
+    const size_t n = 400;
+    check("pasted_before", m.choose(n, 0, Target::ANY).method == Method::PASTE);
+    for (int i = 0; i < 30; i++) m.record_paste(2000.0f);
+    check("paste_ema_converges", m.paste_estimate() > 1900.0f);
+    check("typed_after",   m.choose(n, 0, Target::ANY).method == Method::TYPE);
+
+    // Slow key injection makes pasting win for shorter text
+    OutputCostModel k;
+    check("typed_before", k.choose(60, 0, Target::ANY).method == Method::TYPE);
+    for (int i = 0; i < 30; i++) k.record_type(100, 0, 30.0f + 100 * 20.0f);
+    check("key_cost_learned", k.type_estimate(100, 0) > 1500.0f);
+    check("pasted_after", k.choose(60, 0, Target::ANY).method == Method::PASTE);
+
+    // Short transcripts update the overhead, not the per-key cost
+    OutputCostModel o;
+    const float per_100 = o.type_estimate(100, 0) - o.type_estimate(0, 0);
+    for (int i = 0; i < 30; i++) o.record_type(5, 0, 300.0f);
+    check("overhead_learned", o.type_estimate(0, 0) > 250.0f);
+    check("key_cost_kept",    o.type_estimate(100, 0) - o.type_estimate(0, 0) == per_100);
+}
+
+void test_targets() {
+    check("terminal_multiline_paste", output_target_for("kitty", true, false, "ls\nrm") == Target::PASTE_ONLY);
+    check("terminal_single_line_any", output_target_for("kitty", true, false, "ls -la") == Target::ANY);
+    check("remote_desktop_type",      output_target_for("Remmina", false, false, "hello") == Target::TYPE_ONLY);
+    check("vnc_type",                 output_target_for("Vncviewer", false, false, "a\nb") == Target::TYPE_ONLY);
+    check("editor_any",               output_target_for("Gedit", false, false, "a\nb") == Target::ANY);
+    check("unknown_any",              output_target_for("", false, false, "hello") == Target::ANY);
+    check("password_type",            output_target_for("Firefox", false, true, "hunter2 and more") == Target::TYPE_ONLY);
+}
+
+int main() {
+    printf("test_output_cost:\n");
+
+    test_crossover();
+    test_forced();
+    test_learning();
+    test_targets();
+
+    printf("\n%d/%d tests passed\n", tests_passed, tests_run);
+    return (tests_passed == tests_run) ? 0 : 1;
+}
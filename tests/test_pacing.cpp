@@ -0,0 +1,119 @@
+// Unit tests for PacingTable (pacing.cpp)
+
+#include "pacing.h"
+
+#include <cassert>
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+#include <unistd.h>
+
+// Configured type-delay-ms, where unlearned classes start
+static constexpr int START = 12;
+
+static int tests_run = 0;
+static int tests_passed = 0;
+
+static void check(const char * name, bool condition) {
+    tests_run++;
+    printf("  %s ... %s\n", name, condition ? "ok" : "FAILED");
+    if (condition) tests_passed++;
+    assert(condition);
+}
+
+void test_start_configured() {
+    PacingTable t;
+    check("unknown_class_configured", t.delay_for("Firefox", START) == START);
+    check("not_dirty_initially",       !t.dirty());
+
+    // Faster than configured only after verified transcripts
+    for (int i = 0; i < PacingTable::SPEEDUP_STREAK; i++) t.report("Firefox", true, START);
+    check("verified_speeds_up", t.delay_for("Firefox", START) == START - 1);
+}
+
+void test_backoff() {
+    PacingTable t;
+    check("drop_doubles",      t.report("Code", false, START) == START * 2);
+    check("drop_doubles_again", t.report("Code", false, START) == START * 4);
+    check("per_class",         t.delay_for("xterm", START) == START);
+    check("dirty_after_report", t.dirty());
+
+    for (int i = 0; i < 10; i++) t.report("Code", false, START);
+    check("capped_at_max", t.delay_for("Code", START) == PacingTable::MAX_MS);
+
+    // A window whose class could not be resolved is not learned
+    PacingTable e;
+    check("empty_class_not_learned", e.report("", false, START) == START &&
+                                     e.profiles().empty() && !e.dirty());
+}
+
+void test_speedup() {
+    PacingTable t;
+    t.report("remmina", false, START);  // 24 ms
+    const int slow = t.delay_for("remmina", START);
+
+    for (int i = 0; i < PacingTable::SPEEDUP_STREAK - 1; i++) t.report("remmina", true, START);
+    check("speedup_needs_streak", t.delay_for("remmina", START) == slow);
+    t.report("remmina", true, START);
+    check("speedup_one_ms", t.delay_for("remmina", START) == slow - 1);
+
+    // A drop resets the streak
+    t.report("remmina", true, START);
+    t.report("remmina", false, START);
+    for (int i = 0; i < PacingTable::SPEEDUP_STREAK - 1; i++) t.report("remmina", true, START);
+    check("drop_resets_streak", t.delay_for("remmina", START) == (slow - 1) * 2);
+
+    // Never below the minimum; a drop at 0 ms still backs off
+    PacingTable z;
+    for (int i = 0; i < 100; i++) z.report("gedit", true, START);
+    check("floor_at_min",  z.delay_for("gedit", START) == PacingTable::MIN_MS);
+    check("backoff_from_zero", z.report("gedit", false, START) == 1);
+}
+
+void test_persist() {
+    char path[] = "/tmp/test_pacing_XXXXXX";
+    int fd = mkstemp(path);
+    close(fd);
+
+    PacingTable t;
+    t.report("Slack", false, START);
+    t.report("Google-chrome", false, START);
+    t.report("Google-chrome", false, START);
+    t.report("class with spaces", false, START);
+    check("save_ok",       t.save(path));
+    check("save_clean",    !t.dirty());
+
+    PacingTable u;
+    check("load_ok",       u.load(path));
+    check("load_slack",    u.delay_for("Slack", START) == t.delay_for("Slack", START));
+    check("load_chrome",   u.delay_for("Google-chrome", START) == t.delay_for("Google-chrome", START));
+    check("load_spaces",   u.delay_for("class with spaces", START) == t.delay_for("class with spaces", START));
+
+    // Garbage lines and out-of-range values
+    {
+        std::ofstream out(path, std::ios::trunc);
+        out << "garbage\n9999 Huge\n-5 Negative\n\n40 \n40\n";
+    }
+    PacingTable v;
+    v.load(path);
+    check("load_skips_garbage", v.profiles().size() == 2);
+    check("load_skips_empty_class", v.profiles().count("") == 0);
+    check("load_clamps",        v.delay_for("Huge", START) == PacingTable::MAX_MS &&
+                                v.delay_for("Negative", START) == PacingTable::MIN_MS);
+
+    check("load_missing", !PacingTable().load("/nonexistent/pacing"));
+    unlink(path);
+}
+
+int main() {
+    printf("test_pacing:\n");
+
+    test_start_configured();
+    test_backoff();
+    test_speedup();
+    test_persist();
+
+    printf("\n%d/%d tests passed\n", tests_passed, tests_run);
+    return (tests_passed == tests_run) ? 0 : 1;
+}
@@ -0,0 +1,75 @@
+// Unit tests for ProfileTable (profile.cpp)
+
+#include "profile.h"
+
+#include <cassert>
+#include <cstdio>
+
+static int tests_run = 0;
+static int tests_passed = 0;
+
+static void check(const char * name, bool condition) {
+    tests_run++;
+    printf("  %s ... %s\n", name, condition ? "ok" : "FAILED");
+    if (condition) tests_passed++;
+    assert(condition);
+}
+
+void test_set_find() {
+    ProfileTable t;
+    check("empty",          t.empty() && t.find("xterm") == nullptr);
+
+    check("set_output",     t.set("kitty", "output", "paste"));
+    check("set_paste_key",  t.set("kitty", "paste-key", "ctrl+shift+v"));
+    check("set_punct",      t.set("kitty", "trailing-punctuation", "false"));
+    check("set_language",   t.set("Code", "language", "en"));
+    check("set_prompt",     t.set("Code", "prompt", "std::vector, constexpr, CMake"));
+    check("set_delay",      t.set("Slack", "type-delay-ms", "0"));
+    check("one_per_class",  t.size() == 3);
+
+    const AppProfile * k = t.find("kitty");
+    check("find",           k && k->output == ProfileOutput::PASTE && k->paste_key == "ctrl+shift+v" && k->strip_punct);
+    check("case_insensitive", t.find("KITTY") == k && t.find("code") == t.find("Code"));
+    check("keeps_name",     t.find("code")->name == "Code");
+    check("unset_defaults", k->language.empty() && k->type_delay_ms == -1);
+    check("delay_zero",     t.find("slack")->type_delay_ms == 0);
+    check("unknown_class",  t.find("firefox") == nullptr && t.find("") == nullptr);
+}
+
+void test_bad_values() {
+    ProfileTable t;
+    check("unknown_key",    !t.set("xterm", "model", "large"));
+    check("bad_output",     !t.set("xterm", "output", "telepathy"));
+    check("bad_delay",      !t.set("xterm", "type-delay-ms", "fast"));
+    check("negative_delay", !t.set("xterm", "type-delay-ms", "-3"));
+    check("bad_bool",       !t.set("xterm", "trailing-punctuation", "maybe"));
+    check("no_class",       !t.set("", "output", "type"));
+    check("nothing_created", t.empty());
+
+    t.set("xterm", "output", "type");
+    check("bad_value_keeps", !t.set("xterm", "output", "x") && t.find("xterm")->output == ProfileOutput::TYPE);
+}
+
+void test_postprocess() {
+    AppProfile keep;
+    check("keep_default",   profile_postprocess(keep, "ls -la.") == "ls -la.");
+
+    AppProfile strip;
+    strip.strip_punct = true;
+    check("strip_period",   profile_postprocess(strip, "git status.") == "git status");
+    check("strip_several",  profile_postprocess(strip, "really?! ") == "really");
+    check("inner_kept",     profile_postprocess(strip, "a.b, c") == "a.b, c");
+    check("all_punct",      profile_postprocess(strip, "...") == "");
+    check("strip_final_punct", strip_final_punct("make test. ") == "make test");
+}
+
+int main() {
+    printf("test_profile:\n");
+
+    test_set_find();
+    test_bad_values();
+    test_postprocess();
+
+    printf("\n%d/%d tests passed\n", tests_passed, tests_run);
+    return (tests_passed == tests_run) ? 0 : 1;
+}
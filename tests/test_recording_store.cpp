@@ -0,0 +1,158 @@
+// Unit tests for BlockPool and RecordingStore (recording_store.cpp)
+
+#include "recording_store.h"
+
+#include <cassert>
+#include <cstdio>
+#include <vector>
+
+static int tests_run = 0;
+static int tests_passed = 0;
+
+static void check(const char * name, bool condition) {
+    tests_run++;
+    printf("  %s ... %s\n", name, condition ? "ok" : "FAILED");
+    if (condition) tests_passed++;
+    assert(condition);
+}
+
+static std::vector<float> ramp(size_t from, size_t n) {
+    std::vector<float> v(n);
+    for (size_t i = 0; i < n; i++) v[i] = (float) (from + i);
+    return v;
+}
+
+static bool is_ramp(const std::vector<float> & v, size_t from) {
+    for (size_t i = 0; i < v.size(); i++) {
+        if (v[i] != (float) (from + i)) return false;
+    }
+    return true;
+}
+
+void test_pool() {
+    BlockPool pool(100, 2);
+    auto a = pool.acquire();
+    auto b = pool.acquire();
+    auto c = pool.acquire();
+    check("pool_in_use", pool.in_use() == 3);
+
+    float * pa = a.get();
+    pool.release(std::move(a));
+    pool.release(std::move(b));
+    pool.release(std::move(c));
+    check("pool_all_returned", pool.in_use() == 0);
+    check("pool_keeps_max_free", pool.free_blocks() == 2);
+
+    auto d = pool.acquire();
+    auto e = pool.acquire();
+    check("pool_reuses", d.get() == pa || e.get() == pa);
+    check("pool_reuse_drains_free", pool.free_blocks() == 0);
+    pool.release(std::move(d));
+    pool.release(std::move(e));
+}
+
+void test_append_read() {
+    BlockPool pool(100, 4);
+    RecordingStore rec(pool);
+    check("store_empty", rec.empty());
+
+    // Appends straddling block boundaries in odd sizes
+    size_t n = 0;
+    for (size_t chunk : {37, 100, 1, 163, 99}) {
+        auto v = ramp(n, chunk);
+        rec.append(v.data(), v.size());
+        n += chunk;
+    }
+    check("store_size",   rec.size() == 400);
+    check("store_blocks", pool.in_use() == 4);
+
+    std::vector<float> out;
+    rec.read(0, rec.size(), out);
+    check("read_all", out.size() == 400 && is_ramp(out, 0));
+    rec.read(95, 305, out);
+    check("read_across_blocks", out.size() == 210 && is_ramp(out, 95));
+    rec.read(390, 1000, out);
+    check("read_clamped", out.size() == 10 && is_ramp(out, 390));
+    rec.read(500, 600, out);
+    check("read_past_end", out.empty());
+
+    rec.clear();
+    check("clear_empties",      rec.empty());
+    check("clear_returns_blocks", pool.in_use() == 0 && pool.free_blocks() == 4);
+}
+
+void test_gather() {
+    BlockPool pool(64, 4);
+    RecordingStore rec(pool);
+    auto v = ramp(0, 200);
+    rec.append(v.data(), v.size());
+
+    std::vector<VadSegment> segs = {{10, 20}, {60, 130}, {190, 250}};
+    std::vector<float> out;
+    rec.gather(segs, 5, out);
+    check("gather_size", out.size() == 10 + 5 + 70 + 5 + 10);
+    check("gather_first",  std::vector<float>(out.begin(), out.begin() + 10) == ramp(10, 10));
+    check("gather_gap",    out[10] == 0.0f && out[14] == 0.0f);
+    check("gather_middle", std::vector<float>(out.begin() + 15, out.begin() + 85) == ramp(60, 70));
+    check("gather_clamped_last", std::vector<float>(out.begin() + 90, out.end()) == ramp(190, 10));
+}
+
+void test_move() {
+    BlockPool pool(50, 8);
+    RecordingStore a(pool);
+    auto v = ramp(0, 120);
+    a.append(v.data(), v.size());
+
+    RecordingStore b(std::move(a));
+    check("move_transfers", b.size() == 120 && a.empty());
+
+    std::vector<float> out;
+    b.read(0, b.size(), out);
+    check("move_keeps_data", is_ramp(out, 0));
+
+    {
+        RecordingStore c(pool);
+        c = std::move(b);
+    }
+    check("destructor_returns_blocks", pool.in_use() == 0);
+}
+
+void test_release_before() {
+    BlockPool pool(100, 8);
+    RecordingStore rec(pool);
+    auto v = ramp(0, 450);
+    rec.append(v.data(), v.size());
+    check("release_setup", pool.in_use() == 5);
+
+    rec.release_before(250);
+    check("release_whole_blocks", pool.in_use() == 3 && rec.first() == 200);
+    check("release_keeps_size",   rec.size() == 450);
+
+    std::vector<float> out;
+    rec.read(150, 260, out);
+    check("release_read_clamped", out.size() == 60 && is_ramp(out, 200));
+
+    auto w = ramp(450, 100);
+    rec.append(w.data(), w.size());
+    rec.read(400, 550, out);
+    check("release_append_after", out.size() == 150 && is_ramp(out, 400));
+
+    rec.release_before(100);
+    check("release_is_monotonic", pool.in_use() == 4 && rec.first() == 200);
+
+    rec.clear();
+    check("release_clear", pool.in_use() == 0 && rec.first() == 0);
+}
+
+int main() {
+    printf("test_recording_store:\n");
+
+    test_pool();
+    test_append_read();
+    test_gather();
+    test_move();
+    test_release_before();
+
+    printf("\n%d/%d tests passed\n", tests_passed, tests_run);
+    return (tests_passed == tests_run) ? 0 : 1;
+}
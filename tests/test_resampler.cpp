@@ -0,0 +1,113 @@
+// Unit tests for the polyphase resampler (resampler.cpp)
+
+#include "resampler.h"
+
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+static int tests_run = 0;
+static int tests_passed = 0;
+
+static void check(const char * name, bool condition) {
+    tests_run++;
+    printf("  %s ... %s\n", name, condition ? "ok" : "FAILED");
+    if (condition) tests_passed++;
+    assert(condition);
+}
+
+static std::vector<float> sine(double freq, int rate, size_t n, float amp = 0.5f) {
+    std::vector<float> x(n);
+    for (size_t i = 0; i < n; i++) x[i] = amp * (float) std::sin(2.0 * M_PI * freq * i / rate);
+    return x;
+}
+
+static std::vector<float> run(Resampler & rs, const std::vector<float> & in, size_t block) {
+    std::vector<float> out;
+    std::vector<float> tmp(rs.max_output(block));
+    for (size_t i = 0; i < in.size(); i += block) {
+        size_t n = std::min(block, in.size() - i);
+        size_t k = rs.process(in.data() + i, n, tmp.data());
+        out.insert(out.end(), tmp.begin(), tmp.begin() + k);
+    }
+    return out;
+}
+
+// RMS in dBFS, skipping the filter's start-up transient
+static double rms_db(const std::vector<float> & x, size_t skip) {
+    double sum = 0.0;
+    size_t n = 0;
+    for (size_t i = skip; i < x.size(); i++, n++) sum += (double) x[i] * x[i];
+    return 10.0 * std::log10(std::max(sum / std::max<size_t>(n, 1), 1e-20));
+}
+
+void test_ratios() {
+    Resampler rs;
+    check("init_48k", rs.init(48000, 16000));
+    auto out = run(rs, std::vector<float>(48000, 0.0f), 480);
+    check("48k_length", out.size() == 16000);
+
+    check("init_44k1", rs.init(44100, 16000));
+    out = run(rs, std::vector<float>(44100, 0.0f), 441);
+    check("44k1_length", out.size() == 16000);
+
+    check("taps_aligned", rs.taps_per_phase() % 8 == 0);
+    check("latency_small", rs.latency_ms() > 0.0 && rs.latency_ms() < 10.0);
+    check("rejects_invalid", !rs.init(0, 16000));
+}
+
+void test_passband() {
+    Resampler rs;
+    rs.init(48000, 16000);
+    double ref = rms_db(sine(1000.0, 16000, 16000), 0);
+
+    auto out = run(rs, sine(1000.0, 48000, 48000), 512);
+    check("passband_1k_flat", std::fabs(rms_db(out, 1000) - ref) < 0.1);
+
+    rs.reset();
+    out = run(rs, sine(6500.0, 48000, 48000), 512);
+    check("passband_6k5_flat", std::fabs(rms_db(out, 1000) - ref) < 0.5);
+}
+
+void test_alias_rejection() {
+    // Tones above the output Nyquist must not fold back into the output
+    const double tones[] = {9000.0, 12000.0, 20000.0};
+    for (int rate : {48000, 44100}) {
+        Resampler rs;
+        rs.init(rate, 16000);
+        double ref   = rms_db(run(rs, sine(1000.0, rate, rate), 512), 1000);
+        double worst = -1000.0;
+        for (double f : tones) {
+            rs.reset();
+            worst = std::max(worst, rms_db(run(rs, sine(f, rate, rate), 512), 1000) - ref);
+        }
+        printf("    %d Hz: worst alias %.1f dB\n", rate, worst);
+        check(rate == 48000 ? "alias_rejected_48k" : "alias_rejected_44k1", worst < -70.0);
+    }
+}
+
+void test_block_independence() {
+    // Output must not depend on how the input is split into callbacks
+    Resampler a, b;
+    a.init(44100, 16000);
+    b.init(44100, 16000);
+    auto in = sine(440.0, 44100, 20000);
+    auto x = run(a, in, a.max_input());
+    auto y = run(b, in, 97);
+    bool same = x.size() == y.size();
+    for (size_t i = 0; same && i < x.size(); i++) same = std::fabs(x[i] - y[i]) < 1e-6f;
+    check("block_size_independent", same);
+}
+
+int main() {
+    printf("test_resampler:\n");
+
+    test_ratios();
+    test_passband();
+    test_alias_rejection();
+    test_block_independence();
+
+    printf("\n%d/%d tests passed\n", tests_passed, tests_run);
+    return (tests_passed == tests_run) ? 0 : 1;
+}
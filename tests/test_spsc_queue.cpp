@@ -0,0 +1,77 @@
+// Unit tests for SpscQueue (spsc_queue.h)
+
+#include "spsc_queue.h"
+
+#include <cassert>
+#include <cstdio>
+#include <thread>
+
+static int tests_run = 0;
+static int tests_passed = 0;
+
+static void check(const char * name, bool condition) {
+    tests_run++;
+    printf("  %s ... %s\n", name, condition ? "ok" : "FAILED");
+    if (condition) tests_passed++;
+    assert(condition);
+}
+
+void test_basic() {
+    SpscQueue<int, 4> q;
+    int v = 0;
+    check("empty_pop",     !q.pop(v));
+    check("push",          q.push(1) && q.push(2) && q.size() == 2);
+    check("fifo",          q.pop(v) && v == 1 && q.pop(v) && v == 2);
+    check("empty_again",   !q.pop(v) && q.size() == 0);
+}
+
+void test_full_and_wrap() {
+    SpscQueue<int, 4> q;
+    for (int i = 0; i < 4; i++) q.push(i);
+    check("full_rejects",  !q.push(99) && q.size() == 4);
+
+    // Wrap around the ring many times
+    int v = 0;
+    bool ok = true;
+    for (int i = 4; i < 1000; i++) {
+        ok = ok && q.pop(v) && v == i - 4 && q.push(i);
+    }
+    check("wrap_order",    ok && q.size() == 4);
+}
+
+void test_threads() {
+    // One producer, one consumer: every item arrives once, in order
+    static constexpr int N = 200000;
+    SpscQueue<int, 64> q;
+    std::thread producer([&]() {
+        for (int i = 0; i < N; i++) {
+            while (!q.push(i)) std::this_thread::yield();
+        }
+    });
+
+    int  expected = 0;
+    bool in_order = true;
+    while (expected < N) {
+        int v = 0;
+        if (!q.pop(v)) {
+            std::this_thread::yield();
+            continue;
+        }
+        in_order = in_order && v == expected;
+        expected++;
+    }
+    producer.join();
+    check("threads_in_order", in_order);
+    check("threads_drained",  q.size() == 0);
+}
+
+int main() {
+    printf("test_spsc_queue:\n");
+
+    test_basic();
+    test_full_and_wrap();
+    test_threads();
+
+    printf("\n%d/%d tests passed\n", tests_passed, tests_run);
+    return (tests_passed == tests_run) ? 0 : 1;
+}
@@ -0,0 +1,130 @@
+// Unit tests for run_cmd() and spawn_detached() from subprocess.cpp
+//
+// Uses standard utilities (true, false, cat, sh, sleep) present on any Linux system.
+
+#include "subprocess.h"
+
+#include <cassert>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+
+#include <sys/wait.h>
+
+static int tests_run = 0;
+static int tests_passed = 0;
+
+static void check(const char * name, bool condition) {
+    tests_run++;
+    printf("  %s ... %s\n", name, condition ? "ok" : "FAILED");
+    if (condition) tests_passed++;
+    assert(condition);
+}
+
+static long elapsed_ms(std::chrono::steady_clock::time_point start) {
+    return (long) std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start).count();
+}
+
+void test_exit_status() {
+    const char * ok_argv[]   = {"true", nullptr};
+    const char * fail_argv[] = {"false", nullptr};
+    const char * code_argv[] = {"sh", "-c", "exit 7", nullptr};
+    check("exit_zero",        run_cmd(ok_argv, 5000) == 0);
+    check("exit_nonzero",     run_cmd(fail_argv, 5000) == 1);
+    check("exit_code_passed", run_cmd(code_argv, 5000) == 7);
+}
+
+void test_missing_binary() {
+    const char * argv[] = {"nonexistent-binary-xyz", nullptr};
+    check("missing_binary_fails", run_cmd(argv, 5000) != 0);
+    check("missing_binary_detached", spawn_detached(argv) == false);
+}
+
+void test_stdin_stdout_roundtrip() {
+    const char * argv[] = {"cat", nullptr};
+    std::string in = "hello world\nsecond line";
+    std::string out;
+    int ret = run_cmd(argv, 5000, &in, &out);
+    check("cat_exit_zero",   ret == 0);
+    check("cat_roundtrip",   out == in);
+
+    // Larger than a pipe buffer (64 KiB) in both directions
+    std::string big(300 * 1024, 'x');
+    for (size_t i = 0; i < big.size(); i += 97) big[i] = (char)('a' + (i % 26));
+    std::string big_out;
+    ret = run_cmd(argv, 5000, &big, &big_out);
+    check("cat_large_exit_zero", ret == 0);
+    check("cat_large_roundtrip", big_out == big);
+
+    std::string empty, empty_out = "stale";
+    ret = run_cmd(argv, 5000, &empty, &empty_out);
+    check("cat_empty_stdin", ret == 0 && empty_out.empty());
+}
+
+void test_stdout_only() {
+    const char * argv[] = {"sh", "-c", "printf abc", nullptr};
+    std::string out;
+    check("stdout_capture", run_cmd(argv, 5000, nullptr, &out) == 0 && out == "abc");
+}
+
+void test_backgrounded_grandchild_does_not_block() {
+    // Grandchild keeps stdout open long after the child exits (like xclip).
+    const char * argv[] = {"sh", "-c", "printf done; sleep 3 &", nullptr};
+    std::string out;
+    auto start = std::chrono::steady_clock::now();
+    int ret = run_cmd(argv, 5000, nullptr, &out);
+    check("grandchild_exit_zero", ret == 0 && out == "done");
+    check("grandchild_no_wait",   elapsed_ms(start) < 1000);
+}
+
+void test_timeout() {
+    // The child is killed at the deadline; the upper bound is loose so a
+    // loaded machine does not fail it, but far below the child's runtime
+    const char * argv[] = {"sleep", "60", nullptr};
+    auto start = std::chrono::steady_clock::now();
+    int ret = run_cmd(argv, 200);
+    long ms = elapsed_ms(start);
+    check("timeout_returns_error", ret == -1);
+    check("timeout_is_prompt",     ms >= 200 && ms < 10000);
+}
+
+void test_fast_command_latency() {
+    // Exit is seen through the pidfd, not a timer: trivial commands must
+    // not stall. The bound leaves room for a busy machine's spawn cost.
+    const char * argv[] = {"true", nullptr};
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < 20; i++) run_cmd(argv, 5000);
+    check("fast_commands_not_sleep_bound", elapsed_ms(start) < 20 * 100);
+}
+
+void test_detached_no_zombies() {
+    const char * argv[] = {"true", nullptr};
+    const char * cat_argv[] = {"cat", nullptr};
+    std::string data = "clipboard text";
+    check("detached_starts",       spawn_detached(argv));
+    check("detached_pipe_starts",  spawn_detached(cat_argv, &data));
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+    // The background reaper must have collected both children already
+    int status;
+    check("detached_no_zombies", waitpid(-1, &status, WNOHANG) <= 0);
+}
+
+int main() {
+    printf("test_subprocess:\n");
+
+    test_exit_status();
+    test_missing_binary();
+    test_stdin_stdout_roundtrip();
+    test_stdout_only();
+    test_backgrounded_grandchild_does_not_block();
+    test_timeout();
+    test_fast_command_latency();
+    test_detached_no_zombies();
+
+    printf("\n%d/%d tests passed\n", tests_passed, tests_run);
+    return (tests_passed == tests_run) ? 0 : 1;
+}
@@ -0,0 +1,328 @@
+// Unit tests for VAD pure logic (no whisper model required)
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "vad.h"
+
+static int tests_run = 0;
+static int tests_passed = 0;
+
+static void check(const char * name, bool condition) {
+    tests_run++;
+    printf("  %s ... %s\n", name, condition ? "ok" : "FAILED");
+    if (condition) tests_passed++;
+    assert(condition);
+}
+
+// Append n frames of probability p
+static void frames(std::vector<float> & probs, int n, float p) {
+    probs.insert(probs.end(), n, p);
+}
+
+void test_has_speech() {
+    VadDecisionParams dp;
+    std::vector<float> probs;
+    frames(probs, 20, 0.1f);
+    check("silence_is_not_speech", !vad_has_speech(probs, dp));
+
+    frames(probs, dp.min_speech_frames - 1, 0.9f);
+    frames(probs, 2, 0.1f);
+    check("short_blip_is_not_speech", !vad_has_speech(probs, dp));
+
+    frames(probs, dp.min_speech_frames, 0.9f);
+    check("sustained_run_is_speech", vad_has_speech(probs, dp));
+}
+
+void test_trailing_silence() {
+    VadDecisionParams dp;
+    std::vector<float> probs;
+    check("empty_has_no_trailing_silence", vad_trailing_silence_frames(probs, dp) == 0);
+
+    frames(probs, 10, 0.9f);
+    frames(probs, 5, 0.05f);
+    check("counts_trailing_silent_frames", vad_trailing_silence_frames(probs, dp) == 5);
+
+    // Between the thresholds is neither speech nor silence: it resets the count
+    frames(probs, 1, 0.4f);
+    check("hysteresis_band_is_not_silence", vad_trailing_silence_frames(probs, dp) == 0);
+}
+
+void test_segments() {
+    VadDecisionParams dp;
+    dp.pad_frames = 0;
+
+    std::vector<float> probs;
+    frames(probs, 10, 0.0f);
+    frames(probs, 20, 0.9f);
+    frames(probs, 10, 0.0f);
+    size_t n = probs.size() * VAD_FRAME_SAMPLES;
+
+    auto segs = vad_segments_from_probs(probs, n, dp);
+    check("one_segment", segs.size() == 1);
+    check("segment_start", segs[0].start == 10 * VAD_FRAME_SAMPLES);
+    check("segment_end",   segs[0].end   == 30 * VAD_FRAME_SAMPLES);
+
+    // A gap shorter than min_silence_frames does not split the segment
+    probs.clear();
+    frames(probs, 10, 0.9f);
+    frames(probs, dp.min_silence_frames - 1, 0.0f);
+    frames(probs, 10, 0.9f);
+    frames(probs, 10, 0.0f);
+    n = probs.size() * VAD_FRAME_SAMPLES;
+    check("short_gap_merged", vad_segments_from_probs(probs, n, dp).size() == 1);
+
+    // A long gap does
+    probs.clear();
+    frames(probs, 10, 0.9f);
+    frames(probs, 10, 0.0f);
+    frames(probs, 10, 0.9f);
+    n = probs.size() * VAD_FRAME_SAMPLES;
+    segs = vad_segments_from_probs(probs, n, dp);
+    check("long_gap_splits", segs.size() == 2);
+
+    // Speech running to the end keeps the trailing partial frame
+    check("open_segment_reaches_end", segs.back().end == n);
+    segs = vad_segments_from_probs(probs, n + 100, dp);
+    check("open_segment_keeps_tail", segs.back().end == n + 100);
+
+    // Too short to count
+    probs.clear();
+    frames(probs, 10, 0.0f);
+    frames(probs, dp.min_speech_frames - 1, 0.9f);
+    frames(probs, 10, 0.0f);
+    n = probs.size() * VAD_FRAME_SAMPLES;
+    check("short_burst_dropped", vad_segments_from_probs(probs, n, dp).empty());
+}
+
+void test_segment_padding() {
+    VadDecisionParams dp;
+    dp.pad_frames = 2;
+
+    std::vector<float> probs;
+    frames(probs, 1, 0.0f);
+    frames(probs, 10, 0.9f);
+    frames(probs, 10, 0.0f);
+    frames(probs, 10, 0.9f);
+    frames(probs, 10, 0.0f);
+    size_t n = probs.size() * VAD_FRAME_SAMPLES;
+
+    auto segs = vad_segments_from_probs(probs, n, dp);
+    check("padded_count",       segs.size() == 2);
+    check("pad_clamped_at_0",   segs[0].start == 0);
+    check("pad_extends_end",    segs[0].end == 13 * VAD_FRAME_SAMPLES);
+    check("pad_extends_start",  segs[1].start == 19 * VAD_FRAME_SAMPLES);
+
+    // Padding that makes segments touch merges them
+    dp.pad_frames = 6;
+    check("padding_merges", vad_segments_from_probs(probs, n, dp).size() == 1);
+}
+
+void test_gather() {
+    std::vector<float> pcm(100);
+    for (size_t i = 0; i < pcm.size(); i++) pcm[i] = (float) i;
+
+    std::vector<VadSegment> segs = {{10, 20}, {50, 55}, {95, 200}};
+    std::vector<float> out;
+    vad_gather_speech(pcm.data(), pcm.size(), segs, 3, out);
+
+    check("gather_size",        out.size() == 10 + 3 + 5 + 3 + 5);
+    check("gather_first",       out[0] == 10.0f && out[9] == 19.0f);
+    check("gather_gap_silent",  out[10] == 0.0f && out[12] == 0.0f);
+    check("gather_second",      out[13] == 50.0f);
+    check("gather_clamped_end", out.back() == 99.0f);
+
+    vad_gather_speech(pcm.data(), pcm.size(), {}, 3, out);
+    check("gather_nothing", out.empty());
+}
+
+// Constant-magnitude signal of n frames with the given energy in dBFS
+static std::vector<float> level(float db, int n_frames) {
+    float a = std::pow(10.0f, db / 20.0f);
+    std::vector<float> pcm((size_t) n_frames * NOISE_FRAME_SAMPLES);
+    for (size_t i = 0; i < pcm.size(); i++) pcm[i] = (i % 2) ? a : -a;
+    return pcm;
+}
+
+void test_energy() {
+    std::vector<float> pcm = {0.5f, -0.5f, 0.5f, -0.5f};
+    check("energy_mean_abs",   std::fabs(vad_energy(pcm.data(), pcm.size()) - 0.5f) < 1e-6f);
+    check("energy_empty",      vad_energy(pcm.data(), 0) == 0.0f);
+    check("dbfs_full_scale",   std::fabs(energy_to_dbfs(1.0f)) < 1e-4f);
+    check("dbfs_silence_clamped", energy_to_dbfs(0.0f) == -120.0f);
+}
+
+void test_high_pass() {
+    // Reference: whisper's high_pass_filter() over the whole signal
+    std::vector<float> pcm(1000);
+    for (size_t i = 0; i < pcm.size(); i++) pcm[i] = 0.3f + 0.5f * std::sin((float) i * 0.37f);
+    const float rc = 1.0f / (2.0f * (float) M_PI * 100.0f);
+    const float dt = 1.0f / 16000.0f;
+    const float alpha = dt / (rc + dt);
+    std::vector<float> ref = pcm;
+    float y = ref[0];
+    for (size_t i = 1; i < ref.size(); i++) {
+        y = alpha * (y + pcm[i] - pcm[i - 1]);
+        ref[i] = y;
+    }
+
+    HighPassFilter hp;
+    hp.set_cutoff(100.0f, 16000.0f);
+    std::vector<float> whole = pcm;
+    hp.process(whole.data(), whole.size());
+    bool same = true;
+    for (size_t i = 0; i < pcm.size(); i++) same &= std::fabs(whole[i] - ref[i]) < 1e-6f;
+    check("high_pass_matches_whisper", same);
+
+    // In uneven blocks, the state carries over: no step at the boundaries
+    hp.reset();
+    std::vector<float> blocks = pcm;
+    const size_t cuts[] = {0, 1, 160, 161, 700, blocks.size()};
+    for (size_t c = 0; c + 1 < sizeof(cuts) / sizeof(cuts[0]); c++) {
+        hp.process(blocks.data() + cuts[c], cuts[c + 1] - cuts[c]);
+    }
+    same = true;
+    for (size_t i = 0; i < pcm.size(); i++) same &= std::fabs(blocks[i] - ref[i]) < 1e-6f;
+    check("high_pass_blocks_continuous", same);
+}
+
+void test_noise_floor() {
+    NoiseFloorEstimator nf;
+    check("noise_not_ready", !nf.ready());
+
+    auto quiet = level(-60.0f, 100);
+    nf.feed(quiet.data(), quiet.size());
+    check("noise_ready",         nf.ready());
+    check("noise_floor_tracks",  std::fabs(nf.floor_db() + 60.0f) < 0.5f);
+    check("noise_threshold_margin", nf.threshold_db() > nf.floor_db());
+
+    // A one-second burst of speech barely moves the floor
+    auto loud = level(-20.0f, 50);
+    nf.feed(loud.data(), loud.size());
+    check("noise_ignores_burst", nf.floor_db() < -58.5f);
+
+    // Quieter frames pull it down quickly
+    auto quieter = level(-70.0f, 50);
+    nf.feed(quieter.data(), quieter.size());
+    check("noise_falls_fast", std::fabs(nf.floor_db() + 70.0f) < 0.5f);
+
+    // A noisier room: the floor climbs at 1 dB/s, so a 20 dB step is
+    // halfway after 10 s and done after 20 s
+    NoiseFloorEstimator room;
+    auto before = level(-60.0f, 100);
+    auto after  = level(-40.0f, 500);
+    room.feed(before.data(), before.size());
+    room.feed(after.data(), after.size());
+    check("noise_rise_10s", std::fabs(room.floor_db() + 50.0f) < 0.5f);
+    room.feed(after.data(), after.size());
+    check("noise_rise_20s", std::fabs(room.floor_db() + 40.0f) < 0.5f);
+
+    // Feeding in odd-sized pieces gives the same result as whole frames
+    NoiseFloorEstimator a, b;
+    auto sig = level(-50.0f, 60);
+    a.feed(sig.data(), sig.size());
+    for (size_t i = 0; i < sig.size(); i += 77) b.feed(sig.data() + i, std::min<size_t>(77, sig.size() - i));
+    check("noise_partial_frames", std::fabs(a.floor_db() - b.floor_db()) < 1e-4f);
+
+    // Digital silence: threshold stays at its minimum
+    NoiseFloorEstimator z;
+    std::vector<float> zeros(60 * NOISE_FRAME_SAMPLES, 0.0f);
+    z.feed(zeros.data(), zeros.size());
+    check("noise_min_threshold", z.threshold_db() > -60.0f);
+}
+
+void test_calibration_report() {
+    NoiseFloorEstimator nf;
+    nf.set_collect(true);
+    auto quiet = level(-60.0f, 90);
+    auto loud  = level(-30.0f, 10);
+    nf.feed(quiet.data(), quiet.size());
+    nf.feed(loud.data(), loud.size());
+
+    auto r = nf.report();
+    check("report_frames", r.n_frames == 100);
+    check("report_p50",    std::fabs(r.p50_db + 60.0f) < 0.1f);
+    check("report_p90",    r.p90_db > -61.0f && r.p90_db <= -29.9f);
+    check("report_resets", nf.report().n_frames == 0);
+}
+
+void test_utterance_level() {
+    // Mostly pauses at -60 dBFS, speech at -30 dBFS in 20% of the frames
+    auto pcm  = level(-60.0f, 80);
+    auto loud = level(-30.0f, 20);
+    pcm.insert(pcm.end(), loud.begin(), loud.end());
+    UtteranceLevel ul;
+    check("snr_empty", ul.snr_db(-60.0f) == 0.0f);
+    ul.feed(pcm.data(), pcm.size());
+    float snr = ul.snr_db(-60.0f);
+    check("snr_frames",            ul.n_frames() == 100);
+    check("snr_speech_over_floor", std::fabs(snr - 30.0f) < 0.1f);
+
+    // A noisier floor ranks the same utterance lower
+    check("snr_floor_relative", ul.snr_db(-50.0f) < snr);
+
+    // Fed as it is recorded, in odd-sized pieces: the same
+    UtteranceLevel parts;
+    for (size_t i = 0; i < pcm.size(); i += 77) parts.feed(pcm.data() + i, std::min<size_t>(77, pcm.size() - i));
+    check("snr_partial_frames", parts.n_frames() == 100 && parts.snr_db(-60.0f) == snr);
+
+    UtteranceLevel short_ul;
+    short_ul.feed(pcm.data(), NOISE_FRAME_SAMPLES - 1);
+    check("snr_too_short", short_ul.snr_db(-60.0f) == 0.0f);
+
+    ul.reset();
+    check("snr_reset", ul.n_frames() == 0 && ul.snr_db(-60.0f) == 0.0f);
+}
+
+void test_chunk_cut() {
+    VadDecisionParams dp;
+    VadChunkParams    cp;
+    cp.min_frames   = 100;
+    cp.max_frames   = 300;
+    cp.pause_frames = 10;
+
+    // Speech with a pause before the minimum length: no cut
+    std::vector<float> probs(150, 0.9f);
+    for (int i = 40; i < 60; i++) probs[i] = 0.1f;
+    check("cut_not_before_min", vad_find_chunk_cut(probs, 0, cp, dp) == 0);
+
+    // Pause after the minimum length: cut in its middle
+    for (int i = 120; i < 135; i++) probs[i] = 0.1f;
+    check("cut_at_pause", vad_find_chunk_cut(probs, 0, cp, dp) == 125);
+
+    // Pause still shorter than pause_frames: wait
+    std::vector<float> open_pause(150, 0.9f);
+    for (int i = 145; i < 150; i++) open_pause[i] = 0.1f;
+    check("cut_waits_for_pause", vad_find_chunk_cut(open_pause, 0, cp, dp) == 0);
+
+    // Relative to the chunk start: the pause straddles the minimum length
+    check("cut_from_offset", vad_find_chunk_cut(probs, 30, cp, dp) == 130);
+
+    // Continuous speech up to the maximum: cut at the quietest frame
+    std::vector<float> talk(320, 0.9f);
+    talk[250] = 0.4f;
+    check("cut_forced_at_max", vad_find_chunk_cut(talk, 0, cp, dp) == 250);
+    check("cut_waits_below_max", vad_find_chunk_cut(std::vector<float>(talk.begin(), talk.begin() + 299), 0, cp, dp) == 0);
+}
+
+int main() {
+    printf("test_vad:\n");
+
+    test_has_speech();
+    test_trailing_silence();
+    test_segments();
+    test_segment_padding();
+    test_gather();
+    test_energy();
+    test_high_pass();
+    test_noise_floor();
+    test_calibration_report();
+    test_utterance_level();
+    test_chunk_cut();
+
+    printf("\n%d/%d tests passed\n", tests_passed, tests_run);
+    return (tests_passed == tests_run) ? 0 : 1;
+}